@@ -1,6 +1,12 @@
 #include <benchmark/benchmark.h>
 
+#include <clickhouse/arrow.h>
+#include <clickhouse/block_builder.h>
 #include <clickhouse/client.h>
+#include <clickhouse/columns/hash.h>
+#include <clickhouse/columns/stats.h>
+#include <clickhouse/row_mapper.h>
+#include <clickhouse/types/type_parser.h>
 
 namespace clickhouse {
 
@@ -29,6 +35,406 @@ static void SelectNumberMoreColumns(benchmark::State& state) {
 }
 BENCHMARK(SelectNumberMoreColumns);
 
+static void PingLatency(benchmark::State& state) {
+    // Measures Ping round trip time with different socket settings.
+    ClientOptions options = ClientOptions()
+        .SetHost("localhost")
+        .SetPingBeforeQuery(false)
+        .TcpNoDelay(false);
+
+    switch (state.range(0)) {
+        case 0:
+            state.SetLabel("default");
+            break;
+        case 1:
+            state.SetLabel("nodelay");
+            options.TcpNoDelay(true);
+            break;
+        case 2:
+            state.SetLabel("nodelay+buffers");
+            options.TcpNoDelay(true)
+                .SetTcpRecvBufferSize(4 << 20)
+                .SetTcpSendBufferSize(4 << 20);
+            break;
+        case 3:
+            state.SetLabel("nodelay+quickack");
+            options.TcpNoDelay(true).TcpQuickAck(true);
+            break;
+        case 4:
+            state.SetLabel("nodelay+quickack+busy_poll");
+            options.TcpNoDelay(true)
+                .TcpQuickAck(true)
+                .SetTcpBusyPoll(std::chrono::microseconds(50));
+            break;
+    }
+
+    Client client(options);
+    while (state.KeepRunning()) {
+        client.Ping();
+    }
+}
+BENCHMARK(PingLatency)->DenseRange(0, 4);
+
+static void ParseTypeNames(benchmark::State& state) {
+    // Cached lookups from concurrent threads should scale with cores.
+    static const std::string_view kNames[] = {
+        "UInt64",
+        "Nullable(String)",
+        "Array(Nullable(Int32))",
+        "DateTime64(3, 'UTC')",
+        "Tuple(UInt8, Array(String), Decimal(18, 4))",
+    };
+
+    while (state.KeepRunning()) {
+        for (const auto& name : kNames) {
+            benchmark::DoNotOptimize(ParseTypeName(name));
+        }
+    }
+}
+BENCHMARK(ParseTypeNames)->ThreadRange(1, 16)->UseRealTime();
+
+static void StringToLowCardinality(benchmark::State& state) {
+    // Dictionary encoding of strings with given count of distinct values.
+    ColumnString strings;
+    for (int64_t i = 0; i < 100000; ++i) {
+        strings.Append("value-" + std::to_string(i % state.range(0)));
+    }
+
+    double ratio = 0;
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(ToLowCardinality(strings, &ratio));
+    }
+
+    state.SetItemsProcessed(state.iterations() * strings.Size());
+    state.counters["ratio"] = ratio;
+}
+BENCHMARK(StringToLowCardinality)->RangeMultiplier(100)->Range(10, 100000);
+
+static void ArrayRowAccess(benchmark::State& state) {
+    // Sum of elements of 10000 arrays by row, through GetAsColumn or typed views.
+    auto array = std::make_shared<ColumnArray>(std::make_shared<ColumnUInt64>());
+    for (uint64_t i = 0; i < 10000; ++i) {
+        array->AppendAsColumn(std::make_shared<ColumnUInt64>(std::vector<uint64_t>(i % 16, i)));
+    }
+    auto typed = ColumnArrayT<ColumnUInt64>::Wrap(array);
+
+    while (state.KeepRunning()) {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < array->Size(); ++i) {
+            if (state.range(0) == 0) {
+                auto row = array->GetAsColumn(i)->As<ColumnUInt64>();
+                for (size_t j = 0; j < row->Size(); ++j) {
+                    sum += (*row)[j];
+                }
+            } else {
+                for (const auto value : (*typed)[i]) {
+                    sum += value;
+                }
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetLabel(state.range(0) == 0 ? "GetAsColumn" : "ColumnArrayT");
+}
+BENCHMARK(ArrayRowAccess)->DenseRange(0, 1);
+
+static void DecimalStringConversion(benchmark::State& state) {
+    // Parsing and formatting of Decimal(38, 18) values.
+    std::vector<std::string> values;
+    for (int i = 0; i < 1000; ++i) {
+        values.push_back(std::to_string(i * 7919) + "." + std::to_string(i * 104729 + 100000000));
+    }
+
+    while (state.KeepRunning()) {
+        ColumnDecimal col(38, 18);
+        for (const auto& value : values) {
+            col.Append(value);
+        }
+        for (size_t i = 0; i < col.Size(); ++i) {
+            benchmark::DoNotOptimize(col.AsString(i));
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * values.size());
+}
+BENCHMARK(DecimalStringConversion);
+
+static void DecimalRowAccess(benchmark::State& state) {
+    // Sum of 100000 Decimal(18, 4) values, by row or in bulk.
+    ColumnDecimal col(18, 4);
+    for (int64_t i = 0; i < 100000; ++i) {
+        col.Append(Int128(i));
+    }
+    std::vector<int64_t> values(col.Size());
+
+    while (state.KeepRunning()) {
+        Int128 sum = 0;
+        if (state.range(0) == 0) {
+            for (size_t i = 0; i < col.Size(); ++i) {
+                sum += col.At(i);
+            }
+        } else {
+            col.GetMany(0, values.size(), values.data());
+            for (const auto value : values) {
+                sum += value;
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetItemsProcessed(state.iterations() * col.Size());
+    state.SetLabel(state.range(0) == 0 ? "At" : "GetMany");
+}
+BENCHMARK(DecimalRowAccess)->DenseRange(0, 1);
+
+static void DateTimeToUnixNanos(benchmark::State& state) {
+    // Conversion of 100000 DateTime values by row, in bulk and to local time.
+    ColumnDateTime col;
+    for (std::time_t i = 0; i < 100000; ++i) {
+        col.Append(1600000000 + i * 60);
+    }
+    std::vector<int64_t> nanos(col.Size());
+    auto zone = TimeZone::Fixed("UTC+3", 3 * 3600);
+
+    while (state.KeepRunning()) {
+        if (state.range(0) == 0) {
+            for (size_t i = 0; i < col.Size(); ++i) {
+                nanos[i] = static_cast<int64_t>(col.At(i)) * 1000000000;
+            }
+        } else if (state.range(0) == 1) {
+            col.GetUnixNanos(0, col.Size(), nanos.data());
+        } else {
+            col.GetLocalUnixNanos(0, col.Size(), nanos.data(), *zone);
+        }
+        benchmark::DoNotOptimize(nanos.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * col.Size());
+    state.SetLabel(state.range(0) == 0 ? "At" : state.range(0) == 1 ? "GetUnixNanos" : "GetLocalUnixNanos");
+}
+BENCHMARK(DateTimeToUnixNanos)->DenseRange(0, 2);
+
+static void ArrowExport(benchmark::State& state) {
+    // Handing 1M rows of (UInt64, Nullable(Float64)) over by row or as Arrow arrays.
+    const size_t rows = 1000000;
+    auto ids = std::make_shared<ColumnUInt64>();
+    auto values = std::make_shared<ColumnFloat64>();
+    auto nulls = std::make_shared<ColumnUInt8>();
+    for (size_t i = 0; i < rows; ++i) {
+        ids->Append(i);
+        values->Append(i * 0.5);
+        nulls->Append(i % 10 == 0);
+    }
+    Block block;
+    block.AppendColumn("id", ids);
+    block.AppendColumn("value", std::make_shared<ColumnNullable>(values, nulls));
+    std::vector<uint64_t> out_ids(rows);
+    std::vector<double> out_values(rows);
+
+    while (state.KeepRunning()) {
+        if (state.range(0) == 0) {
+            auto col = block[1]->As<ColumnNullable>();
+            auto nested = col->Nested()->As<ColumnFloat64>();
+            for (size_t i = 0; i < rows; ++i) {
+                out_ids[i] = ids->At(i);
+                out_values[i] = col->IsNull(i) ? 0 : nested->At(i);
+            }
+            benchmark::DoNotOptimize(out_values.data());
+        } else {
+            ArrowArray array;
+            ArrowSchema schema;
+            ExportBlock(block, &array, &schema);
+            benchmark::DoNotOptimize(array.children[1]->buffers[0]);
+            array.release(&array);
+            schema.release(&schema);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * rows);
+    state.SetLabel(state.range(0) == 0 ? "At" : "ExportBlock");
+}
+BENCHMARK(ArrowExport)->DenseRange(0, 1);
+
+static void BuildBlock(benchmark::State& state) {
+    // Building a block of 100000 rows (Int64, String, Nullable(Float64)).
+    const size_t rows = 100000;
+    const std::string name = "name";
+    TypedBlockBuilder<Schema::Int64, Schema::String, Schema::Nullable<Schema::Float64>>
+        builder({"id", "name", "score"}, rows);
+
+    while (state.KeepRunning()) {
+        if (state.range(0) == 0) {
+            auto id = std::make_shared<ColumnInt64>();
+            auto names = std::make_shared<ColumnString>();
+            auto score = std::make_shared<ColumnNullable>(
+                std::make_shared<ColumnFloat64>(), std::make_shared<ColumnUInt8>());
+            for (size_t i = 0; i < rows; ++i) {
+                id->Append(i);
+                names->Append(name);
+                score->Nested()->As<ColumnFloat64>()->Append(i * 0.5);
+                score->Nulls()->As<ColumnUInt8>()->Append(0);
+            }
+            Block block;
+            block.AppendColumn("id", id);
+            block.AppendColumn("name", names);
+            block.AppendColumn("score", score);
+            benchmark::DoNotOptimize(block.GetRowCount());
+        } else {
+            for (size_t i = 0; i < rows; ++i) {
+                builder.AddRow(i, name, i * 0.5);
+            }
+            benchmark::DoNotOptimize(builder.Build().GetRowCount());
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * rows);
+    state.SetLabel(state.range(0) == 0 ? "Append" : "TypedBlockBuilder");
+}
+BENCHMARK(BuildBlock)->DenseRange(0, 1);
+
+static void ReadRows(benchmark::State& state) {
+    // Decoding 100000 rows of (UInt64, Float64, String) into structures.
+    struct Row {
+        uint64_t id;
+        double score;
+        std::string name;
+    };
+    const size_t rows = 100000;
+    TypedBlockBuilder<Schema::UInt64, Schema::Float64, Schema::String> builder({"id", "score", "name"});
+    for (size_t i = 0; i < rows; ++i) {
+        builder.AddRow(i, i * 0.5, "name");
+    }
+    const Block block = builder.Build();
+    RowMapper<Row> mapper;
+    mapper.Map("id", &Row::id).Map("score", &Row::score).Map("name", &Row::name);
+    std::vector<Row> out;
+
+    while (state.KeepRunning()) {
+        out.clear();
+        if (state.range(0) == 0) {
+            out.resize(block.GetRowCount());
+            for (size_t i = 0; i < block.GetRowCount(); ++i) {
+                out[i].id = block[0]->As<ColumnUInt64>()->At(i);
+                out[i].score = block[1]->As<ColumnFloat64>()->At(i);
+                out[i].name = block[2]->As<ColumnString>()->At(i);
+            }
+        } else {
+            mapper.Read(block, &out);
+        }
+        benchmark::DoNotOptimize(out.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * rows);
+    state.SetLabel(state.range(0) == 0 ? "At" : "RowMapper");
+}
+BENCHMARK(ReadRows)->DenseRange(0, 1);
+
+static void FilterColumn(benchmark::State& state) {
+    // Keeping every third of 100000 UInt64 values.
+    const size_t rows = 100000;
+    auto numbers = std::make_shared<ColumnUInt64>();
+    std::vector<uint8_t> mask(rows);
+    for (size_t i = 0; i < rows; ++i) {
+        numbers->Append(i);
+        mask[i] = i % 3 == 0;
+    }
+
+    while (state.KeepRunning()) {
+        ColumnRef result;
+        if (state.range(0) == 0) {
+            auto column = std::make_shared<ColumnUInt64>();
+            for (size_t i = 0; i < rows; ++i) {
+                if (mask[i]) {
+                    column->Append(numbers->At(i));
+                }
+            }
+            result = column;
+        } else {
+            result = numbers->Filter(mask.data());
+        }
+        benchmark::DoNotOptimize(result.get());
+    }
+
+    state.SetItemsProcessed(state.iterations() * rows);
+    state.SetLabel(state.range(0) == 0 ? "At" : "Filter");
+}
+BENCHMARK(FilterColumn)->DenseRange(0, 1);
+
+static void PartitionBlock(benchmark::State& state) {
+    // Routing 100000 rows of (UInt64, String) to 8 shards by the first column.
+    const size_t rows = 100000;
+    const size_t shards = 8;
+    TypedBlockBuilder<Schema::UInt64, Schema::String> builder({"id", "name"});
+    for (size_t i = 0; i < rows; ++i) {
+        builder.AddRow(i, "name");
+    }
+    const Block block = builder.Build();
+
+    while (state.KeepRunning()) {
+        std::vector<Block> parts;
+        if (state.range(0) == 0) {
+            auto ids = block[0]->As<ColumnUInt64>();
+            auto names = block[1]->As<ColumnString>();
+            std::vector<std::shared_ptr<ColumnUInt64>> part_ids;
+            std::vector<std::shared_ptr<ColumnString>> part_names;
+            for (size_t i = 0; i < shards; ++i) {
+                part_ids.push_back(std::make_shared<ColumnUInt64>());
+                part_names.push_back(std::make_shared<ColumnString>());
+            }
+            std::vector<uint64_t> hashes(rows);
+            HashColumn(ids, hashes.data());
+            for (size_t i = 0; i < rows; ++i) {
+                part_ids[hashes[i] % shards]->Append(ids->At(i));
+                part_names[hashes[i] % shards]->Append(names->At(i));
+            }
+            for (size_t i = 0; i < shards; ++i) {
+                parts.emplace_back();
+                parts.back().AppendColumn("id", part_ids[i]);
+                parts.back().AppendColumn("name", part_names[i]);
+            }
+        } else {
+            parts = block.PartitionByHash(0, shards);
+        }
+        benchmark::DoNotOptimize(parts.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * rows);
+    state.SetLabel(state.range(0) == 0 ? "At" : "PartitionByHash");
+}
+BENCHMARK(PartitionBlock)->DenseRange(0, 1);
+
+static void ColumnStatistics(benchmark::State& state) {
+    // Min, max and sum of 100000 Int64 values.
+    const size_t rows = 100000;
+    auto numbers = std::make_shared<ColumnInt64>();
+    for (size_t i = 0; i < rows; ++i) {
+        numbers->Append(static_cast<int64_t>(i * 7919 % rows));
+    }
+
+    while (state.KeepRunning()) {
+        if (state.range(0) == 0) {
+            int64_t min = numbers->At(0);
+            int64_t max = numbers->At(0);
+            Int128 sum = 0;
+            for (size_t i = 0; i < rows; ++i) {
+                min = std::min(min, numbers->At(i));
+                max = std::max(max, numbers->At(i));
+                sum += numbers->At(i);
+            }
+            benchmark::DoNotOptimize(sum);
+        } else {
+            // Also estimates count of distinct values.
+            auto stats = ComputeStats(numbers);
+            benchmark::DoNotOptimize(stats.distinct);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * rows);
+    state.SetLabel(state.range(0) == 0 ? "At" : "ComputeStats");
+}
+BENCHMARK(ColumnStatistics)->DenseRange(0, 1);
+
 }
 
 BENCHMARK_MAIN();
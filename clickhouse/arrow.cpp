@@ -0,0 +1,635 @@
+#include "arrow.h"
+
+#include "columns/array.h"
+#include "columns/date.h"
+#include "columns/decimal.h"
+#include "columns/nullable.h"
+#include "columns/numeric.h"
+#include "columns/string.h"
+#include "columns/tuple.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace clickhouse {
+namespace {
+
+/// Private data of an exported array.
+struct ArrayData {
+    /// Keeps buffers borrowed from the column alive.
+    ColumnRef column;
+    /// Buffers allocated for the export.
+    std::vector<std::unique_ptr<uint8_t[]>> storage;
+    std::vector<const void*> buffers;
+    std::vector<ArrowArray> children;
+    std::vector<ArrowArray*> child_ptrs;
+
+    ~ArrayData() {
+        for (auto& child : children) {
+            if (child.release) {
+                child.release(&child);
+            }
+        }
+    }
+
+    /// Allocates memory for count values, owned by the array.
+    template <typename T>
+    T* Allocate(size_t count) {
+        storage.emplace_back(new uint8_t[count * sizeof(T)]);
+        return reinterpret_cast<T*>(storage.back().get());
+    }
+
+    /// Allocates buffer for count values and appends it to the buffers.
+    template <typename T>
+    T* AddBuffer(size_t count) {
+        T* buffer = Allocate<T>(count);
+        buffers.push_back(buffer);
+        return buffer;
+    }
+};
+
+/// Private data of an exported schema.
+struct SchemaData {
+    std::string format;
+    std::string name;
+    std::vector<ArrowSchema> children;
+    std::vector<ArrowSchema*> child_ptrs;
+
+    ~SchemaData() {
+        for (auto& child : children) {
+            if (child.release) {
+                child.release(&child);
+            }
+        }
+    }
+};
+
+void ReleaseArray(ArrowArray* array) {
+    delete static_cast<ArrayData*>(array->private_data);
+    array->release = nullptr;
+}
+
+void ReleaseSchema(ArrowSchema* schema) {
+    delete static_cast<SchemaData*>(schema->private_data);
+    schema->release = nullptr;
+}
+
+/// Hands the private data over to the structures.
+void Finish(std::unique_ptr<ArrayData> data, std::unique_ptr<SchemaData> type,
+            size_t length, size_t null_count, int64_t flags,
+            ArrowArray* array, ArrowSchema* schema)
+{
+    for (auto& child : data->children) {
+        data->child_ptrs.push_back(&child);
+    }
+    for (auto& child : type->children) {
+        type->child_ptrs.push_back(&child);
+    }
+
+    array->length = static_cast<int64_t>(length);
+    array->null_count = static_cast<int64_t>(null_count);
+    array->offset = 0;
+    array->n_buffers = static_cast<int64_t>(data->buffers.size());
+    array->n_children = static_cast<int64_t>(data->children.size());
+    array->buffers = data->buffers.data();
+    array->children = data->child_ptrs.empty() ? nullptr : data->child_ptrs.data();
+    array->dictionary = nullptr;
+    array->release = &ReleaseArray;
+    array->private_data = data.release();
+
+    schema->format = type->format.c_str();
+    schema->name = type->name.c_str();
+    schema->metadata = nullptr;
+    schema->flags = flags;
+    schema->n_children = static_cast<int64_t>(type->children.size());
+    schema->children = type->child_ptrs.empty() ? nullptr : type->child_ptrs.data();
+    schema->dictionary = nullptr;
+    schema->release = &ReleaseSchema;
+    schema->private_data = type.release();
+}
+
+void Export(const ColumnRef& column, std::string name, ArrowArray* array, ArrowSchema* schema);
+
+/// Exports children of a nested array.
+void ExportChildren(const std::vector<std::pair<std::string, ColumnRef>>& columns,
+                    ArrayData* data, SchemaData* type)
+{
+    data->children.resize(columns.size());
+    type->children.resize(columns.size());
+
+    for (size_t i = 0; i < columns.size(); ++i) {
+        Export(columns[i].second, columns[i].first, &data->children[i], &type->children[i]);
+    }
+}
+
+template <typename T>
+void ExportVector(const ColumnRef& column, const char* format, ArrayData* data, SchemaData* type) {
+    // Zero-copy: the array references the column data.
+    data->buffers.push_back(column->As<ColumnVector<T>>()->GetData().data());
+    type->format = format;
+}
+
+/// Fills value buffers, children and format of the non-nullable column.
+void ExportValues(const ColumnRef& column, ArrayData* data, SchemaData* type) {
+    const size_t rows = column->Size();
+
+    switch (column->Type()->GetCode()) {
+        case Type::Int8:    return ExportVector<int8_t>(column, "c", data, type);
+        case Type::Int16:   return ExportVector<int16_t>(column, "s", data, type);
+        case Type::Int32:   return ExportVector<int32_t>(column, "i", data, type);
+        case Type::Int64:   return ExportVector<int64_t>(column, "l", data, type);
+        case Type::UInt8:   return ExportVector<uint8_t>(column, "C", data, type);
+        case Type::UInt16:  return ExportVector<uint16_t>(column, "S", data, type);
+        case Type::UInt32:  return ExportVector<uint32_t>(column, "I", data, type);
+        case Type::UInt64:  return ExportVector<uint64_t>(column, "L", data, type);
+        case Type::Float32: return ExportVector<float>(column, "f", data, type);
+        case Type::Float64: return ExportVector<double>(column, "g", data, type);
+
+        case Type::String: {
+            auto col = column->As<ColumnString>();
+            int64_t* offsets = data->AddBuffer<int64_t>(rows + 1);
+            offsets[0] = 0;
+            for (size_t i = 0; i < rows; ++i) {
+                offsets[i + 1] = offsets[i] + static_cast<int64_t>(col->At(i).size());
+            }
+            char* chars = data->AddBuffer<char>(offsets[rows]);
+            for (size_t i = 0; i < rows; ++i) {
+                std::memcpy(chars + offsets[i], col->At(i).data(), col->At(i).size());
+            }
+            type->format = "U";
+            return;
+        }
+
+        case Type::FixedString: {
+            auto col = column->As<ColumnFixedString>();
+            const size_t n = col->FixedSize();
+            char* chars = data->AddBuffer<char>(rows * n);
+            for (size_t i = 0; i < rows; ++i) {
+                std::memcpy(chars + i * n, col->At(i).data(), n);
+            }
+            type->format = "w:" + std::to_string(n);
+            return;
+        }
+
+        case Type::Date: {
+            auto col = column->As<ColumnDate>();
+            int32_t* days = data->AddBuffer<int32_t>(rows);
+            for (size_t i = 0; i < rows; ++i) {
+                days[i] = static_cast<int32_t>(col->At(i) / 86400);
+            }
+            type->format = "tdD";
+            return;
+        }
+
+        case Type::Date32: {
+            auto col = column->As<ColumnDate32>();
+            int32_t* days = data->AddBuffer<int32_t>(rows);
+            for (size_t i = 0; i < rows; ++i) {
+                days[i] = static_cast<int32_t>(col->At(i) / 86400);
+            }
+            type->format = "tdD";
+            return;
+        }
+
+        case Type::DateTime: {
+            auto col = column->As<ColumnDateTime>();
+            int64_t* seconds = data->AddBuffer<int64_t>(rows);
+            for (size_t i = 0; i < rows; ++i) {
+                seconds[i] = static_cast<int64_t>(col->At(i));
+            }
+            type->format = "tss:" + col->Timezone();
+            return;
+        }
+
+        case Type::DateTime64: {
+            auto col = column->As<ColumnDateTime64>();
+            int64_t* ticks = data->AddBuffer<int64_t>(rows);
+            char unit = 0;
+            switch (col->GetPrecision()) {
+                case 0: unit = 's'; break;
+                case 3: unit = 'm'; break;
+                case 6: unit = 'u'; break;
+                case 9: unit = 'n'; break;
+            }
+            if (unit) {
+                for (size_t i = 0; i < rows; ++i) {
+                    ticks[i] = static_cast<int64_t>(col->At(i));
+                }
+            } else {
+                // Arrow has no units for other precisions.
+                unit = 'n';
+                col->GetUnixNanos(0, rows, ticks);
+            }
+            type->format = std::string("ts") + unit + ":" + col->Timezone();
+            return;
+        }
+
+        case Type::Decimal:
+        case Type::Decimal32:
+        case Type::Decimal64:
+        case Type::Decimal128:
+        case Type::Decimal256: {
+            auto col = column->As<ColumnDecimal>();
+            type->format = "d:" + std::to_string(col->GetPrecision()) + "," + std::to_string(col->GetScale());
+            if (col->GetPrecision() > 38) {
+                col->GetMany(0, rows, data->AddBuffer<Int256>(rows));
+                type->format += ",256";
+            } else {
+                col->GetMany(0, rows, data->AddBuffer<Int128>(rows));
+            }
+            return;
+        }
+
+        case Type::Array: {
+            auto col = column->As<ColumnArray>();
+            int64_t* offsets = data->AddBuffer<int64_t>(rows + 1);
+            offsets[0] = 0;
+            for (size_t i = 0; i < rows; ++i) {
+                offsets[i + 1] = static_cast<int64_t>(col->GetOffset(i) + col->GetSize(i));
+            }
+            ExportChildren({{"item", col->GetData()}}, data, type);
+            type->format = "+L";
+            return;
+        }
+
+        case Type::Tuple: {
+            auto col = column->As<ColumnTuple>();
+            std::vector<std::pair<std::string, ColumnRef>> fields;
+            for (size_t i = 0; i < col->TupleSize(); ++i) {
+                fields.emplace_back(std::string(), (*col)[i]);
+            }
+            ExportChildren(fields, data, type);
+            type->format = "+s";
+            return;
+        }
+
+        default:
+            throw std::runtime_error("can't export column of type " + column->Type()->GetName() + " to Arrow");
+    }
+}
+
+void Export(const ColumnRef& column, std::string name, ArrowArray* array, ArrowSchema* schema) {
+    auto data = std::make_unique<ArrayData>();
+    auto type = std::make_unique<SchemaData>();
+    size_t null_count = 0;
+    int64_t flags = 0;
+
+    data->column = column;
+    type->name = std::move(name);
+
+    // Validity bitmap, absent if all rows are valid.
+    data->buffers.push_back(nullptr);
+
+    if (auto nullable = column->As<ColumnNullable>()) {
+        null_count = nullable->NullCount();
+        if (null_count) {
+            uint8_t* bitmap = data->Allocate<uint8_t>((column->Size() + 7) / 8);
+            nullable->GetNullBitmap(bitmap, true);
+            data->buffers[0] = bitmap;
+        }
+        flags |= ARROW_FLAG_NULLABLE;
+        ExportValues(nullable->Nested(), data.get(), type.get());
+    } else {
+        ExportValues(column, data.get(), type.get());
+    }
+
+    Finish(std::move(data), std::move(type), column->Size(), null_count, flags, array, schema);
+}
+
+
+/// Releases imported structures on scope exit.
+class ReleaseGuard {
+public:
+    ReleaseGuard(ArrowArray* array, ArrowSchema* schema)
+        : array_(array)
+        , schema_(schema)
+    {
+    }
+
+    ~ReleaseGuard() {
+        if (array_->release) {
+            array_->release(array_);
+        }
+        if (schema_->release) {
+            schema_->release(schema_);
+        }
+    }
+
+private:
+    ArrowArray* array_;
+    ArrowSchema* schema_;
+};
+
+template <typename T>
+const T* GetBuffer(const ArrowArray* array, int64_t index) {
+    if (array->n_buffers <= index) {
+        throw std::runtime_error("Arrow array has too few buffers");
+    }
+    return static_cast<const T*>(array->buffers[index]);
+}
+
+/// Returns true if the element at given position is not NULL.
+bool IsValid(const ArrowArray* array, size_t i) {
+    const uint8_t* bitmap = static_cast<const uint8_t*>(array->buffers[0]);
+    const size_t bit = static_cast<size_t>(array->offset) + i;
+    return !bitmap || (bitmap[bit / 8] >> (bit % 8)) & 1;
+}
+
+bool HasNulls(const ArrowArray* array) {
+    if (array->null_count == 0 || array->n_buffers == 0 || !array->buffers[0]) {
+        return false;
+    }
+    if (array->null_count > 0) {
+        return true;
+    }
+    // The count is unknown.
+    for (size_t i = 0; i < static_cast<size_t>(array->length); ++i) {
+        if (!IsValid(array, i)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/// Parses unsigned number at given position of the format, advancing it.
+size_t ParseNumber(std::string_view format, size_t* pos) {
+    size_t value = 0;
+    const size_t begin = *pos;
+    for (; *pos < format.size() && format[*pos] >= '0' && format[*pos] <= '9'; ++*pos) {
+        value = value * 10 + static_cast<size_t>(format[*pos] - '0');
+    }
+    if (*pos == begin) {
+        throw std::runtime_error("invalid Arrow format: " + std::string(format));
+    }
+    return value;
+}
+
+ColumnRef Import(const ArrowArray* array, const ArrowSchema* schema);
+
+template <typename T>
+ColumnRef ImportVector(const ArrowArray* array) {
+    const T* values = GetBuffer<T>(array, 1) + array->offset;
+    auto column = std::make_shared<ColumnVector<T>>();
+    column->Append(values, values + array->length);
+    return column;
+}
+
+template <typename T>
+ColumnRef ImportStrings(const ArrowArray* array) {
+    const T* offsets = GetBuffer<T>(array, 1) + array->offset;
+    const char* chars = GetBuffer<char>(array, 2);
+    auto column = std::make_shared<ColumnString>();
+    column->Reserve(static_cast<size_t>(array->length));
+    for (int64_t i = 0; i < array->length; ++i) {
+        column->Append(std::string(chars + offsets[i], static_cast<size_t>(offsets[i + 1] - offsets[i])));
+    }
+    return column;
+}
+
+/// Appends decimals of the given width, copying them to aligned values.
+template <typename T>
+void AppendDecimals(const ArrowArray* array, ColumnDecimal* column) {
+    const uint8_t* bytes = GetBuffer<uint8_t>(array, 1) + array->offset * sizeof(T);
+    T chunk[256];
+    for (size_t i = 0; i < static_cast<size_t>(array->length); i += 256) {
+        const size_t count = std::min<size_t>(256, static_cast<size_t>(array->length) - i);
+        std::memcpy(static_cast<void*>(chunk), bytes + i * sizeof(T), count * sizeof(T));
+        column->AppendMany(chunk, count);
+    }
+}
+
+ColumnRef ImportDecimal(const ArrowArray* array, std::string_view format) {
+    size_t pos = 2;
+    const size_t precision = ParseNumber(format, &pos);
+    if (pos >= format.size() || format[pos++] != ',') {
+        throw std::runtime_error("invalid Arrow format: " + std::string(format));
+    }
+    const size_t scale = ParseNumber(format, &pos);
+    size_t bits = 128;
+    if (pos < format.size() && format[pos++] == ',') {
+        bits = ParseNumber(format, &pos);
+    }
+
+    auto column = std::make_shared<ColumnDecimal>(precision, scale);
+    column->Reserve(static_cast<size_t>(array->length));
+    switch (bits) {
+        case 32:  AppendDecimals<int32_t>(array, column.get()); break;
+        case 64:  AppendDecimals<int64_t>(array, column.get()); break;
+        case 128: AppendDecimals<Int128>(array, column.get()); break;
+        case 256: AppendDecimals<Int256>(array, column.get()); break;
+        default:
+            throw std::runtime_error("unsupported Arrow format: " + std::string(format));
+    }
+    return column;
+}
+
+template <typename T>
+ColumnRef ImportList(const ArrowArray* array, const ArrowSchema* schema) {
+    if (array->n_children != 1 || schema->n_children != 1) {
+        throw std::runtime_error("Arrow list must have one child");
+    }
+
+    const T* offsets = GetBuffer<T>(array, 1) + array->offset;
+    const size_t begin = static_cast<size_t>(offsets[0]);
+    const size_t end = static_cast<size_t>(offsets[array->length]);
+
+    ColumnRef items = Import(array->children[0], schema->children[0]);
+    if (begin > end || end > items->Size()) {
+        throw std::runtime_error("Arrow list offsets are out of range");
+    }
+    if (begin != 0 || end != items->Size()) {
+        items = items->Slice(begin, end - begin);
+    }
+
+    auto column = std::make_shared<ColumnArray>(items);
+    for (int64_t i = 0; i < array->length; ++i) {
+        column->OffsetsIncrease(static_cast<size_t>(offsets[i + 1]) - begin);
+    }
+    return column;
+}
+
+std::vector<ColumnRef> ImportFields(const ArrowArray* array, const ArrowSchema* schema) {
+    if (array->n_children != schema->n_children) {
+        throw std::runtime_error("Arrow array and schema have different count of children");
+    }
+
+    const size_t offset = static_cast<size_t>(array->offset);
+    const size_t length = static_cast<size_t>(array->length);
+    std::vector<ColumnRef> fields;
+
+    for (int64_t i = 0; i < array->n_children; ++i) {
+        ColumnRef field = Import(array->children[i], schema->children[i]);
+        if (offset + length > field->Size()) {
+            throw std::runtime_error("Arrow struct field is shorter than the struct");
+        }
+        if (offset != 0 || length != field->Size()) {
+            field = field->Slice(offset, length);
+        }
+        fields.push_back(field);
+    }
+    return fields;
+}
+
+/// Imports values of the array ignoring its validity bitmap.
+ColumnRef ImportValues(const ArrowArray* array, const ArrowSchema* schema, std::string_view format) {
+    if (format.size() == 1) {
+        switch (format[0]) {
+            case 'c': return ImportVector<int8_t>(array);
+            case 's': return ImportVector<int16_t>(array);
+            case 'i': return ImportVector<int32_t>(array);
+            case 'l': return ImportVector<int64_t>(array);
+            case 'C': return ImportVector<uint8_t>(array);
+            case 'S': return ImportVector<uint16_t>(array);
+            case 'I': return ImportVector<uint32_t>(array);
+            case 'L': return ImportVector<uint64_t>(array);
+            case 'f': return ImportVector<float>(array);
+            case 'g': return ImportVector<double>(array);
+            case 'u':
+            case 'z': return ImportStrings<int32_t>(array);
+            case 'U':
+            case 'Z': return ImportStrings<int64_t>(array);
+
+            case 'b': {
+                const uint8_t* bits = GetBuffer<uint8_t>(array, 1);
+                auto column = std::make_shared<ColumnUInt8>();
+                column->Reserve(static_cast<size_t>(array->length));
+                for (int64_t i = 0; i < array->length; ++i) {
+                    const int64_t bit = array->offset + i;
+                    column->Append((bits[bit / 8] >> (bit % 8)) & 1);
+                }
+                return column;
+            }
+        }
+    } else if (format.substr(0, 2) == "w:") {
+        size_t pos = 2;
+        const size_t n = ParseNumber(format, &pos);
+        const char* chars = GetBuffer<char>(array, 1) + array->offset * n;
+        auto column = std::make_shared<ColumnFixedString>(n);
+        column->Reserve(static_cast<size_t>(array->length));
+        for (int64_t i = 0; i < array->length; ++i) {
+            column->Append(std::string(chars + i * n, n));
+        }
+        return column;
+    } else if (format == "tdD") {
+        const int32_t* days = GetBuffer<int32_t>(array, 1) + array->offset;
+        auto column = std::make_shared<ColumnDate32>();
+        column->Reserve(static_cast<size_t>(array->length));
+        for (int64_t i = 0; i < array->length; ++i) {
+            column->Append(static_cast<std::time_t>(days[i]) * 86400);
+        }
+        return column;
+    } else if (format.size() >= 4 && format.substr(0, 2) == "ts" && format[3] == ':') {
+        const int64_t* ticks = GetBuffer<int64_t>(array, 1) + array->offset;
+        const std::string timezone(format.substr(4));
+        size_t precision = 0;
+        switch (format[2]) {
+            case 's': {
+                auto column = std::make_shared<ColumnDateTime>(timezone);
+                column->Reserve(static_cast<size_t>(array->length));
+                for (int64_t i = 0; i < array->length; ++i) {
+                    column->Append(static_cast<std::time_t>(ticks[i]));
+                }
+                return column;
+            }
+            case 'm': precision = 3; break;
+            case 'u': precision = 6; break;
+            case 'n': precision = 9; break;
+            default:
+                throw std::runtime_error("unsupported Arrow format: " + std::string(format));
+        }
+        auto column = std::make_shared<ColumnDateTime64>(precision, timezone);
+        column->Reserve(static_cast<size_t>(array->length));
+        for (int64_t i = 0; i < array->length; ++i) {
+            column->Append(static_cast<uint64_t>(ticks[i]));
+        }
+        return column;
+    } else if (format.substr(0, 2) == "d:") {
+        return ImportDecimal(array, format);
+    } else if (format == "+l") {
+        return ImportList<int32_t>(array, schema);
+    } else if (format == "+L") {
+        return ImportList<int64_t>(array, schema);
+    } else if (format == "+s") {
+        return std::make_shared<ColumnTuple>(ImportFields(array, schema));
+    }
+
+    throw std::runtime_error("unsupported Arrow format: " + std::string(format));
+}
+
+ColumnRef Import(const ArrowArray* array, const ArrowSchema* schema) {
+    if (schema->dictionary || array->dictionary) {
+        throw std::runtime_error("dictionary-encoded Arrow arrays are not supported");
+    }
+
+    const std::string_view format(schema->format);
+    ColumnRef values = ImportValues(array, schema, format);
+
+    if (format[0] == '+') {
+        // Neither Array nor Tuple can be inside Nullable.
+        if (HasNulls(array)) {
+            throw std::runtime_error("can't import Arrow " + std::string(format) + " array with NULL values");
+        }
+        return values;
+    }
+    if (!(schema->flags & ARROW_FLAG_NULLABLE) && !HasNulls(array)) {
+        return values;
+    }
+
+    auto nulls = std::make_shared<ColumnUInt8>();
+    nulls->Reserve(static_cast<size_t>(array->length));
+    for (size_t i = 0; i < static_cast<size_t>(array->length); ++i) {
+        nulls->Append(!IsValid(array, i));
+    }
+    return std::make_shared<ColumnNullable>(values, nulls);
+}
+
+}
+
+void ExportColumn(const ColumnRef& column, ArrowArray* array, ArrowSchema* schema) {
+    Export(column, std::string(), array, schema);
+}
+
+void ExportBlock(const Block& block, ArrowArray* array, ArrowSchema* schema) {
+    auto data = std::make_unique<ArrayData>();
+    auto type = std::make_unique<SchemaData>();
+    std::vector<std::pair<std::string, ColumnRef>> columns;
+
+    for (Block::Iterator bi(block); bi.IsValid(); bi.Next()) {
+        columns.emplace_back(bi.Name(), bi.Column());
+    }
+
+    data->buffers.push_back(nullptr);
+    ExportChildren(columns, data.get(), type.get());
+    type->format = "+s";
+
+    Finish(std::move(data), std::move(type), block.GetRowCount(), 0, 0, array, schema);
+}
+
+ColumnRef ImportColumn(ArrowArray* array, ArrowSchema* schema) {
+    ReleaseGuard guard(array, schema);
+    return Import(array, schema);
+}
+
+Block ImportBlock(ArrowArray* array, ArrowSchema* schema) {
+    ReleaseGuard guard(array, schema);
+
+    if (std::string_view(schema->format) != "+s") {
+        throw std::runtime_error("Arrow array of a block must be a struct");
+    }
+
+    const std::vector<ColumnRef> fields = ImportFields(array, schema);
+    Block block(fields.size(), static_cast<size_t>(array->length));
+
+    for (size_t i = 0; i < fields.size(); ++i) {
+        const char* name = schema->children[i]->name;
+        block.AppendColumn(name ? name : "", fields[i]);
+    }
+    return block;
+}
+
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "block.h"
+
+#include <cstdint>
+
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+/// Structures of the Apache Arrow C Data Interface, see
+/// https://arrow.apache.org/docs/format/CDataInterface.html
+extern "C" {
+
+struct ArrowSchema {
+    const char* format;
+    const char* name;
+    const char* metadata;
+    int64_t flags;
+    int64_t n_children;
+    struct ArrowSchema** children;
+    struct ArrowSchema* dictionary;
+
+    void (*release)(struct ArrowSchema*);
+    void* private_data;
+};
+
+struct ArrowArray {
+    int64_t length;
+    int64_t null_count;
+    int64_t offset;
+    int64_t n_buffers;
+    int64_t n_children;
+    const void** buffers;
+    struct ArrowArray** children;
+    struct ArrowArray* dictionary;
+
+    void (*release)(struct ArrowArray*);
+    void* private_data;
+};
+
+}
+
+#endif  // ARROW_C_DATA_INTERFACE
+
+namespace clickhouse {
+
+/**
+ * Conversion of blocks and columns to and from the Arrow C Data Interface.
+ *
+ * Supported types are (U)Int8-64, Float32/64, String, FixedString, Date,
+ * Date32, DateTime, DateTime64, Decimal, and Array, Nullable and Tuple
+ * of them.  Buffers of numeric columns are exported without copying, the
+ * exported array holds a reference to the column until released.  Null
+ * flags of Nullable columns become validity bitmaps.
+ *
+ * Functions throw std::runtime_error on unsupported types.
+ */
+
+/// Exports column as an array and its schema.  Both structures must be
+/// released by the consumer.
+void ExportColumn(const ColumnRef& column, ArrowArray* array, ArrowSchema* schema);
+
+/// Exports block as a struct array whose fields are the columns.
+void ExportBlock(const Block& block, ArrowArray* array, ArrowSchema* schema);
+
+/// Imports column by copying data of the array.  Takes ownership of the
+/// structures: they are released even if the import fails.
+ColumnRef ImportColumn(ArrowArray* array, ArrowSchema* schema);
+
+/// Imports block from a struct array.  Takes ownership of the structures.
+Block ImportBlock(ArrowArray* array, ArrowSchema* schema);
+
+}
@@ -1,11 +1,17 @@
 #include "socket.h"
 #include "singleton.h"
 
+#include <algorithm>
 #include <assert.h>
+#include <future>
 #include <stdexcept>
 #include <system_error>
+#include <tuple>
 #include <unordered_set>
 #include <memory.h>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 #if !defined(_win_)
 #   include <errno.h>
@@ -35,6 +41,93 @@ public:
     }
 };
 
+/// Resolved addresses shared between NetworkAddress instances.
+class AddressCache {
+public:
+    using InfoRef = std::shared_ptr<const struct addrinfo>;
+
+    InfoRef Find(const std::string& key, std::chrono::steady_clock::time_point now) {
+        std::lock_guard<std::mutex> guard(lock_);
+
+        auto it = entries_.find(key);
+        if (it == entries_.end()) {
+            return InfoRef();
+        }
+        if (it->second.expires <= now) {
+            entries_.erase(it);
+            return InfoRef();
+        }
+        return it->second.info;
+    }
+
+    void Insert(const std::string& key, InfoRef info, std::chrono::steady_clock::time_point expires) {
+        std::lock_guard<std::mutex> guard(lock_);
+
+        // Expired entries of other hosts are dropped here, so the cache
+        // doesn't grow with hosts which are never looked up again.
+        const auto now = std::chrono::steady_clock::now();
+        for (auto it = entries_.begin(); it != entries_.end(); ) {
+            if (it->second.expires <= now) {
+                it = entries_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        entries_[key] = Entry{std::move(info), expires};
+    }
+
+private:
+    struct Entry {
+        InfoRef info;
+        std::chrono::steady_clock::time_point expires;
+    };
+
+    std::mutex lock_;
+    std::unordered_map<std::string, Entry> entries_;
+};
+
+/// Resolves addresses of the host of given family.  Returns null and
+/// sets error on failure.
+struct addrinfo* Resolve(const std::string& host, const std::string& port, int family, int flags, int* error) {
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+
+    hints.ai_family = family;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = flags;
+
+    struct addrinfo* info = nullptr;
+    *error = getaddrinfo(host.c_str(), port.c_str(), &hints, &info);
+    return *error ? nullptr : info;
+}
+
+/// Chains two lists returned by getaddrinfo into one, which is freed
+/// as two lists again.  Either list may be null.
+std::shared_ptr<const struct addrinfo> ChainAddresses(struct addrinfo* first, struct addrinfo* second) {
+    if (!first && !second) {
+        return std::shared_ptr<const struct addrinfo>();
+    }
+    if (!first) {
+        return std::shared_ptr<const struct addrinfo>(second, freeaddrinfo);
+    }
+    if (!second) {
+        return std::shared_ptr<const struct addrinfo>(first, freeaddrinfo);
+    }
+
+    struct addrinfo* tail = first;
+    while (tail->ai_next) {
+        tail = tail->ai_next;
+    }
+    tail->ai_next = second;
+
+    return std::shared_ptr<const struct addrinfo>(first, [tail, second] (struct addrinfo* head) {
+        tail->ai_next = nullptr;
+        freeaddrinfo(head);
+        freeaddrinfo(second);
+    });
+}
+
 void SetNonBlock(SOCKET fd, bool value) {
 #if defined(_unix_)
     int flags;
@@ -86,16 +179,26 @@ void SetTimeout(SOCKET fd, SocketTimeoutParams params) {
 
 } // namespace
 
-NetworkAddress::NetworkAddress(const std::string& host, const std::string& port)
-    : info_(nullptr)
-{
-    struct addrinfo hints;
-    memset(&hints, 0, sizeof(hints));
+NetworkAddress::NetworkAddress(const std::string& host, const std::string& port, std::chrono::seconds cache_ttl) {
+    const std::string key = host + ":" + port;
+    const auto now = std::chrono::steady_clock::now();
 
-    hints.ai_family = PF_UNSPEC;
-    hints.ai_socktype = SOCK_STREAM;
+    if (cache_ttl.count() > 0) {
+        info_ = Singleton<AddressCache>()->Find(key, now);
+        if (info_) {
+            return;
+        }
+    }
 
-    if (!Singleton<LocalNames>()->IsLocalName(host)) {
+    if (Singleton<LocalNames>()->IsLocalName(host)) {
+        int error = 0;
+        struct addrinfo* info = Resolve(host, port, PF_UNSPEC, 0, &error);
+
+        if (error) {
+            throw std::system_error(errno, std::system_category());
+        }
+        info_.reset(info, freeaddrinfo);
+    } else {
         // https://linux.die.net/man/3/getaddrinfo
         // If hints.ai_flags includes the AI_ADDRCONFIG flag,
         // then IPv4 addresses are returned in the list pointed to by res only
@@ -104,24 +207,35 @@ NetworkAddress::NetworkAddress(const std::string& host, const std::string& port)
         // has at least one IPv6 address configured.
         // The loopback address is not considered for this case
         // as valid as a configured address.
-        hints.ai_flags |= AI_ADDRCONFIG;
+        // AAAA and A records are queried in parallel, so a slow answer
+        // for one family doesn't delay connecting to the other (RFC 8305).
+        // IPv6 addresses are listed first, as the default address
+        // selection of RFC 6724 does.
+        int v4_error = 0;
+        auto v4 = std::async(std::launch::async, [&host, &port, &v4_error] {
+            return Resolve(host, port, AF_INET, AI_ADDRCONFIG, &v4_error);
+        });
+
+        int v6_error = 0;
+        struct addrinfo* v6_info = Resolve(host, port, AF_INET6, AI_ADDRCONFIG, &v6_error);
+        const int v6_errno = errno;
+
+        info_ = ChainAddresses(v6_info, v4.get());
+
+        if (!info_) {
+            throw std::system_error(v6_errno, std::system_category());
+        }
     }
 
-    const int error = getaddrinfo(host.c_str(), port.c_str(), &hints, &info_);
-
-    if (error) {
-        throw std::system_error(errno, std::system_category());
+    if (cache_ttl.count() > 0) {
+        Singleton<AddressCache>()->Insert(key, info_, now + cache_ttl);
     }
 }
 
-NetworkAddress::~NetworkAddress() {
-    if (info_) {
-        freeaddrinfo(info_);
-    }
-}
+NetworkAddress::~NetworkAddress() = default;
 
 const struct addrinfo* NetworkAddress::Info() const {
-    return info_;
+    return info_.get();
 }
 
 
@@ -175,6 +289,12 @@ bool SocketHolder::Closed() const noexcept {
     return handle_ == -1;
 }
 
+SOCKET SocketHolder::Release() noexcept {
+    SOCKET s = handle_;
+    handle_ = -1;
+    return s;
+}
+
 void SocketHolder::SetTcpKeepAlive(int idle, int intvl, int cnt) noexcept {
     int val = 1;
     
@@ -195,6 +315,50 @@ void SocketHolder::SetTcpKeepAlive(int idle, int intvl, int cnt) noexcept {
 #endif
 }
 
+void SocketHolder::SetTcpNoDelay(bool nodelay) noexcept {
+    int val = nodelay;
+#if defined(_unix_)
+    setsockopt(handle_, IPPROTO_TCP, TCP_NODELAY, &val, sizeof(val));
+#else
+    setsockopt(handle_, IPPROTO_TCP, TCP_NODELAY, (const char*)&val, sizeof(val));
+#endif
+}
+
+void SocketHolder::SetBufferSizes(int recv_size, int send_size) noexcept {
+#if defined(_unix_)
+    if (recv_size > 0) {
+        setsockopt(handle_, SOL_SOCKET, SO_RCVBUF, &recv_size, sizeof(recv_size));
+    }
+    if (send_size > 0) {
+        setsockopt(handle_, SOL_SOCKET, SO_SNDBUF, &send_size, sizeof(send_size));
+    }
+#else
+    if (recv_size > 0) {
+        setsockopt(handle_, SOL_SOCKET, SO_RCVBUF, (const char*)&recv_size, sizeof(recv_size));
+    }
+    if (send_size > 0) {
+        setsockopt(handle_, SOL_SOCKET, SO_SNDBUF, (const char*)&send_size, sizeof(send_size));
+    }
+#endif
+}
+
+void SocketHolder::SetBusyPoll(int usec) noexcept {
+#if defined(_linux_) && defined(SO_BUSY_POLL)
+    setsockopt(handle_, SOL_SOCKET, SO_BUSY_POLL, &usec, sizeof(usec));
+#else
+    std::ignore = usec;
+#endif
+}
+
+void SocketHolder::SetTcpQuickAck(bool quickack) noexcept {
+#if defined(_linux_) && defined(TCP_QUICKACK)
+    int val = quickack;
+    setsockopt(handle_, IPPROTO_TCP, TCP_QUICKACK, &val, sizeof(val));
+#else
+    std::ignore = quickack;
+#endif
+}
+
 SocketHolder& SocketHolder::operator = (SocketHolder&& other) noexcept {
     if (this != &other) {
         Close();
@@ -211,8 +375,9 @@ SocketHolder::operator SOCKET () const noexcept {
 }
 
 
-SocketInput::SocketInput(SOCKET s)
+SocketInput::SocketInput(SOCKET s, bool quickack)
     : s_(s)
+    , quickack_(quickack)
 {
 }
 
@@ -222,6 +387,14 @@ size_t SocketInput::DoRead(void* buf, size_t len) {
     const ssize_t ret = ::recv(s_, (char*)buf, (int)len, 0);
 
     if (ret > 0) {
+#if defined(_linux_) && defined(TCP_QUICKACK)
+        if (quickack_) {
+            int val = 1;
+            setsockopt(s_, IPPROTO_TCP, TCP_QUICKACK, &val, sizeof(val));
+        }
+#else
+        std::ignore = quickack_;
+#endif
         return (size_t)ret;
     }
 
@@ -280,48 +453,141 @@ NetworkInitializer::NetworkInitializer() {
 }
 
 
-SOCKET SocketConnect(const NetworkAddress& addr, const std::optional<SocketTimeoutParams>& socket_timeout_params) {
+SOCKET SocketConnect(const NetworkAddress& addr,
+                     const std::optional<SocketTimeoutParams>& socket_timeout_params,
+                     std::chrono::milliseconds connect_timeout,
+                     const SocketOptions& options)
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Recommended value of "Connection Attempt Delay" from RFC 8305.
+    static const std::chrono::milliseconds kAttemptDelay(250);
+
+    // Interleave address families, keeping the family of the first
+    // (most preferred) address in front.
+    std::vector<const struct addrinfo*> candidates;
+    {
+        std::vector<const struct addrinfo*> preferred;
+        std::vector<const struct addrinfo*> others;
+
+        for (auto res = addr.Info(); res != nullptr; res = res->ai_next) {
+            if (res->ai_family == addr.Info()->ai_family) {
+                preferred.push_back(res);
+            } else {
+                others.push_back(res);
+            }
+        }
+        for (size_t i = 0; i < std::max(preferred.size(), others.size()); ++i) {
+            if (i < preferred.size()) {
+                candidates.push_back(preferred[i]);
+            }
+            if (i < others.size()) {
+                candidates.push_back(others[i]);
+            }
+        }
+    }
+
+    const auto deadline = Clock::now() + connect_timeout;
+    auto next_attempt = Clock::now();
+    size_t next_candidate = 0;
     int last_err = 0;
-    for (auto res = addr.Info(); res != nullptr; res = res->ai_next) {
-        SOCKET s(socket(res->ai_family, res->ai_socktype, res->ai_protocol));
 
-        if (s == -1) {
-            continue;
+    std::vector<SocketHolder> pending;
+    std::vector<pollfd> fds;
+
+    while (true) {
+        auto now = Clock::now();
+
+        // Start the next attempt when the previous ones have failed or
+        // have not succeeded within the attempt delay.
+        while (next_candidate < candidates.size() && (pending.empty() || now >= next_attempt)) {
+            const struct addrinfo* res = candidates[next_candidate++];
+            SocketHolder s(socket(res->ai_family, res->ai_socktype, res->ai_protocol));
+
+            if (s.Closed()) {
+                last_err = errno;
+                continue;
+            }
+
+            SetNonBlock(s, true);
+            if (socket_timeout_params) {
+                SetTimeout(s, *socket_timeout_params);
+            }
+            s.SetTcpNoDelay(options.tcp_nodelay);
+            if (options.recv_buffer_size > 0 || options.send_buffer_size > 0) {
+                s.SetBufferSizes(options.recv_buffer_size, options.send_buffer_size);
+            }
+
+            if (connect(s, res->ai_addr, (int)res->ai_addrlen) == 0) {
+                SetNonBlock(s, false);
+                return s.Release();
+            }
+
+            const int err = errno;
+            if (err == EINPROGRESS || err == EAGAIN || err == EWOULDBLOCK) {
+                pending.push_back(std::move(s));
+                next_attempt = now + kAttemptDelay;
+                break;
+            }
+
+            // Immediate failure, so the next candidate is tried right away.
+            last_err = err;
+            next_attempt = now;
         }
 
-        SetNonBlock(s, true);
-        if(socket_timeout_params) {
-            SetTimeout(s, *socket_timeout_params);
+        if (pending.empty()) {
+            break;
+        }
+        if (now >= deadline) {
+            last_err = ETIMEDOUT;
+            break;
         }
 
-        if (connect(s, res->ai_addr, (int)res->ai_addrlen) != 0) {
-            int err = errno;
-            if (err == EINPROGRESS || err == EAGAIN || err == EWOULDBLOCK) {
-                pollfd fd;
-                fd.fd = s;
-                fd.events = POLLOUT;
-                fd.revents = 0;
-                ssize_t rval = Poll(&fd, 1, 5000);
-
-                if (rval == -1) {
-                    throw std::system_error(errno, std::system_category(), "fail to connect");
-                }
-                if (rval > 0) {
-                    socklen_t len = sizeof(err);
-                    getsockopt(s, SOL_SOCKET, SO_ERROR, (char*)&err, &len);
-
-                    if (!err) {
-                        SetNonBlock(s, false);
-                        return s;
-                    }
-                   last_err = err;
-                }
+        auto wait_until = deadline;
+        if (next_candidate < candidates.size()) {
+            wait_until = std::min(wait_until, next_attempt);
+        }
+        const int timeout = (int)std::chrono::duration_cast<std::chrono::milliseconds>(
+            wait_until - now + std::chrono::microseconds(999)).count();
+
+        fds.resize(pending.size());
+        for (size_t i = 0; i < pending.size(); ++i) {
+            fds[i].fd = pending[i];
+            fds[i].events = POLLOUT;
+            fds[i].revents = 0;
+        }
+
+        const ssize_t rval = Poll(fds.data(), (int)fds.size(), timeout);
+
+        if (rval == -1) {
+            if (errno == EINTR) {
+                continue;
             }
-        } else {
-            SetNonBlock(s, false);
-            return s;
+            throw std::system_error(errno, std::system_category(), "fail to connect");
+        }
+
+        // Collect results of completed attempts, going backwards to keep
+        // indices of fds and pending in sync while erasing.
+        for (size_t i = fds.size(); rval > 0 && i-- > 0; ) {
+            if (fds[i].revents == 0) {
+                continue;
+            }
+
+            int err = 0;
+            socklen_t len = sizeof(err);
+            getsockopt(pending[i], SOL_SOCKET, SO_ERROR, (char*)&err, &len);
+
+            if (!err) {
+                SetNonBlock(pending[i], false);
+                return pending[i].Release();
+            }
+
+            last_err = err;
+            next_attempt = Clock::now();
+            pending.erase(pending.begin() + i);
         }
     }
+
     if (last_err > 0) {
         throw std::system_error(last_err, std::system_category(), "fail to connect");
     }
@@ -331,6 +597,14 @@ SOCKET SocketConnect(const NetworkAddress& addr, const std::optional<SocketTimeo
 }
 
 
+void SocketShutdown(SOCKET s) noexcept {
+#if defined(_win_)
+    shutdown(s, SD_BOTH);
+#else
+    shutdown(s, SHUT_RDWR);
+#endif
+}
+
 ssize_t Poll(struct pollfd* fds, int nfds, int timeout) noexcept {
 #if defined(_win_)
     int rval = WSAPoll(fds, nfds, timeout);
@@ -4,7 +4,9 @@
 #include "output.h"
 #include "platform.h"
 
+#include <chrono>
 #include <cstddef>
+#include <memory>
 #include <string>
 #include <optional>
 
@@ -34,14 +36,17 @@ namespace clickhouse {
  */
 class NetworkAddress {
 public:
+    /// @params cache_ttl how long the resolved addresses of the host are
+    ///         kept in the process-wide cache.  Zero disables caching.
     explicit NetworkAddress(const std::string& host,
-                            const std::string& port = "0");
+                            const std::string& port = "0",
+                            std::chrono::seconds cache_ttl = std::chrono::seconds(0));
     ~NetworkAddress();
 
     const struct addrinfo* Info() const;
 
 private:
-    struct addrinfo* info_;
+    std::shared_ptr<const struct addrinfo> info_;
 };
 
 class SocketTimeoutParams {
@@ -57,6 +62,19 @@ private:
 };
 
 
+/// Options applied to a socket before it connects.  Buffer sizes must be
+/// set before the handshake, since the TCP window scale is negotiated
+/// from the receive buffer size then.
+struct SocketOptions {
+    /// Disable Nagle's algorithm.
+    bool tcp_nodelay = false;
+    /// Sizes of the kernel receive and send buffers, zero keeps the
+    /// system default.
+    int recv_buffer_size = 0;
+    int send_buffer_size = 0;
+};
+
+
 class SocketHolder {
 public:
     SocketHolder();
@@ -69,6 +87,9 @@ public:
 
     bool Closed() const noexcept;
 
+    /// Releases ownership of the handle without closing it.
+    SOCKET Release() noexcept;
+
     /// @params idle the time (in seconds) the connection needs to remain
     ///         idle before TCP starts sending keepalive probes.
     /// @params intvl the time (in seconds) between individual keepalive probes.
@@ -76,6 +97,24 @@ public:
     ///         before dropping the connection.
     void SetTcpKeepAlive(int idle, int intvl, int cnt) noexcept;
 
+    /// @params nodelay disable Nagle's algorithm, so small packets are sent
+    ///         without waiting for the acknowledgement of previous ones.
+    void SetTcpNoDelay(bool nodelay) noexcept;
+
+    /// @params recv_size size (in bytes) of the kernel receive buffer.
+    /// @params send_size size (in bytes) of the kernel send buffer.
+    /// Zero keeps the system default for the corresponding buffer.
+    void SetBufferSizes(int recv_size, int send_size) noexcept;
+
+    /// @params usec the time (in microseconds) to busy poll the device queue
+    ///         on a blocking receive when there is no data (Linux only).
+    void SetBusyPoll(int usec) noexcept;
+
+    /// @params quickack send ACKs immediately rather than delay them
+    ///         (Linux only). The kernel may leave the quick ACK mode on its
+    ///         own, so SocketInput re-arms the option after every receive.
+    void SetTcpQuickAck(bool quickack) noexcept;
+
     SocketHolder& operator = (SocketHolder&& other) noexcept;
 
     operator SOCKET () const noexcept;
@@ -93,7 +132,7 @@ private:
  */
 class SocketInput : public InputStream {
 public:
-    explicit SocketInput(SOCKET s);
+    explicit SocketInput(SOCKET s, bool quickack = false);
     ~SocketInput();
 
 protected:
@@ -101,6 +140,8 @@ protected:
 
 private:
     SOCKET s_;
+    /// Re-arm TCP_QUICKACK after each receive.
+    bool quickack_;
 };
 
 class SocketOutput : public OutputStream {
@@ -119,8 +160,22 @@ static struct NetworkInitializer {
     NetworkInitializer();
 } gNetworkInitializer;
 
+/// Connects to one of the addresses of \p addr.
 ///
-SOCKET SocketConnect(const NetworkAddress& addr, const std::optional<SocketTimeoutParams>& socket_timeout_params);
+/// Candidates are raced in the Happy Eyeballs (RFC 8305) manner: address
+/// families are interleaved and a new attempt starts every 250ms or as soon
+/// as the previous one fails, while earlier attempts are still pending.
+/// The first established connection wins.  \p connect_timeout limits
+/// the whole procedure.  \p options are applied to every attempted
+/// socket before connect().
+SOCKET SocketConnect(const NetworkAddress& addr,
+                     const std::optional<SocketTimeoutParams>& socket_timeout_params = std::nullopt,
+                     std::chrono::milliseconds connect_timeout = std::chrono::milliseconds(5000),
+                     const SocketOptions& options = SocketOptions());
+
+/// Shuts down both directions of the socket, so blocked operations on it
+/// return.  The socket stays open.
+void SocketShutdown(SOCKET s) noexcept;
 
 ssize_t Poll(struct pollfd* fds, int nfds, int timeout) noexcept;
 
@@ -0,0 +1,466 @@
+#include "timezone.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+
+namespace clickhouse {
+namespace {
+
+constexpr int64_t kNanosPerSecond = 1000000000;
+
+/// Last year for which transitions of the POSIX rule are precomputed.
+constexpr int64_t kLastRuleYear = 2299;
+
+/// Days since 1970-01-01 of given date of the proleptic Gregorian calendar.
+int64_t DaysFromCivil(int64_t y, int64_t m, int64_t d) {
+    y -= m <= 2;
+    const int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const int64_t yoe = y - era * 400;
+    const int64_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+bool IsLeapYear(int64_t y) {
+    return (y % 4 == 0 && y % 100 != 0) || y % 400 == 0;
+}
+
+int64_t FloorDiv(int64_t a, int64_t b) {
+    return a / b - (a % b != 0 && (a < 0) != (b < 0));
+}
+
+/// Returns value + offset saturated to the range of int64_t.
+int64_t AddSaturate(int64_t value, int64_t offset) {
+    if (offset > 0 && value > std::numeric_limits<int64_t>::max() - offset) {
+        return std::numeric_limits<int64_t>::max();
+    }
+    if (offset < 0 && value < std::numeric_limits<int64_t>::min() - offset) {
+        return std::numeric_limits<int64_t>::min();
+    }
+    return value + offset;
+}
+
+/// Reads big-endian fields of a TZif file.
+class TZifReader {
+public:
+    explicit TZifReader(std::string_view data)
+        : data_(data)
+    { }
+
+    void Skip(size_t n) {
+        Need(n);
+        pos_ += n;
+    }
+
+    uint8_t Byte() {
+        Need(1);
+        return static_cast<uint8_t>(data_[pos_++]);
+    }
+
+    int64_t Int(size_t width) {
+        Need(width);
+        uint64_t value = 0;
+        for (size_t i = 0; i < width; ++i) {
+            value = (value << 8) | static_cast<uint8_t>(data_[pos_++]);
+        }
+        if (width < 8 && (value >> (width * 8 - 1))) {
+            value |= ~uint64_t(0) << (width * 8);
+        }
+        return static_cast<int64_t>(value);
+    }
+
+    std::string_view Rest() const {
+        return data_.substr(pos_);
+    }
+
+private:
+    void Need(size_t n) const {
+        if (data_.size() - pos_ < n) {
+            throw std::runtime_error("truncated TZif data");
+        }
+    }
+
+private:
+    std::string_view data_;
+    size_t pos_ = 0;
+};
+
+struct TZifHeader {
+    char version;
+    size_t isutcnt;
+    size_t isstdcnt;
+    size_t leapcnt;
+    size_t timecnt;
+    size_t typecnt;
+    size_t charcnt;
+};
+
+TZifHeader ReadHeader(TZifReader& reader) {
+    if (reader.Byte() != 'T' || reader.Byte() != 'Z' || reader.Byte() != 'i' || reader.Byte() != 'f') {
+        throw std::runtime_error("invalid TZif magic");
+    }
+
+    TZifHeader header;
+    header.version = static_cast<char>(reader.Byte());
+    reader.Skip(15);
+    header.isutcnt = static_cast<size_t>(reader.Int(4));
+    header.isstdcnt = static_cast<size_t>(reader.Int(4));
+    header.leapcnt = static_cast<size_t>(reader.Int(4));
+    header.timecnt = static_cast<size_t>(reader.Int(4));
+    header.typecnt = static_cast<size_t>(reader.Int(4));
+    header.charcnt = static_cast<size_t>(reader.Int(4));
+    if (header.typecnt == 0) {
+        throw std::runtime_error("TZif data has no local time types");
+    }
+    return header;
+}
+
+/// Parses fields of a POSIX TZ string, e.g. "CET-1CEST,M3.5.0,M10.5.0/3".
+class RuleParser {
+public:
+    explicit RuleParser(std::string_view rule)
+        : rule_(rule)
+    { }
+
+    bool AtEnd() const {
+        return pos_ == rule_.size();
+    }
+
+    bool Consume(char c) {
+        if (pos_ < rule_.size() && rule_[pos_] == c) {
+            ++pos_;
+            return true;
+        }
+        return false;
+    }
+
+    bool Peek(char c) const {
+        return pos_ < rule_.size() && rule_[pos_] == c;
+    }
+
+    bool PeekSign() const {
+        return Peek('+') || Peek('-') || (pos_ < rule_.size() && IsDigit(rule_[pos_]));
+    }
+
+    void Name() {
+        if (Consume('<')) {
+            while (pos_ < rule_.size() && rule_[pos_] != '>') {
+                ++pos_;
+            }
+            Expect('>');
+        } else {
+            const size_t begin = pos_;
+            while (pos_ < rule_.size() && IsAlpha(rule_[pos_])) {
+                ++pos_;
+            }
+            if (pos_ == begin) {
+                Fail();
+            }
+        }
+    }
+
+    /// Returns [+-]hh[:mm[:ss]] in seconds.
+    int64_t Time() {
+        int64_t sign = 1;
+        if (Consume('-')) {
+            sign = -1;
+        } else {
+            Consume('+');
+        }
+
+        int64_t seconds = Number() * 3600;
+        if (Consume(':')) {
+            seconds += Number() * 60;
+            if (Consume(':')) {
+                seconds += Number();
+            }
+        }
+        return sign * seconds;
+    }
+
+    int64_t Number() {
+        const size_t begin = pos_;
+        int64_t value = 0;
+        while (pos_ < rule_.size() && IsDigit(rule_[pos_])) {
+            value = value * 10 + (rule_[pos_++] - '0');
+        }
+        if (pos_ == begin) {
+            Fail();
+        }
+        return value;
+    }
+
+    void Expect(char c) {
+        if (!Consume(c)) {
+            Fail();
+        }
+    }
+
+    [[noreturn]] void Fail() const {
+        throw std::runtime_error("invalid TZ rule: '" + std::string(rule_) + "'");
+    }
+
+private:
+    static bool IsDigit(char c) {
+        return c >= '0' && c <= '9';
+    }
+
+    static bool IsAlpha(char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+    }
+
+private:
+    std::string_view rule_;
+    size_t pos_ = 0;
+};
+
+/// Date part of a rule: Jn, n or Mm.w.d, with time of day.
+struct RuleDate {
+    char kind;
+    int64_t month;
+    int64_t week;
+    int64_t day;
+    int64_t time;
+
+    static RuleDate Parse(RuleParser& parser) {
+        RuleDate date{};
+        if (parser.Consume('M')) {
+            date.kind = 'M';
+            date.month = parser.Number();
+            parser.Expect('.');
+            date.week = parser.Number();
+            parser.Expect('.');
+            date.day = parser.Number();
+            if (date.month < 1 || date.month > 12 || date.week < 1 || date.week > 5 || date.day > 6) {
+                parser.Fail();
+            }
+        } else if (parser.Consume('J')) {
+            date.kind = 'J';
+            date.day = parser.Number();
+        } else {
+            date.kind = 'n';
+            date.day = parser.Number();
+        }
+
+        date.time = 2 * 3600;
+        if (parser.Consume('/')) {
+            date.time = parser.Time();
+        }
+        return date;
+    }
+
+    /// Returns local time of the date in given year, in seconds since epoch.
+    int64_t LocalTime(int64_t year) const {
+        int64_t days;
+        if (kind == 'M') {
+            const int64_t first = DaysFromCivil(year, month, 1);
+            const int64_t next = month == 12 ? DaysFromCivil(year + 1, 1, 1) : DaysFromCivil(year, month + 1, 1);
+            // 1970-01-01 is Thursday.
+            const int64_t weekday = ((first + 4) % 7 + 7) % 7;
+            days = first + (day - weekday + 7) % 7 + (week - 1) * 7;
+            while (days >= next) {
+                days -= 7;
+            }
+        } else if (kind == 'J') {
+            days = DaysFromCivil(year, 1, 1) + day - 1 + (IsLeapYear(year) && day >= 60);
+        } else {
+            days = DaysFromCivil(year, 1, 1) + day;
+        }
+        return days * 86400 + time;
+    }
+};
+
+}
+
+TimeZone::TimeZone(std::string name, int32_t offset)
+    : name_(std::move(name))
+    , offsets_(1, offset)
+{
+}
+
+std::shared_ptr<const TimeZone> TimeZone::Load(const std::string& name) {
+    static std::mutex mutex;
+    static std::map<std::string, std::shared_ptr<const TimeZone>> cache;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = cache.find(name);
+        if (it != cache.end()) {
+            return it->second;
+        }
+    }
+
+    std::shared_ptr<const TimeZone> zone;
+    if (name == "UTC") {
+        zone = Fixed(name, 0);
+    } else {
+        if (name.empty() || name[0] == '/' || name.find("..") != std::string::npos) {
+            throw std::runtime_error("invalid timezone name: '" + name + "'");
+        }
+
+        const char* dir = std::getenv("TZDIR");
+        std::ifstream file(std::string(dir && *dir ? dir : "/usr/share/zoneinfo") + "/" + name, std::ios::binary);
+        if (!file) {
+            throw std::runtime_error("can't load timezone '" + name + "'");
+        }
+
+        std::stringstream data;
+        data << file.rdbuf();
+        zone = FromTZif(name, data.str());
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    return cache.emplace(name, zone).first->second;
+}
+
+std::shared_ptr<const TimeZone> TimeZone::FromTZif(std::string name, std::string_view data) {
+    TZifReader reader(data);
+    TZifHeader header = ReadHeader(reader);
+    size_t time_width = 4;
+
+    if (header.version >= '2') {
+        // Skip the 32-bit block, the 64-bit one follows with its own header.
+        reader.Skip(header.timecnt * 5 + header.typecnt * 6 + header.charcnt +
+                    header.leapcnt * 8 + header.isstdcnt + header.isutcnt);
+        header = ReadHeader(reader);
+        time_width = 8;
+    }
+
+    std::vector<int64_t> times(header.timecnt);
+    for (auto& time : times) {
+        time = reader.Int(time_width);
+    }
+    std::vector<uint8_t> indices(header.timecnt);
+    for (auto& index : indices) {
+        index = reader.Byte();
+        if (index >= header.typecnt) {
+            throw std::runtime_error("invalid TZif local time type index");
+        }
+    }
+    std::vector<int32_t> type_offsets(header.typecnt);
+    for (auto& offset : type_offsets) {
+        offset = static_cast<int32_t>(reader.Int(4));
+        reader.Skip(2);
+    }
+    reader.Skip(header.charcnt + header.leapcnt * (time_width + 4) + header.isstdcnt + header.isutcnt);
+
+    std::shared_ptr<TimeZone> zone(new TimeZone(std::move(name), type_offsets[0]));
+    for (size_t i = 0; i < times.size(); ++i) {
+        if (!zone->transitions_.empty() && times[i] <= zone->transitions_.back()) {
+            throw std::runtime_error("TZif transitions are not sorted");
+        }
+        zone->transitions_.push_back(times[i]);
+        zone->offsets_.push_back(type_offsets[indices[i]]);
+    }
+
+    if (header.version >= '2') {
+        // Footer: "\n<POSIX TZ rule>\n".
+        std::string_view footer = reader.Rest();
+        if (footer.size() >= 2 && footer[0] == '\n') {
+            const size_t end = footer.find('\n', 1);
+            if (end != std::string_view::npos && end > 1) {
+                zone->ExpandRule(footer.substr(1, end - 1));
+            }
+        }
+    }
+
+    return zone;
+}
+
+std::shared_ptr<const TimeZone> TimeZone::Fixed(std::string name, int32_t offset) {
+    return std::shared_ptr<const TimeZone>(new TimeZone(std::move(name), offset));
+}
+
+void TimeZone::ExpandRule(std::string_view rule) {
+    RuleParser parser(rule);
+
+    parser.Name();
+    // POSIX offsets are positive west of Greenwich.
+    const int64_t std_offset = -parser.Time();
+    if (parser.AtEnd()) {
+        return;
+    }
+
+    parser.Name();
+    int64_t dst_offset = std_offset + 3600;
+    if (parser.PeekSign()) {
+        dst_offset = -parser.Time();
+    }
+    if (!parser.Consume(',')) {
+        // The rule names daylight time without dates of change, the
+        // table already holds everything known about the zone.
+        return;
+    }
+
+    const RuleDate start = RuleDate::Parse(parser);
+    parser.Expect(',');
+    const RuleDate end = RuleDate::Parse(parser);
+    if (!parser.AtEnd()) {
+        parser.Fail();
+    }
+
+    const int64_t last = transitions_.empty() ? std::numeric_limits<int64_t>::min() : transitions_.back();
+    const int64_t first_year = transitions_.empty() ? 1970 : 1970 + FloorDiv(last, 31556952) - 1;
+
+    for (int64_t year = first_year; year <= kLastRuleYear; ++year) {
+        // Start of daylight time is given in standard time and vice versa.
+        std::pair<int64_t, int64_t> changes[2] = {
+            {start.LocalTime(year) - std_offset, dst_offset},
+            {end.LocalTime(year) - dst_offset, std_offset},
+        };
+        if (changes[1].first < changes[0].first) {
+            std::swap(changes[0], changes[1]);
+        }
+
+        for (const auto& [time, offset] : changes) {
+            if (time > last && (transitions_.empty() || time > transitions_.back()) && offset != offsets_.back()) {
+                transitions_.push_back(time);
+                offsets_.push_back(static_cast<int32_t>(offset));
+            }
+        }
+    }
+}
+
+const std::string& TimeZone::Name() const {
+    return name_;
+}
+
+int32_t TimeZone::OffsetAt(int64_t unix_time) const {
+    const auto it = std::upper_bound(transitions_.begin(), transitions_.end(), unix_time);
+    return offsets_[it - transitions_.begin()];
+}
+
+void TimeZone::ToLocalNanos(int64_t* nanos, size_t count) const {
+    if (transitions_.empty()) {
+        const int64_t offset = offsets_[0] * kNanosPerSecond;
+        for (size_t i = 0; i < count; ++i) {
+            nanos[i] = AddSaturate(nanos[i], offset);
+        }
+        return;
+    }
+
+    // Timestamps are usually clustered, so the interval of the previous
+    // lookup is checked before searching the table.
+    int64_t interval_begin = std::numeric_limits<int64_t>::max();
+    int64_t interval_end = std::numeric_limits<int64_t>::min();
+    int64_t offset = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+        const int64_t seconds = FloorDiv(nanos[i], kNanosPerSecond);
+        if (seconds < interval_begin || seconds >= interval_end) {
+            const size_t n = std::upper_bound(transitions_.begin(), transitions_.end(), seconds) - transitions_.begin();
+            interval_begin = n ? transitions_[n - 1] : std::numeric_limits<int64_t>::min();
+            interval_end = n < transitions_.size() ? transitions_[n] : std::numeric_limits<int64_t>::max();
+            offset = offsets_[n] * kNanosPerSecond;
+        }
+        nanos[i] = AddSaturate(nanos[i], offset);
+    }
+}
+
+}
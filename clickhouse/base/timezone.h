@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace clickhouse {
+
+/**
+ * Timezone as a precomputed table of UTC offset transitions.
+ *
+ * The table is read from the system tz database (TZif files) and the
+ * trailing POSIX rule of the file is expanded up to year 2299, so
+ * lookups never evaluate calendar rules.
+ */
+class TimeZone {
+public:
+    /// Loads zone by name, e.g. "Europe/Moscow", from $TZDIR or
+    /// /usr/share/zoneinfo.  Throws std::runtime_error if the zone
+    /// can't be loaded.
+    static std::shared_ptr<const TimeZone> Load(const std::string& name);
+
+    /// Makes zone from content of a TZif file.
+    static std::shared_ptr<const TimeZone> FromTZif(std::string name, std::string_view data);
+
+    /// Makes zone with constant offset from UTC in seconds.
+    static std::shared_ptr<const TimeZone> Fixed(std::string name, int32_t offset);
+
+    const std::string& Name() const;
+
+    /// Returns offset from UTC in seconds at given UTC time.
+    int32_t OffsetAt(int64_t unix_time) const;
+
+    /// Converts UTC nanosecond timestamps to local wall clock time in place.
+    /// Results beyond the range of int64_t saturate.
+    void ToLocalNanos(int64_t* nanos, size_t count) const;
+
+private:
+    TimeZone(std::string name, int32_t offset);
+
+    /// Appends transitions of the POSIX TZ rule after the table.
+    void ExpandRule(std::string_view rule);
+
+private:
+    std::string name_;
+    /// UTC times, in seconds, at which the offset changes.
+    std::vector<int64_t> transitions_;
+    /// offsets_[0] is in effect before the first transition,
+    /// offsets_[i + 1] since transitions_[i].
+    std::vector<int32_t> offsets_;
+};
+
+}
@@ -0,0 +1,240 @@
+#pragma once
+
+#include "absl/numeric/int128.h"
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+namespace clickhouse {
+
+/**
+ * 256-bit integer in two's complement representation.
+ *
+ * Layout matches the native format: four 64-bit limbs, least significant
+ * first, so columns of the type are loaded and saved as raw memory.
+ * Arithmetic wraps modulo 2^256.
+ */
+template <bool Signed>
+class WideInteger256 {
+public:
+    constexpr WideInteger256() noexcept
+        : limbs_{0, 0, 0, 0}
+    { }
+
+    template <typename T, typename = std::enable_if_t<std::is_integral<T>::value>>
+    constexpr explicit WideInteger256(T value) noexcept
+        : limbs_{static_cast<uint64_t>(value), Extension(IsNegativeValue(value)), Extension(IsNegativeValue(value)), Extension(IsNegativeValue(value))}
+    { }
+
+    constexpr explicit WideInteger256(absl::uint128 value) noexcept
+        : limbs_{absl::Uint128Low64(value), absl::Uint128High64(value), 0, 0}
+    { }
+
+    constexpr explicit WideInteger256(absl::int128 value) noexcept
+        : limbs_{absl::Int128Low64(value), static_cast<uint64_t>(absl::Int128High64(value)), Extension(value < 0), Extension(value < 0)}
+    { }
+
+    template <bool S>
+    constexpr explicit WideInteger256(const WideInteger256<S>& other) noexcept
+        : limbs_{other.Limb(0), other.Limb(1), other.Limb(2), other.Limb(3)}
+    { }
+
+    /// Makes value from limbs, least significant first.
+    static constexpr WideInteger256 FromLimbs(uint64_t l0, uint64_t l1, uint64_t l2, uint64_t l3) noexcept {
+        WideInteger256 result;
+        result.limbs_[0] = l0;
+        result.limbs_[1] = l1;
+        result.limbs_[2] = l2;
+        result.limbs_[3] = l3;
+        return result;
+    }
+
+    /// Returns limb at given position, least significant first.
+    constexpr uint64_t Limb(size_t i) const noexcept {
+        return limbs_[i];
+    }
+
+    constexpr bool IsNegative() const noexcept {
+        return Signed && (limbs_[3] >> 63) != 0;
+    }
+
+    constexpr bool IsZero() const noexcept {
+        return (limbs_[0] | limbs_[1] | limbs_[2] | limbs_[3]) == 0;
+    }
+
+    /// Truncates value to the low 128 bits.
+    explicit operator absl::uint128() const noexcept {
+        return absl::MakeUint128(limbs_[1], limbs_[0]);
+    }
+
+    /// Truncates value to the low 128 bits.
+    explicit operator absl::int128() const noexcept {
+        return absl::MakeInt128(static_cast<int64_t>(limbs_[1]), limbs_[0]);
+    }
+
+    /// Truncates value to the low 64 bits.
+    template <typename T, typename = std::enable_if_t<std::is_integral<T>::value>>
+    explicit operator T() const noexcept {
+        return static_cast<T>(limbs_[0]);
+    }
+
+    WideInteger256 operator - () const noexcept {
+        return WideInteger256() - *this;
+    }
+
+    WideInteger256 operator ~ () const noexcept {
+        return FromLimbs(~limbs_[0], ~limbs_[1], ~limbs_[2], ~limbs_[3]);
+    }
+
+    friend WideInteger256 operator + (const WideInteger256& a, const WideInteger256& b) noexcept {
+        WideInteger256 result;
+        uint64_t carry = 0;
+        for (size_t i = 0; i < 4; ++i) {
+            const uint64_t sum = a.limbs_[i] + carry;
+            carry = sum < carry;
+            result.limbs_[i] = sum + b.limbs_[i];
+            carry += result.limbs_[i] < sum;
+        }
+        return result;
+    }
+
+    friend WideInteger256 operator - (const WideInteger256& a, const WideInteger256& b) noexcept {
+        WideInteger256 result;
+        uint64_t borrow = 0;
+        for (size_t i = 0; i < 4; ++i) {
+            const uint64_t diff = a.limbs_[i] - borrow;
+            borrow = a.limbs_[i] < borrow;
+            result.limbs_[i] = diff - b.limbs_[i];
+            borrow += diff < b.limbs_[i];
+        }
+        return result;
+    }
+
+    friend WideInteger256 operator * (const WideInteger256& a, const WideInteger256& b) noexcept {
+        WideInteger256 result;
+        for (size_t i = 0; i < 4; ++i) {
+            uint64_t carry = 0;
+            for (size_t j = 0; i + j < 4; ++j) {
+                const absl::uint128 product = absl::uint128(a.limbs_[i]) * b.limbs_[j] + result.limbs_[i + j] + carry;
+                result.limbs_[i + j] = absl::Uint128Low64(product);
+                carry = absl::Uint128High64(product);
+            }
+        }
+        return result;
+    }
+
+    WideInteger256& operator += (const WideInteger256& other) noexcept {
+        return *this = *this + other;
+    }
+
+    WideInteger256& operator -= (const WideInteger256& other) noexcept {
+        return *this = *this - other;
+    }
+
+    WideInteger256& operator *= (const WideInteger256& other) noexcept {
+        return *this = *this * other;
+    }
+
+    friend bool operator == (const WideInteger256& a, const WideInteger256& b) noexcept {
+        return a.limbs_[0] == b.limbs_[0] && a.limbs_[1] == b.limbs_[1] &&
+               a.limbs_[2] == b.limbs_[2] && a.limbs_[3] == b.limbs_[3];
+    }
+
+    friend bool operator != (const WideInteger256& a, const WideInteger256& b) noexcept {
+        return !(a == b);
+    }
+
+    friend bool operator < (const WideInteger256& a, const WideInteger256& b) noexcept {
+        if (a.IsNegative() != b.IsNegative()) {
+            return a.IsNegative();
+        }
+        for (size_t i = 4; i-- > 0; ) {
+            if (a.limbs_[i] != b.limbs_[i]) {
+                return a.limbs_[i] < b.limbs_[i];
+            }
+        }
+        return false;
+    }
+
+    friend bool operator > (const WideInteger256& a, const WideInteger256& b) noexcept {
+        return b < a;
+    }
+
+    friend bool operator <= (const WideInteger256& a, const WideInteger256& b) noexcept {
+        return !(b < a);
+    }
+
+    friend bool operator >= (const WideInteger256& a, const WideInteger256& b) noexcept {
+        return !(a < b);
+    }
+
+    /// Multiplies the value by mul and adds add, in place.
+    void MulAdd(uint64_t mul, uint64_t add) noexcept {
+        uint64_t carry = add;
+        for (size_t i = 0; i < 4; ++i) {
+            const absl::uint128 product = absl::uint128(limbs_[i]) * mul + carry;
+            limbs_[i] = absl::Uint128Low64(product);
+            carry = absl::Uint128High64(product);
+        }
+    }
+
+    /// Divides the value treated as unsigned by divisor in place,
+    /// returns the remainder.
+    uint64_t DivMod(uint64_t divisor) noexcept {
+        absl::uint128 remainder = 0;
+        for (size_t i = 4; i-- > 0; ) {
+            const absl::uint128 current = (remainder << 64) | limbs_[i];
+            limbs_[i] = absl::Uint128Low64(current / divisor);
+            remainder = current % divisor;
+        }
+        return absl::Uint128Low64(remainder);
+    }
+
+    /// Returns decimal representation of the value.
+    std::string ToString() const {
+        constexpr uint64_t kChunk = 10000000000000000000ull; // 10^19
+        WideInteger256<false> magnitude(IsNegative() ? -*this : *this);
+        char buffer[80];
+        char* end = buffer + sizeof(buffer);
+        char* p = end;
+
+        do {
+            uint64_t chunk = magnitude.DivMod(kChunk);
+            const bool last = magnitude.IsZero();
+            for (size_t i = 0; i < 19 && (!last || chunk != 0 || p == end); ++i) {
+                *--p = static_cast<char>('0' + chunk % 10);
+                chunk /= 10;
+            }
+        } while (!magnitude.IsZero());
+
+        if (IsNegative()) {
+            *--p = '-';
+        }
+        return std::string(p, end);
+    }
+
+private:
+    template <typename T>
+    static constexpr bool IsNegativeValue(T value) noexcept {
+        if constexpr (std::is_signed<T>::value) {
+            return value < 0;
+        } else {
+            return false;
+        }
+    }
+
+    static constexpr uint64_t Extension(bool negative) noexcept {
+        return negative ? ~uint64_t(0) : 0;
+    }
+
+private:
+    uint64_t limbs_[4];
+};
+
+using Int256 = WideInteger256<true>;
+using UInt256 = WideInteger256<false>;
+
+static_assert(sizeof(Int256) == 32, "Int256 must be 32 bytes long");
+
+}
@@ -1,5 +1,9 @@
 #include "block.h"
+#include "columns/hash.h"
+#include "columns/utils.h"
 
+#include <algorithm>
+#include <limits>
 #include <stdexcept>
 
 namespace clickhouse {
@@ -32,12 +36,26 @@ bool Block::Iterator::IsValid() const {
 
 
 Block::Block()
-    : rows_(0)
+    : Block(std::pmr::get_default_resource())
 {
 }
 
 Block::Block(size_t cols, size_t rows)
-    : rows_(rows)
+    : Block(cols, rows, std::pmr::get_default_resource())
+{
+}
+
+Block::Block(std::pmr::memory_resource* resource)
+    : resource_(resource)
+    , columns_(resource)
+    , rows_(0)
+{
+}
+
+Block::Block(size_t cols, size_t rows, std::pmr::memory_resource* resource)
+    : resource_(resource)
+    , columns_(resource)
+    , rows_(rows)
 {
     columns_.reserve(cols);
 }
@@ -51,7 +69,168 @@ void Block::AppendColumn(const std::string& name, const ColumnRef& col) {
         throw std::runtime_error("all columns in block must have same count of rows. Name: ["+name+"], rows: ["+std::to_string(rows_)+"], columns: [" + std::to_string(col->Size())+"]");
     }
 
-    columns_.push_back(ColumnItem{name, col});
+    columns_.push_back(ColumnItem{name, col, std::nullopt});
+}
+
+void Block::Append(const Block& block) {
+    if (&block == this) {
+        // Columns can't append themselves.
+        Append(Slice(0, rows_));
+        return;
+    }
+
+    if (columns_.empty()) {
+        info_ = block.info_;
+        for (const auto& item : block.columns_) {
+            AppendColumn(item.name, item.column->Slice(0, item.column->Size()));
+        }
+        return;
+    }
+
+    CheckSameSchema(block);
+
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        auto& column = columns_[i].column;
+        // Columns shared with copies of the block are copied on write, so
+        // the copies keep their rows.
+        if (column.use_count() > 1) {
+            column = column->Slice(0, column->Size());
+        }
+        column->Append(block.columns_[i].column);
+        columns_[i].stats.reset();
+    }
+    RefreshRowCount();
+}
+
+Block Block::Slice(size_t begin, size_t len) const {
+    if (begin > rows_ || len > rows_ - begin) {
+        throw std::out_of_range("slice is out of range of the block. Begin: ["+std::to_string(begin)+"], length: ["+std::to_string(len)+"], rows: [" + std::to_string(rows_)+"]");
+    }
+
+    Block result(columns_.size(), len, resource_);
+    result.info_ = info_;
+    for (const auto& item : columns_) {
+        result.AppendColumn(item.name, item.column->Slice(begin, len));
+    }
+    return result;
+}
+
+Block Block::Filter(const uint8_t* mask) const {
+    Block result(columns_.size(), CountNonZero(mask, rows_), resource_);
+    result.info_ = info_;
+    for (const auto& item : columns_) {
+        result.AppendColumn(item.name, item.column->Filter(mask));
+    }
+    return result;
+}
+
+Block Block::Take(const uint32_t* indices, size_t count) const {
+    Block result(columns_.size(), count, resource_);
+    result.info_ = info_;
+    for (const auto& item : columns_) {
+        result.AppendColumn(item.name, item.column->Take(indices, count));
+    }
+    return result;
+}
+
+std::vector<Block> Block::PartitionByHash(size_t key_column, size_t count) const {
+    if (count == 0) {
+        throw std::invalid_argument("count of partitions must be positive");
+    }
+    if (rows_ > std::numeric_limits<uint32_t>::max()) {
+        throw std::runtime_error("too many rows in the block to partition: " + std::to_string(rows_));
+    }
+
+    std::vector<uint64_t> hashes(rows_);
+    HashColumn((*this)[key_column], hashes.data());
+
+    // Positions of rows grouped by partition, in order within each group.
+    std::vector<size_t> bounds(count + 1);
+    for (auto& hash : hashes) {
+        hash %= count;
+        ++bounds[hash + 1];
+    }
+    for (size_t i = 1; i <= count; ++i) {
+        bounds[i] += bounds[i - 1];
+    }
+    std::vector<uint32_t> indices(rows_);
+    std::vector<size_t> next(bounds.begin(), bounds.end() - 1);
+    for (size_t i = 0; i < rows_; ++i) {
+        indices[next[hashes[i]]++] = static_cast<uint32_t>(i);
+    }
+
+    std::vector<Block> result;
+    result.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        result.push_back(Take(indices.data() + bounds[i], bounds[i + 1] - bounds[i]));
+    }
+    return result;
+}
+
+std::vector<Block> Block::SplitByRows(size_t rows) const {
+    if (rows == 0) {
+        throw std::invalid_argument("count of rows in a block must be positive");
+    }
+
+    std::vector<Block> result;
+    result.reserve((rows_ + rows - 1) / rows);
+    for (size_t begin = 0; begin < rows_; begin += rows) {
+        result.push_back(Slice(begin, std::min(rows, rows_ - begin)));
+    }
+    return result;
+}
+
+std::vector<Block> Block::SplitByBytes(size_t bytes) const {
+    const size_t total = MemoryUsage();
+    if (rows_ == 0 || total == 0) {
+        return SplitByRows(std::max<size_t>(rows_, 1));
+    }
+
+    const double row_size = static_cast<double>(total) / rows_;
+    return SplitByRows(std::max<size_t>(1, static_cast<size_t>(bytes / row_size)));
+}
+
+Block Block::Concat(const std::vector<Block>& blocks) {
+    if (blocks.empty()) {
+        return Block();
+    }
+
+    const Block& first = blocks.front();
+    size_t rows = 0;
+    for (const auto& block : blocks) {
+        first.CheckSameSchema(block);
+        rows += block.rows_;
+    }
+
+    Block result(first.columns_.size(), 0, first.resource_);
+    result.info_ = first.info_;
+    for (const auto& item : first.columns_) {
+        auto column = item.column->Slice(0, 0);
+        column->Reserve(rows);
+        result.AppendColumn(item.name, column);
+    }
+    for (const auto& block : blocks) {
+        for (size_t i = 0; i < result.columns_.size(); ++i) {
+            result.columns_[i].column->Append(block.columns_[i].column);
+        }
+    }
+    result.RefreshRowCount();
+    return result;
+}
+
+void Block::CheckSameSchema(const Block& block) const {
+    if (block.columns_.size() != columns_.size()) {
+        throw std::runtime_error("blocks have different count of columns: ["+std::to_string(columns_.size())+"] and ["+std::to_string(block.columns_.size())+"]");
+    }
+
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        const auto& lhs = columns_[i];
+        const auto& rhs = block.columns_[i];
+
+        if (lhs.name != rhs.name || !lhs.column->Type()->IsEqual(rhs.column->Type())) {
+            throw std::runtime_error("blocks have different columns: ["+lhs.name+" "+lhs.column->Type()->GetName()+"] and ["+rhs.name+" "+rhs.column->Type()->GetName()+"]");
+        }
+    }
 }
 
 /// Count of columns in the block.
@@ -68,6 +247,30 @@ size_t Block::GetRowCount() const {
     return rows_;
 }
 
+void Block::RefreshRowCount() {
+    size_t rows = columns_.empty() ? 0 : columns_.front().column->Size();
+
+    for (const auto& item : columns_) {
+        if (item.column->Size() != rows) {
+            throw std::runtime_error("all columns in block must have same count of rows. Name: ["+item.name+"], rows: ["+std::to_string(rows)+"], columns: [" + std::to_string(item.column->Size())+"]");
+        }
+    }
+
+    rows_ = rows;
+}
+
+size_t Block::MemoryUsage() const {
+    size_t result = 0;
+    for (const auto& item : columns_) {
+        result += item.column->MemoryUsage();
+    }
+    return result;
+}
+
+std::pmr::memory_resource* Block::GetMemoryResource() const {
+    return resource_;
+}
+
 ColumnRef Block::operator [] (size_t idx) const {
     if (idx < columns_.size()) {
         return columns_[idx].column;
@@ -76,4 +279,13 @@ ColumnRef Block::operator [] (size_t idx) const {
     throw std::out_of_range("column index is out of range. Index: ["+std::to_string(idx)+"], columns: [" + std::to_string(columns_.size())+"]");
 }
 
+const ColumnStats* Block::GetColumnStats(size_t idx) const {
+    const auto& stats = columns_.at(idx).stats;
+    return stats ? &*stats : nullptr;
+}
+
+void Block::SetColumnStats(size_t idx, ColumnStats stats) {
+    columns_.at(idx).stats = std::move(stats);
+}
+
 }
@@ -1,6 +1,10 @@
 #pragma once
 
 #include "columns/column.h"
+#include "columns/stats.h"
+
+#include <optional>
+#include <vector>
 
 namespace clickhouse {
 
@@ -41,11 +45,51 @@ public:
 public:
      Block();
      Block(size_t cols, size_t rows);
+    /// Storage of the block is allocated from the resource, which must
+    /// outlive the block.  Columns are usually made from the same one.
+    explicit Block(std::pmr::memory_resource* resource);
+     Block(size_t cols, size_t rows, std::pmr::memory_resource* resource);
     ~Block();
 
     /// Append named column to the block.
     void AppendColumn(const std::string& name, const ColumnRef& col);
 
+    /// Appends rows of the block with the same names and types of columns.
+    /// A block without columns takes copies of the columns of the other one.
+    /// Columns referenced from elsewhere (e.g. by copies of the block) are
+    /// copied before appending, so those references don't see new rows.
+    /// Throws std::runtime_error if schemas of the blocks differ.
+    void Append(const Block& block);
+
+    /// Makes block of rows [begin, begin + len).
+    Block Slice(size_t begin, size_t len) const;
+
+    /// Makes block of the rows for which mask has nonzero bytes.
+    /// The mask holds one byte per row.
+    Block Filter(const uint8_t* mask) const;
+
+    /// Makes block of the rows at given positions, in that order.
+    Block Take(const uint32_t* indices, size_t count) const;
+
+    /// Splits rows of the block into given count of blocks by the hash of
+    /// the key column: a row goes to block cityHash64(key) % count, the
+    /// same way a Distributed table with the sharding key cityHash64(key)
+    /// routes it to shards of equal weight.  Blocks keep order of rows.
+    /// See HashColumn() for supported types of the key.
+    std::vector<Block> PartitionByHash(size_t key_column, size_t count) const;
+
+    /// Splits the block into blocks of at most given count of rows.
+    std::vector<Block> SplitByRows(size_t rows) const;
+
+    /// Splits the block into blocks of about given size in bytes.  Size of
+    /// a row is estimated from memory usage of the columns, each block has
+    /// at least one row.
+    std::vector<Block> SplitByBytes(size_t bytes) const;
+
+    /// Concatenates blocks with the same schema, allocating memory for the
+    /// result at once.
+    static Block Concat(const std::vector<Block>& blocks);
+
     /// Count of columns in the block.
     size_t GetColumnCount() const;
 
@@ -54,6 +98,16 @@ public:
     /// Count of rows in the block.
     size_t GetRowCount() const;
 
+    /// Updates count of rows after the columns were modified in place.
+    /// Throws std::runtime_error if the columns differ in size.
+    void RefreshRowCount();
+
+    /// Count of bytes of memory held by data of all columns.
+    size_t MemoryUsage() const;
+
+    /// Memory resource which provides storage of the block.
+    std::pmr::memory_resource* GetMemoryResource() const;
+
     const std::string& GetColumnName(size_t idx) const {
         return columns_.at(idx).name;
     }
@@ -61,14 +115,27 @@ public:
     /// Reference to column by index in the block.
     ColumnRef operator [] (size_t idx) const;
 
+    /// Statistics of the column computed when the block was received (see
+    /// ClientOptions::SetColumnStats) or set by SetColumnStats(), nullptr
+    /// if there are none.  Appending rows to the block drops them.
+    const ColumnStats* GetColumnStats(size_t idx) const;
+
+    /// Attaches statistics to the column.
+    void SetColumnStats(size_t idx, ColumnStats stats);
+
 private:
+    /// Throws if names or types of columns of the blocks differ.
+    void CheckSameSchema(const Block& block) const;
+
     struct ColumnItem {
         std::string name;
         ColumnRef   column;
+        std::optional<ColumnStats> stats;
     };
 
+    std::pmr::memory_resource* resource_;
     BlockInfo info_;
-    std::vector<ColumnItem> columns_;
+    std::pmr::vector<ColumnItem> columns_;
     /// Count of rows in the block.
     size_t rows_;
 };
@@ -0,0 +1,268 @@
+#pragma once
+
+#include "block.h"
+#include "columns/array.h"
+#include "columns/date.h"
+#include "columns/decimal.h"
+#include "columns/nullable.h"
+#include "columns/numeric.h"
+#include "columns/string.h"
+#include "columns/uuid.h"
+
+#include <array>
+#include <ctime>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace clickhouse {
+
+/// Column types for TypedBlockBuilder.  Each of them defines type of the
+/// values of the column, storage for the values being appended, and the
+/// way the storage becomes a column.
+namespace Schema {
+
+template <typename C, typename V>
+struct Simple {
+    using Value = V;
+    using Storage = std::shared_ptr<C>;
+
+    static Storage Create() {
+        return std::make_shared<C>();
+    }
+
+    static void Reserve(Storage& storage, size_t rows) {
+        storage->Reserve(rows);
+    }
+
+    static void Append(Storage& storage, const Value& value) {
+        storage->Append(value);
+    }
+
+    static ColumnRef Build(Storage& storage) {
+        return storage;
+    }
+
+    static TypeRef GetType() {
+        return Create()->Type();
+    }
+};
+
+struct Int8    : Simple<ColumnInt8, int8_t> {};
+struct Int16   : Simple<ColumnInt16, int16_t> {};
+struct Int32   : Simple<ColumnInt32, int32_t> {};
+struct Int64   : Simple<ColumnInt64, int64_t> {};
+struct UInt8   : Simple<ColumnUInt8, uint8_t> {};
+struct UInt16  : Simple<ColumnUInt16, uint16_t> {};
+struct UInt32  : Simple<ColumnUInt32, uint32_t> {};
+struct UInt64  : Simple<ColumnUInt64, uint64_t> {};
+struct Float32 : Simple<ColumnFloat32, float> {};
+struct Float64 : Simple<ColumnFloat64, double> {};
+struct String  : Simple<ColumnString, std::string> {};
+struct UUID    : Simple<ColumnUUID, clickhouse::UInt128> {};
+
+/// Values are seconds since epoch.
+struct Date     : Simple<ColumnDate, std::time_t> {};
+struct Date32   : Simple<ColumnDate32, std::time_t> {};
+struct DateTime : Simple<ColumnDateTime, std::time_t> {};
+
+template <size_t N>
+struct FixedString : Simple<ColumnFixedString, std::string> {
+    static std::shared_ptr<ColumnFixedString> Create() {
+        return std::make_shared<ColumnFixedString>(N);
+    }
+
+    static TypeRef GetType() {
+        return Type::CreateString(N);
+    }
+};
+
+/// Values are ticks of 10^-Precision seconds since epoch.
+template <size_t Precision>
+struct DateTime64 : Simple<ColumnDateTime64, uint64_t> {
+    static std::shared_ptr<ColumnDateTime64> Create() {
+        return std::make_shared<ColumnDateTime64>(Precision);
+    }
+
+    static TypeRef GetType() {
+        return Type::CreateDateTime64(Precision);
+    }
+};
+
+/// Values are unscaled, e.g. 12345 for 123.45 of scale 2.
+template <size_t Precision, size_t Scale>
+struct Decimal : Simple<ColumnDecimal, clickhouse::Int128> {
+    static_assert(Precision >= 1 && Precision <= 38, "precision of Decimal must be in [1, 38]");
+    static_assert(Scale <= Precision, "scale of Decimal must not exceed its precision");
+
+    static std::shared_ptr<ColumnDecimal> Create() {
+        return std::make_shared<ColumnDecimal>(Precision, Scale);
+    }
+
+    static TypeRef GetType() {
+        return Type::CreateDecimal(Precision, Scale);
+    }
+};
+
+/// Values are std::optional of the values of T.
+template <typename T>
+struct Nullable {
+    using Value = std::optional<typename T::Value>;
+
+    struct Storage {
+        typename T::Storage nested;
+        std::shared_ptr<ColumnUInt8> nulls;
+    };
+
+    static Storage Create() {
+        return Storage{T::Create(), std::make_shared<ColumnUInt8>()};
+    }
+
+    static void Reserve(Storage& storage, size_t rows) {
+        T::Reserve(storage.nested, rows);
+        storage.nulls->Reserve(rows);
+    }
+
+    static void Append(Storage& storage, const Value& value) {
+        if (value) {
+            T::Append(storage.nested, *value);
+            storage.nulls->Append(0);
+        } else {
+            T::Append(storage.nested, typename T::Value());
+            storage.nulls->Append(1);
+        }
+    }
+
+    static ColumnRef Build(Storage& storage) {
+        return std::make_shared<ColumnNullable>(T::Build(storage.nested), storage.nulls);
+    }
+
+    static TypeRef GetType() {
+        return Type::CreateNullable(T::GetType());
+    }
+};
+
+/// Values are std::vector of the values of T.
+template <typename T>
+struct Array {
+    using Value = std::vector<typename T::Value>;
+
+    struct Storage {
+        typename T::Storage items;
+        /// End offsets of the arrays.
+        std::vector<size_t> offsets;
+    };
+
+    static Storage Create() {
+        return Storage{T::Create(), {}};
+    }
+
+    static void Reserve(Storage& storage, size_t rows) {
+        storage.offsets.reserve(rows);
+    }
+
+    static void Append(Storage& storage, const Value& value) {
+        for (const auto& item : value) {
+            T::Append(storage.items, item);
+        }
+        storage.offsets.push_back((storage.offsets.empty() ? 0 : storage.offsets.back()) + value.size());
+    }
+
+    static ColumnRef Build(Storage& storage) {
+        auto array = std::make_shared<ColumnArray>(T::Build(storage.items));
+        array->Reserve(storage.offsets.size());
+        for (size_t offset : storage.offsets) {
+            array->OffsetsIncrease(offset);
+        }
+        return array;
+    }
+
+    static TypeRef GetType() {
+        return Type::CreateArray(T::GetType());
+    }
+};
+
+}
+
+/**
+ * Builds blocks row by row with the schema fixed at compile time, e.g.
+ *
+ *   TypedBlockBuilder<Schema::Int64, Schema::String, Schema::Nullable<Schema::Float64>>
+ *       builder({"id", "name", "score"});
+ *   builder.AddRow(1, "one", 0.5);
+ *   builder.AddRow(2, "two", std::nullopt);
+ *   client.Insert("test.scores", builder.Build());
+ *
+ * Values are appended straight to the columns of the concrete types, so
+ * values of a wrong type are rejected by the compiler.
+ */
+template <typename... Columns>
+class TypedBlockBuilder {
+    static_assert(sizeof...(Columns) > 0, "block must have at least one column");
+
+public:
+    /// @param reserve_rows count of rows to preallocate columns for,
+    ///        each time a new block is started.
+    explicit TypedBlockBuilder(std::array<std::string, sizeof...(Columns)> names, size_t reserve_rows = 0)
+        : names_(std::move(names))
+        , reserve_rows_(reserve_rows)
+    {
+        Reset();
+    }
+
+    /// Appends one row.
+    void AddRow(const typename Columns::Value&... values) {
+        AppendRow(std::index_sequence_for<Columns...>(), values...);
+        ++rows_;
+    }
+
+    /// Count of rows added since the last Build().
+    size_t GetRowCount() const {
+        return rows_;
+    }
+
+    /// Types of the columns.
+    static std::vector<TypeRef> GetTypes() {
+        return {Columns::GetType()...};
+    }
+
+    /// Returns block of the added rows and starts a new one.
+    Block Build() {
+        Block block(sizeof...(Columns), rows_);
+        AppendColumns(&block, std::index_sequence_for<Columns...>());
+        Reset();
+        return block;
+    }
+
+private:
+    template <size_t... I>
+    void AppendRow(std::index_sequence<I...>, const typename Columns::Value&... values) {
+        (Columns::Append(std::get<I>(storage_), values), ...);
+    }
+
+    template <size_t... I>
+    void AppendColumns(Block* block, std::index_sequence<I...>) {
+        (block->AppendColumn(names_[I], Columns::Build(std::get<I>(storage_))), ...);
+    }
+
+    void Reset() {
+        storage_ = std::make_tuple(Columns::Create()...);
+        rows_ = 0;
+
+        if (reserve_rows_) {
+            std::apply([this] (auto&... storage) {
+                (Columns::Reserve(storage, reserve_rows_), ...);
+            }, storage_);
+        }
+    }
+
+private:
+    const std::array<std::string, sizeof...(Columns)> names_;
+    const size_t reserve_rows_;
+    std::tuple<typename Columns::Storage...> storage_;
+    size_t rows_ = 0;
+};
+
+}
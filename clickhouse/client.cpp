@@ -7,12 +7,16 @@
 #include "base/wire_format.h"
 
 #include "columns/factory.h"
+#include "columns/stats.h"
 
 #include <cityhash/city.h>
 #include <lz4/lz4.h>
 
 #include <assert.h>
 #include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <random>
 #include <system_error>
 #include <thread>
 #include <vector>
@@ -21,7 +25,7 @@
 #define DBMS_NAME                                       "ClickHouse"
 #define DBMS_VERSION_MAJOR                              1
 #define DBMS_VERSION_MINOR                              1
-#define REVISION                                        54401
+#define REVISION                                        54405
 
 #define DBMS_MIN_REVISION_WITH_TEMPORARY_TABLES         50264
 #define DBMS_MIN_REVISION_WITH_BLOCK_INFO               51903
@@ -31,6 +35,7 @@
 #define DBMS_MIN_REVISION_WITH_TIME_ZONE_PARAMETER_IN_DATETIME_DATA_TYPE 54337
 #define DBMS_MIN_REVISION_WITH_SERVER_DISPLAY_NAME      54372
 #define DBMS_MIN_REVISION_WITH_VERSION_PATCH            54401
+#define DBMS_MIN_REVISION_WITH_LOW_CARDINALITY_TYPE     54405
 
 namespace clickhouse {
 
@@ -60,17 +65,66 @@ struct ServerInfo {
     uint64_t    revision;
 };
 
+/// Returns column of the values of a LowCardinality column, which is
+/// sent to servers without support of the type.
+static ColumnRef ToPlainColumn(const ColumnLowCardinality& column) {
+    const size_t rows = column.Size();
+    std::vector<uint32_t> positions(rows);
+    for (size_t i = 0; i < rows; ++i) {
+        positions[i] = static_cast<uint32_t>(column.GetIndex(i));
+    }
+
+    ColumnRef values = column.GetDictionary()->Take(positions.data(), rows);
+    if (!column.IsNullable()) {
+        return values;
+    }
+
+    auto nulls = std::make_shared<ColumnUInt8>();
+    nulls->Reserve(rows);
+    for (size_t i = 0; i < rows; ++i) {
+        nulls->Append(positions[i] == 0);
+    }
+    return std::make_shared<ColumnNullable>(values, nulls);
+}
+
 std::ostream& operator<<(std::ostream& os, const ClientOptions& opt) {
     os << "Client(" << opt.user << '@' << opt.host << ":" << opt.port
        << " ping_before_query:" << opt.ping_before_query
        << " send_retries:" << opt.send_retries
        << " retry_timeout:" << opt.retry_timeout.count()
+       << " tcp_nodelay:" << opt.tcp_nodelay
+       << " tcp_recv_buffer_size:" << opt.tcp_recv_buffer_size
+       << " tcp_send_buffer_size:" << opt.tcp_send_buffer_size
+       << " tcp_busy_poll:" << opt.tcp_busy_poll.count()
+       << " tcp_quickack:" << opt.tcp_quickack
        << " compression_method:"
        << (opt.compression_method == CompressionMethod::LZ4 ? "LZ4" : "None")
        << ")";
     return os;
 }
 
+std::chrono::milliseconds GetRetryDelay(const ClientOptions& options, unsigned int attempt) {
+    const std::chrono::milliseconds base = options.retry_timeout;
+    const std::chrono::milliseconds limit = options.retry_timeout_max;
+
+    if (limit <= base) {
+        return base;
+    }
+
+    // Exponential backoff capped by retry_timeout_max, with a random
+    // jitter in [delay / 2, delay] to spread reconnects of many clients.
+    std::chrono::milliseconds delay = base;
+    for (unsigned int i = 0; i < attempt && delay < limit; ++i) {
+        delay *= 2;
+    }
+    delay = std::min(delay, limit);
+
+    // Called from client and spare connection threads.
+    static thread_local std::mt19937_64 random(std::random_device{}());
+    std::uniform_int_distribution<int64_t> jitter(delay.count() / 2, delay.count());
+    return std::chrono::milliseconds(jitter(random));
+}
+
 class Client::Impl {
 public:
      Impl(const ClientOptions& opts);
@@ -87,7 +141,35 @@ public:
     void ResetConnection();
 
 private:
-    bool Handshake();
+    /// Connected and handshaked socket.
+    struct Connection {
+        SocketHolder socket;
+        ServerInfo server_info;
+    };
+
+    /// Received block kept for reuse by the next packet.
+    struct PooledBlock {
+        Block block;
+        /// Type names of the columns as sent by the server.
+        std::vector<std::string> types;
+    };
+
+    /// Connects to the server and performs handshake on a new socket.
+    /// Does not touch state of the current connection.
+    Connection EstablishConnection() const;
+
+    /// Connects a new socket to the server without handshake.
+    SocketHolder ConnectSocket() const;
+
+    /// Performs handshake on the connected socket, which is moved into
+    /// the returned connection.  On failure the socket stays with
+    /// the caller.
+    Connection EstablishConnection(SocketHolder& socket) const;
+
+    /// Makes given connection the current one.
+    void SwapConnection(Connection&& connection);
+
+    bool Handshake(CodedInputStream* input, CodedOutputStream* output, ServerInfo* server_info) const;
 
     bool ReceivePacket(uint64_t* server_packet = nullptr);
 
@@ -95,11 +177,19 @@ private:
 
     void SendData(const Block& block);
 
-    bool SendHello();
+    bool SendHello(CodedOutputStream* output) const;
+
+    /// Reads block into the pooled one, loading columns in place while
+    /// the schema matches.
+    bool ReadBlock(PooledBlock* pooled, CodedInputStream* input);
 
-    bool ReadBlock(Block* block, CodedInputStream* input);
+    /// Returns a pooled block released by callbacks, or a new one.
+    PooledBlock& AcquireBlock();
 
-    bool ReceiveHello();
+    /// Drops blocks of the finished query unless the pool is enabled.
+    void ResetBlockPool();
+
+    bool ReceiveHello(CodedInputStream* input, ServerInfo* server_info) const;
 
     /// Reads data packet form input stream.
     bool ReceiveData(std::function<void(const Block&)> cb);
@@ -107,6 +197,9 @@ private:
     /// Reads exception packet form input stream.
     bool ReceiveException(bool rethrow = false);
 
+    /// Parses exception (with nested ones) from input stream.
+    static bool ReadException(CodedInputStream* input, Exception* e);
+
     void WriteBlock(const Block& block, CodedOutputStream* output);
 
 private:
@@ -114,6 +207,27 @@ private:
     /// call fuc several times.
     void RetryGuard(std::function<void()> fuc);
 
+    /// Delay before the next reconnect attempt.
+    std::chrono::milliseconds RetryDelay(unsigned int attempt) const;
+
+    /// Calls func, on a network error replaces the connection with the
+    /// spare one if there is an alive one.  If func only sends a request
+    /// (resend is true) it is called again on the new connection,
+    /// otherwise the error is rethrown, as the request may have been
+    /// executed already.
+    void SpareGuard(std::function<void()> func, bool resend);
+
+    /// Starts background preparation of a spare connection if it is
+    /// enabled and there is neither a spare nor an attempt in progress.
+    void PrepareSpareConnection();
+
+    /// Replaces current connection with the spare one.  Returns false
+    /// if there is no alive spare connection.
+    bool TakeSpareConnection();
+
+    /// Body of the background thread establishing spare connection.
+    void SpareConnectionLoop();
+
 private:
     class EnsureNull {
     public:
@@ -153,6 +267,26 @@ private:
     CodedOutputStream output_;
 
     ServerInfo server_info_;
+
+    /// Blocks are cleared and filled in place by the next packet with the
+    /// same schema, unless someone else still holds them.
+    std::vector<PooledBlock> block_pool_;
+    /// Index of the pooled block to replace when all of them are held.
+    size_t block_pool_next_ = 0;
+    /// Name and type of the column being read, kept to reuse capacity.
+    std::string column_name_;
+    std::string column_type_;
+
+    std::mutex spare_mutex_;
+    std::condition_variable spare_cv_;
+    std::optional<Connection> spare_;
+    /// Background thread is establishing a spare connection.
+    bool spare_pending_ = false;
+    /// Socket of the spare connection being handshaked, it is shut down
+    /// on destruction to interrupt the handshake.
+    SOCKET spare_handshaking_ = -1;
+    bool stopped_ = false;
+    std::thread spare_thread_;
 };
 
 
@@ -181,17 +315,33 @@ Client::Impl::Impl(const ClientOptions& opts)
                 throw;
             }
 
-            std::this_thread::sleep_for(options_.retry_timeout);
+            std::this_thread::sleep_for(RetryDelay(i - 1));
         }
     }
 
     if (options_.compression_method != CompressionMethod::None) {
         compression_ = CompressionState::Enable;
     }
+
+    PrepareSpareConnection();
 }
 
-Client::Impl::~Impl()
-{ }
+Client::Impl::~Impl() {
+    {
+        std::lock_guard<std::mutex> lock(spare_mutex_);
+        stopped_ = true;
+        // Server may never answer the handshake, and without connection
+        // timeouts the receive would block forever.
+        if (spare_handshaking_ != -1) {
+            SocketShutdown(spare_handshaking_);
+        }
+    }
+    spare_cv_.notify_all();
+
+    if (spare_thread_.joinable()) {
+        spare_thread_.join();
+    }
+}
 
 void Client::Impl::ExecuteQuery(Query query) {
     EnsureNull en(static_cast<QueryEvents*>(&query), &events_);
@@ -200,11 +350,15 @@ void Client::Impl::ExecuteQuery(Query query) {
         RetryGuard([this]() { Ping(); });
     }
 
-    SendQuery(query.GetText());
+    SpareGuard([&query, this]() { SendQuery(query.GetText()); }, true);
 
-    while (ReceivePacket()) {
-        ;
-    }
+    SpareGuard([this]() {
+        while (ReceivePacket()) {
+            ;
+        }
+    }, false);
+
+    ResetBlockPool();
 }
 
 void Client::Impl::Insert(const std::string& table_name, const Block& block) {
@@ -230,34 +384,39 @@ void Client::Impl::Insert(const std::string& table_name, const Block& block) {
         }
     }
 
-    SendQuery("INSERT INTO " + table_name + " ( " + fields_section.str() + " ) VALUES");
+    const std::string query = "INSERT INTO " + table_name + " ( " + fields_section.str() + " ) VALUES";
+    SpareGuard([&query, this]() { SendQuery(query); }, true);
 
-    uint64_t server_packet;
-    // Receive data packet.
-    while (true) {
-        bool ret = ReceivePacket(&server_packet);
+    SpareGuard([&block, this]() {
+        uint64_t server_packet;
+        // Receive data packet.
+        while (true) {
+            bool ret = ReceivePacket(&server_packet);
 
-        if (!ret) {
-            throw std::runtime_error("fail to receive data packet");
-        }
-        if (server_packet == ServerCodes::Data) {
-            break;
-        }
-        if (server_packet == ServerCodes::Progress) {
-            continue;
+            if (!ret) {
+                throw std::runtime_error("fail to receive data packet");
+            }
+            if (server_packet == ServerCodes::Data) {
+                break;
+            }
+            if (server_packet == ServerCodes::Progress) {
+                continue;
+            }
         }
-    }
 
-    // Send data.
-    SendData(block);
-    // Send empty block as marker of
-    // end of data.
-    SendData(Block());
+        // Send data.
+        SendData(block);
+        // Send empty block as marker of
+        // end of data.
+        SendData(Block());
 
-    // Wait for EOS.
-    while (ReceivePacket()) {
-        ;
-    }
+        // Wait for EOS.
+        while (ReceivePacket()) {
+            ;
+        }
+    }, false);
+
+    ResetBlockPool();
 }
 
 void Client::Impl::Ping() {
@@ -273,8 +432,34 @@ void Client::Impl::Ping() {
 }
 
 void Client::Impl::ResetConnection() {
+    try {
+        SwapConnection(EstablishConnection());
+    } catch (const ServerException& e) {
+        // Handshake itself doesn't notify query events, as it also runs
+        // on the spare connection thread.
+        if (events_) {
+            events_->OnServerException(e.GetException());
+        }
+        throw;
+    }
+}
+
+Client::Impl::Connection Client::Impl::EstablishConnection() const {
+    SocketHolder s = ConnectSocket();
+    return EstablishConnection(s);
+}
+
+SocketHolder Client::Impl::ConnectSocket() const {
+    SocketOptions socket_options;
+    socket_options.tcp_nodelay = options_.tcp_nodelay;
+    socket_options.recv_buffer_size = static_cast<int>(options_.tcp_recv_buffer_size);
+    socket_options.send_buffer_size = static_cast<int>(options_.tcp_send_buffer_size);
+
     SocketHolder s(SocketConnect(
-            NetworkAddress(options_.host, std::to_string(options_.port)), socket_timeout_params_));
+            NetworkAddress(options_.host, std::to_string(options_.port), options_.dns_cache_ttl),
+            socket_timeout_params_,
+            options_.connection_connect_timeout,
+            socket_options));
 
     if (s.Closed()) {
         throw std::system_error(errno, std::system_category());
@@ -286,22 +471,62 @@ void Client::Impl::ResetConnection() {
                           options_.tcp_keepalive_cnt);
     }
 
-    socket_ = std::move(s);
-    socket_input_ = SocketInput(socket_);
-    socket_output_ = SocketOutput(socket_);
-    buffered_input_.Reset();
-    buffered_output_.Reset();
+    if (options_.tcp_busy_poll.count() > 0) {
+        s.SetBusyPoll(options_.tcp_busy_poll.count());
+    }
+    if (options_.tcp_quickack) {
+        s.SetTcpQuickAck(true);
+    }
+
+    return s;
+}
+
+Client::Impl::Connection Client::Impl::EstablishConnection(SocketHolder& s) const {
+    Connection connection;
+
+    // Server sends nothing after Hello until it receives a request,
+    // so these streams never read ahead of the handshake and can be
+    // discarded afterwards.
+    SocketInput socket_input(s);
+    BufferedInput buffered_input(&socket_input);
+    CodedInputStream input(&buffered_input);
+
+    SocketOutput socket_output(s);
+    BufferedOutput buffered_output(&socket_output);
+    CodedOutputStream output(&buffered_output);
+
+    bool ok = false;
+    try {
+        ok = Handshake(&input, &output, &connection.server_info);
+    } catch (...) {
+        // Drop unsent data, so the destructor will not try to flush it.
+        buffered_output.Reset();
+        throw;
+    }
 
-    if (!Handshake()) {
+    if (!ok) {
+        buffered_output.Reset();
         throw std::runtime_error("fail to connect to " + options_.host);
     }
+
+    connection.socket = std::move(s);
+    return connection;
+}
+
+void Client::Impl::SwapConnection(Connection&& connection) {
+    socket_ = std::move(connection.socket);
+    server_info_ = std::move(connection.server_info);
+    socket_input_ = SocketInput(socket_, options_.tcp_quickack);
+    socket_output_ = SocketOutput(socket_);
+    buffered_input_.Reset();
+    buffered_output_.Reset();
 }
 
-bool Client::Impl::Handshake() {
-    if (!SendHello()) {
+bool Client::Impl::Handshake(CodedInputStream* input, CodedOutputStream* output, ServerInfo* server_info) const {
+    if (!SendHello(output)) {
         return false;
     }
-    if (!ReceiveHello()) {
+    if (!ReceiveHello(input, server_info)) {
         return false;
     }
     return true;
@@ -433,7 +658,7 @@ bool Client::Impl::ReceivePacket(uint64_t* server_packet) {
     return false;
 }
 
-bool Client::Impl::ReadBlock(Block* block, CodedInputStream* input) {
+bool Client::Impl::ReadBlock(PooledBlock* pooled, CodedInputStream* input) {
     // Additional information about block.
     if (REVISION >= DBMS_MIN_REVISION_WITH_BLOCK_INFO) {
         uint64_t num;
@@ -469,33 +694,110 @@ bool Client::Impl::ReadBlock(Block* block, CodedInputStream* input) {
         return false;
     }
 
-    for (size_t i = 0; i < num_columns; ++i) {
-        std::string name;
-        std::string type;
+    Block& block = pooled->block;
+    // Set when the schema differs from the one of the pooled block.
+    std::optional<Block> rebuilt;
+
+    if (num_columns != block.GetColumnCount()) {
+        rebuilt.emplace(num_columns, num_rows, options_.memory_resource);
+        pooled->types.clear();
+    }
 
-        if (!WireFormat::ReadString(input, &name)) {
+    for (size_t i = 0; i < num_columns; ++i) {
+        if (!WireFormat::ReadString(input, &column_name_)) {
             return false;
         }
-        if (!WireFormat::ReadString(input, &type)) {
+        if (!WireFormat::ReadString(input, &column_type_)) {
             return false;
         }
 
-        if (ColumnRef col = CreateColumnByType(type)) {
-            if (num_rows && !col->Load(input, num_rows)) {
-                throw std::runtime_error("can't load");
+        ColumnRef col;
+
+        if (!rebuilt) {
+            if (i < pooled->types.size() && pooled->types[i] == column_type_ &&
+                block.GetColumnName(i) == column_name_)
+            {
+                col = block[i];
+                col->Clear();
+            } else {
+                rebuilt.emplace(num_columns, num_rows, options_.memory_resource);
+                for (size_t j = 0; j < i; ++j) {
+                    rebuilt->AppendColumn(block.GetColumnName(j), block[j]);
+                    if (auto stats = block.GetColumnStats(j)) {
+                        rebuilt->SetColumnStats(j, *stats);
+                    }
+                }
+                pooled->types.resize(i);
             }
+        }
 
-            block->AppendColumn(name, col);
-        } else {
-            throw std::runtime_error(std::string("unsupported column type: ") + type);
+        if (rebuilt) {
+            if (!(col = CreateColumnByType(column_type_, options_.memory_resource))) {
+                throw std::runtime_error(std::string("unsupported column type: ") + column_type_);
+            }
+            pooled->types.push_back(column_type_);
+        }
+
+        if (num_rows && !(col->LoadPrefix(input, num_rows) && col->Load(input, num_rows))) {
+            throw std::runtime_error("can't load");
+        }
+
+        if (rebuilt) {
+            rebuilt->AppendColumn(column_name_, col);
+        }
+        if (options_.column_stats) {
+            (rebuilt ? *rebuilt : block).SetColumnStats(i, ComputeStats(col));
         }
     }
 
+    if (rebuilt) {
+        block = *rebuilt;
+    } else {
+        block.RefreshRowCount();
+    }
+
+    return true;
+}
+
+/// The block can be reused when neither it nor its columns, including
+/// nested ones, are referenced outside of the pool.
+static bool IsReleased(const Block& block) {
+    for (size_t i = 0; i < block.GetColumnCount(); ++i) {
+        // One reference is held by the block and one by the returned copy.
+        if (block[i].use_count() > 2 || !block[i]->IsExclusivelyOwned()) {
+            return false;
+        }
+    }
     return true;
 }
 
+Client::Impl::PooledBlock& Client::Impl::AcquireBlock() {
+    for (auto& pooled : block_pool_) {
+        if (IsReleased(pooled.block)) {
+            return pooled;
+        }
+    }
+
+    if (block_pool_.size() < std::max<size_t>(options_.block_pool_size, 1)) {
+        block_pool_.push_back(PooledBlock{Block(options_.memory_resource), {}});
+        return block_pool_.back();
+    }
+
+    // All blocks are held, leave one of them to its holders.
+    PooledBlock& pooled = block_pool_[block_pool_next_++ % block_pool_.size()];
+    pooled = PooledBlock{Block(options_.memory_resource), {}};
+    return pooled;
+}
+
+void Client::Impl::ResetBlockPool() {
+    // Do not keep memory of received blocks between queries unless asked.
+    if (options_.block_pool_size == 0) {
+        block_pool_.clear();
+    }
+}
+
 bool Client::Impl::ReceiveData(std::function<void(const Block&)> cb) {
-    Block block;
+    PooledBlock& pooled = AcquireBlock();
     std::string table_name;
 
     // Read name of a table.
@@ -507,40 +809,57 @@ bool Client::Impl::ReceiveData(std::function<void(const Block&)> cb) {
         CompressedInput compressed(&input_);
         CodedInputStream coded(&compressed);
 
-        if (!ReadBlock(&block, &coded)) {
+        if (!ReadBlock(&pooled, &coded)) {
             return false;
         }
     } else {
-        if (!ReadBlock(&block, &input_)) {
+        if (!ReadBlock(&pooled, &input_)) {
             return false;
         }
     }
 
-    cb(block);
+    cb(pooled.block);
 
     return true;
 }
 
 bool Client::Impl::ReceiveException(bool rethrow) {
     std::unique_ptr<Exception> e(new Exception);
-    Exception* current = e.get();
+
+    if (!ReadException(&input_, e.get())) {
+        return false;
+    }
+
+    if (events_) {
+        events_->OnServerException(*e);
+    }
+
+    if (rethrow || options_.rethrow_exceptions) {
+        throw ServerException(std::move(e));
+    }
+
+    return true;
+}
+
+bool Client::Impl::ReadException(CodedInputStream* input, Exception* e) {
+    Exception* current = e;
 
     do {
         bool has_nested = false;
 
-        if (!WireFormat::ReadFixed(&input_, &current->code)) {
+        if (!WireFormat::ReadFixed(input, &current->code)) {
             return false;
         }
-        if (!WireFormat::ReadString(&input_, &current->name)) {
+        if (!WireFormat::ReadString(input, &current->name)) {
             return false;
         }
-        if (!WireFormat::ReadString(&input_, &current->display_text)) {
+        if (!WireFormat::ReadString(input, &current->display_text)) {
             return false;
         }
-        if (!WireFormat::ReadString(&input_, &current->stack_trace)) {
+        if (!WireFormat::ReadString(input, &current->stack_trace)) {
             return false;
         }
-        if (!WireFormat::ReadFixed(&input_, &has_nested)) {
+        if (!WireFormat::ReadFixed(input, &has_nested)) {
             return false;
         }
 
@@ -552,14 +871,6 @@ bool Client::Impl::ReceiveException(bool rethrow) {
         }
     } while (true);
 
-    if (events_) {
-        events_->OnServerException(*e);
-    }
-
-    if (rethrow || options_.rethrow_exceptions) {
-        throw ServerException(std::move(e));
-    }
-
     return true;
 }
 
@@ -569,6 +880,8 @@ void Client::Impl::SendCancel() {
 }
 
 void Client::Impl::SendQuery(const std::string& query) {
+    ResetBlockPool();
+
     WireFormat::WriteUInt64(&output_, ClientCodes::Query);
     WireFormat::WriteString(&output_, std::string());
 
@@ -636,10 +949,21 @@ void Client::Impl::WriteBlock(const Block& block, CodedOutputStream* output) {
     WireFormat::WriteUInt64(output, block.GetRowCount());
 
     for (Block::Iterator bi(block); bi.IsValid(); bi.Next()) {
+        ColumnRef column = bi.Column();
+        if (server_info_.revision < DBMS_MIN_REVISION_WITH_LOW_CARDINALITY_TYPE) {
+            if (auto low_cardinality = column->As<ColumnLowCardinality>()) {
+                column = ToPlainColumn(*low_cardinality);
+            }
+        }
+
         WireFormat::WriteString(output, bi.Name());
-        WireFormat::WriteString(output, bi.Type()->GetName());
+        WireFormat::WriteString(output, column->Type()->GetName());
 
-        bi.Column()->Save(output);
+        // Empty columns are sent without data and prefix.
+        if (block.GetRowCount() > 0) {
+            column->SavePrefix(output);
+            column->Save(output);
+        }
     }
 }
 
@@ -695,63 +1019,68 @@ void Client::Impl::SendData(const Block& block) {
     output_.Flush();
 }
 
-bool Client::Impl::SendHello() {
-    WireFormat::WriteUInt64(&output_, ClientCodes::Hello);
-    WireFormat::WriteString(&output_, std::string(DBMS_NAME) + " client");
-    WireFormat::WriteUInt64(&output_, DBMS_VERSION_MAJOR);
-    WireFormat::WriteUInt64(&output_, DBMS_VERSION_MINOR);
-    WireFormat::WriteUInt64(&output_, REVISION);
-    WireFormat::WriteString(&output_, options_.default_database);
-    WireFormat::WriteString(&output_, options_.user);
-    WireFormat::WriteString(&output_, options_.password);
+bool Client::Impl::SendHello(CodedOutputStream* output) const {
+    WireFormat::WriteUInt64(output, ClientCodes::Hello);
+    WireFormat::WriteString(output, std::string(DBMS_NAME) + " client");
+    WireFormat::WriteUInt64(output, DBMS_VERSION_MAJOR);
+    WireFormat::WriteUInt64(output, DBMS_VERSION_MINOR);
+    WireFormat::WriteUInt64(output, REVISION);
+    WireFormat::WriteString(output, options_.default_database);
+    WireFormat::WriteString(output, options_.user);
+    WireFormat::WriteString(output, options_.password);
 
-    output_.Flush();
+    output->Flush();
 
     return true;
 }
 
-bool Client::Impl::ReceiveHello() {
+bool Client::Impl::ReceiveHello(CodedInputStream* input, ServerInfo* server_info) const {
     uint64_t packet_type = 0;
 
-    if (!input_.ReadVarint64(&packet_type)) {
+    if (!input->ReadVarint64(&packet_type)) {
         return false;
     }
 
     if (packet_type == ServerCodes::Hello) {
-        if (!WireFormat::ReadString(&input_, &server_info_.name)) {
+        if (!WireFormat::ReadString(input, &server_info->name)) {
             return false;
         }
-        if (!WireFormat::ReadUInt64(&input_, &server_info_.version_major)) {
+        if (!WireFormat::ReadUInt64(input, &server_info->version_major)) {
             return false;
         }
-        if (!WireFormat::ReadUInt64(&input_, &server_info_.version_minor)) {
+        if (!WireFormat::ReadUInt64(input, &server_info->version_minor)) {
             return false;
         }
-        if (!WireFormat::ReadUInt64(&input_, &server_info_.revision)) {
+        if (!WireFormat::ReadUInt64(input, &server_info->revision)) {
             return false;
         }
 
-        if (server_info_.revision >= DBMS_MIN_REVISION_WITH_SERVER_TIMEZONE) {
-            if (!WireFormat::ReadString(&input_, &server_info_.timezone)) {
+        if (server_info->revision >= DBMS_MIN_REVISION_WITH_SERVER_TIMEZONE) {
+            if (!WireFormat::ReadString(input, &server_info->timezone)) {
                 return false;
             }
         }
-        if (server_info_.revision >= DBMS_MIN_REVISION_WITH_SERVER_DISPLAY_NAME) {
-            if (!WireFormat::ReadString(&input_, &server_info_.display_name)) {
+        if (server_info->revision >= DBMS_MIN_REVISION_WITH_SERVER_DISPLAY_NAME) {
+            if (!WireFormat::ReadString(input, &server_info->display_name)) {
                 return false;
             }
         }
-        if (server_info_.revision >= DBMS_MIN_REVISION_WITH_VERSION_PATCH) {
-            if (!WireFormat::ReadUInt64(&input_, &server_info_.version_patch)) {
+        if (server_info->revision >= DBMS_MIN_REVISION_WITH_VERSION_PATCH) {
+            if (!WireFormat::ReadUInt64(input, &server_info->version_patch)) {
                 return false;
             }
         } else {
-            server_info_.version_patch = server_info_.revision;
+            server_info->version_patch = server_info->revision;
         }
 
         return true;
     } else if (packet_type == ServerCodes::Exception) {
-        ReceiveException(true);
+        // Handshake may run on a background thread, so the exception is
+        // not passed to query events.
+        std::unique_ptr<Exception> e(new Exception);
+        if (ReadException(input, e.get())) {
+            throw ServerException(std::move(e));
+        }
         return false;
     }
 
@@ -767,8 +1096,10 @@ void Client::Impl::RetryGuard(std::function<void()> func) {
             bool ok = true;
 
             try {
-                std::this_thread::sleep_for(options_.retry_timeout);
-                ResetConnection();
+                if (!TakeSpareConnection()) {
+                    std::this_thread::sleep_for(RetryDelay(i));
+                    ResetConnection();
+                }
             } catch (...) {
                 ok = false;
             }
@@ -780,6 +1111,110 @@ void Client::Impl::RetryGuard(std::function<void()> func) {
     }
 }
 
+void Client::Impl::SpareGuard(std::function<void()> func, bool resend) {
+    try {
+        func();
+    } catch (const std::system_error&) {
+        if (!TakeSpareConnection() || !resend) {
+            throw;
+        }
+        func();
+    }
+}
+
+std::chrono::milliseconds Client::Impl::RetryDelay(unsigned int attempt) const {
+    return GetRetryDelay(options_, attempt);
+}
+
+void Client::Impl::PrepareSpareConnection() {
+    if (!options_.spare_connection) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(spare_mutex_);
+        if (spare_ || spare_pending_ || stopped_) {
+            return;
+        }
+        spare_pending_ = true;
+    }
+
+    // Previous thread has already finished its work.
+    if (spare_thread_.joinable()) {
+        spare_thread_.join();
+    }
+    spare_thread_ = std::thread([this] { SpareConnectionLoop(); });
+}
+
+bool Client::Impl::TakeSpareConnection() {
+    std::optional<Connection> spare;
+    {
+        std::lock_guard<std::mutex> lock(spare_mutex_);
+        spare.swap(spare_);
+    }
+
+    if (spare) {
+        // Idle connection may have been closed by the server.  In that case
+        // the socket is readable (EOF) though the server must not send
+        // anything before a request.
+        pollfd fd;
+        fd.fd = spare->socket;
+        fd.events = POLLIN;
+        fd.revents = 0;
+
+        if (Poll(&fd, 1, 0) != 0) {
+            spare.reset();
+        }
+    }
+
+    if (spare) {
+        SwapConnection(std::move(*spare));
+    }
+
+    PrepareSpareConnection();
+
+    return spare.has_value();
+}
+
+void Client::Impl::SpareConnectionLoop() {
+    for (unsigned int attempt = 0; ; ++attempt) {
+        try {
+            SocketHolder s = ConnectSocket();
+            {
+                std::lock_guard<std::mutex> lock(spare_mutex_);
+                if (stopped_) {
+                    spare_pending_ = false;
+                    return;
+                }
+                spare_handshaking_ = s;
+            }
+
+            std::optional<Connection> connection;
+            try {
+                connection = EstablishConnection(s);
+            } catch (const std::exception&) {
+                // The socket is closed after it is unpublished.
+            }
+
+            std::lock_guard<std::mutex> lock(spare_mutex_);
+            spare_handshaking_ = -1;
+            if (connection) {
+                spare_ = std::move(connection);
+                spare_pending_ = false;
+                return;
+            }
+        } catch (const std::exception&) {
+            // Try again after a delay.
+        }
+
+        std::unique_lock<std::mutex> lock(spare_mutex_);
+        if (spare_cv_.wait_for(lock, RetryDelay(attempt), [this] { return stopped_; })) {
+            spare_pending_ = false;
+            return;
+        }
+    }
+}
+
 Client::Client(const ClientOptions& opts)
     : options_(opts)
     , impl_(new Impl(opts))
@@ -9,6 +9,8 @@
 #include "columns/enum.h"
 #include "columns/ip4.h"
 #include "columns/ip6.h"
+#include "columns/lowcardinality.h"
+#include "columns/map.h"
 #include "columns/nullable.h"
 #include "columns/numeric.h"
 #include "columns/string.h"
@@ -17,6 +19,7 @@
 
 #include <chrono>
 #include <memory>
+#include <memory_resource>
 #include <ostream>
 #include <string>
 
@@ -31,7 +34,7 @@ enum class CompressionMethod {
 struct ClientOptions {
 #define DECLARE_FIELD(name, type, setter, default) \
     type name = default; \
-    inline ClientOptions& setter(const type& value) { \
+    inline ClientOptions& setter(type const& value) { \
         name = value; \
         return *this; \
     }
@@ -59,26 +62,80 @@ struct ClientOptions {
     DECLARE_FIELD(send_retries, unsigned int, SetSendRetries, 1);
     /// Amount of time to wait before next retry.
     DECLARE_FIELD(retry_timeout, std::chrono::seconds, SetRetryTimeout, std::chrono::seconds(5));
+    /// Upper bound of the delay between retries.  When it is greater than
+    /// retry_timeout, the delay doubles with each retry up to this bound
+    /// and gets a random jitter.  Otherwise the delay is fixed.
+    DECLARE_FIELD(retry_timeout_max, std::chrono::seconds, SetRetryTimeoutMax, std::chrono::seconds(0));
+    /// Keep a connected and handshaked spare connection, which replaces
+    /// the current one on a network error without waiting for reconnect.
+    /// A query which failed to be sent is sent again over it, a query
+    /// which failed later still fails and the next one uses it.
+    /// The spare connection is re-established in background.
+    DECLARE_FIELD(spare_connection, bool, SpareConnection, false);
 
     /// Compression method.
     DECLARE_FIELD(compression_method, CompressionMethod, SetCompressionMethod, CompressionMethod::None);
 
+    /// Memory resource for blocks and columns received from the server,
+    /// e.g. a per-query arena.  It must stay valid until the query
+    /// returns, no memory of it is kept between queries unless the block
+    /// pool is enabled.
+    DECLARE_FIELD(memory_resource, std::pmr::memory_resource*, SetMemoryResource, std::pmr::get_default_resource());
+
+    /// Count of received blocks kept by the connection for reuse.  Once
+    /// a data callback returns and no copies of a block or its columns
+    /// are held, the block is cleared and filled in place by the next
+    /// packet with the same schema, keeping capacity of the columns.
+    /// The pool lives as long as the client; with 0 only the last block
+    /// of the current query is reused.
+    DECLARE_FIELD(block_pool_size, size_t, SetBlockPoolSize, 0);
+
+    /// Compute statistics of each column of received blocks right after
+    /// the column is loaded, while its data is still in cache.  They are
+    /// available with Block::GetColumnStats().
+    DECLARE_FIELD(column_stats, bool, SetColumnStats, false);
+
     /// TCP Keep alive options
     DECLARE_FIELD(tcp_keepalive, bool, TcpKeepAlive, false);
     DECLARE_FIELD(tcp_keepalive_idle, std::chrono::seconds, SetTcpKeepAliveIdle, std::chrono::seconds(60));
     DECLARE_FIELD(tcp_keepalive_intvl, std::chrono::seconds, SetTcpKeepAliveInterval, std::chrono::seconds(5));
     DECLARE_FIELD(tcp_keepalive_cnt, unsigned int, SetTcpKeepAliveCount, 3);
 
+    /// Disable Nagle's algorithm, so small packets (Ping, Query) are not
+    /// delayed until the previous ones are acknowledged.
+    DECLARE_FIELD(tcp_nodelay, bool, TcpNoDelay, true);
+    /// Sizes of the socket receive and send buffers in bytes.
+    /// Zero keeps the system default.
+    DECLARE_FIELD(tcp_recv_buffer_size, unsigned int, SetTcpRecvBufferSize, 0);
+    DECLARE_FIELD(tcp_send_buffer_size, unsigned int, SetTcpSendBufferSize, 0);
+    /// Busy poll the device queue on blocking reads (Linux only).
+    /// Zero disables busy polling.
+    DECLARE_FIELD(tcp_busy_poll, std::chrono::microseconds, SetTcpBusyPoll, std::chrono::microseconds(0));
+    /// Acknowledge received data immediately instead of delaying ACKs (Linux only).
+    DECLARE_FIELD(tcp_quickack, bool, TcpQuickAck, false);
+
     /// Connection socket timeout
     DECLARE_FIELD(connection_timeout, bool, ConnectionTimeout, false);
     DECLARE_FIELD(connection_recv_timeout, std::chrono::seconds, SetConnectionRecvTimeout, std::chrono::seconds(60));
     DECLARE_FIELD(connection_send_timeout, std::chrono::seconds, SetConnectionSendTimeout, std::chrono::seconds(60));
 
+    /// Time limit for establishing a TCP connection, independent of
+    /// the send/receive timeouts.  All addresses of the host are raced
+    /// within this limit.
+    DECLARE_FIELD(connection_connect_timeout, std::chrono::milliseconds, SetConnectionConnectTimeout, std::chrono::milliseconds(5000));
+    /// How long resolved addresses of the host are cached.
+    /// Zero disables caching, so each reconnect resolves the host again.
+    DECLARE_FIELD(dns_cache_ttl, std::chrono::seconds, SetDnsCacheTtl, std::chrono::seconds(0));
+
 #undef DECLARE_FIELD
 };
 
 std::ostream& operator<<(std::ostream& os, const ClientOptions& options);
 
+/// Returns delay before the reconnect attempt number attempt, counted from
+/// zero, for given options.  See retry_timeout_max.
+std::chrono::milliseconds GetRetryDelay(const ClientOptions& options, unsigned int attempt);
+
 /**
  *
  */
@@ -1,12 +1,23 @@
 #include "array.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <limits>
 #include <stdexcept>
 
 namespace clickhouse {
 
 ColumnArray::ColumnArray(ColumnRef data)
-    : Column(Type::CreateArray(data->Type()))
+    : Column(Type::CreateArray(data->Type()), data->GetMemoryResource())
     , data_(data)
-    , offsets_(std::make_shared<ColumnUInt64>())
+    , offsets_(MakeColumn<ColumnUInt64>(resource_))
+{
+}
+
+ColumnArray::ColumnArray(ColumnRef data, std::shared_ptr<ColumnUInt64> offsets)
+    : Column(Type::CreateArray(data->Type()), data->GetMemoryResource())
+    , data_(std::move(data))
+    , offsets_(std::move(offsets))
 {
 }
 
@@ -31,15 +42,89 @@ ColumnRef ColumnArray::GetAsColumn(size_t n) const {
 }
 
 ColumnRef ColumnArray::Slice(size_t begin, size_t size) {
-    auto result = std::make_shared<ColumnArray>(GetAsColumn(begin));
-    result->OffsetsIncrease(1);
+    begin = std::min(begin, Size());
+    size = std::min(size, Size() - begin);
+
+    // One slice of nested data with offsets rebased to its start.
+    const size_t first = GetOffset(begin);
+    const size_t last = GetOffset(begin + size);
+    auto offsets = MakeColumn<ColumnUInt64>(resource_);
+
+    offsets->Reserve(size);
+    for (size_t i = 0; i < size; ++i) {
+        offsets->Append((*offsets_)[begin + i] - first);
+    }
+
+    return MakeColumn<ColumnArray>(resource_, data_->Slice(first, last - first), offsets);
+}
+
+ColumnRef ColumnArray::Filter(const uint8_t* mask) const {
+    // Elements of the kept arrays are filtered out of the nested column
+    // in one pass, by the mask of rows spread over their elements.
+    const size_t rows = Size();
+    std::vector<uint8_t> items(data_->Size());
+    auto offsets = MakeColumn<ColumnUInt64>(resource_);
+    size_t offset = 0;
+
+    offsets->Reserve(CountNonZero(mask, rows));
+    for (size_t i = 0; i < rows; ++i) {
+        if (mask[i]) {
+            const size_t begin = GetOffset(i);
+            const size_t size = GetSize(i);
+            std::fill_n(items.begin() + begin, size, uint8_t(1));
+            offset += size;
+            offsets->Append(offset);
+        }
+    }
+
+    return MakeColumn<ColumnArray>(resource_, data_->Filter(items.data()), offsets);
+}
+
+ColumnRef ColumnArray::Take(const uint32_t* indices, size_t count) const {
+    if (data_->Size() > std::numeric_limits<uint32_t>::max()) {
+        throw std::runtime_error("too many elements in arrays to take rows by 32-bit positions");
+    }
+
+    // Positions of elements of the taken arrays in the nested column.
+    const size_t rows = Size();
+    std::vector<uint32_t> items;
+    auto offsets = MakeColumn<ColumnUInt64>(resource_);
 
-    for (size_t i = 1; i < size; i++)
-    {
-        result->Append(std::make_shared<ColumnArray>(GetAsColumn(begin + i)));
+    offsets->Reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        if (indices[i] >= rows) {
+            throw std::out_of_range("row index is out of range: " + std::to_string(indices[i]));
+        }
+        const size_t begin = GetOffset(indices[i]);
+        const size_t end = begin + GetSize(indices[i]);
+        for (size_t j = begin; j < end; ++j) {
+            items.push_back(static_cast<uint32_t>(j));
+        }
+        offsets->Append(items.size());
     }
 
-    return result;
+    return MakeColumn<ColumnArray>(resource_, data_->Take(items.data(), items.size()), offsets);
+}
+
+size_t ColumnArray::MemoryUsage() const {
+    return data_->MemoryUsage() + offsets_->MemoryUsage();
+}
+
+void ColumnArray::Reserve(size_t rows) {
+    offsets_->Reserve(rows);
+}
+
+void ColumnArray::ShrinkToFit() {
+    data_->ShrinkToFit();
+    offsets_->ShrinkToFit();
+}
+
+bool ColumnArray::IsExclusivelyOwned() const {
+    return OwnsNested(1);
+}
+
+bool ColumnArray::OwnsNested(long data_references) const {
+    return IsNestedOwned(data_, data_references) && IsNestedOwned(offsets_);
 }
 
 void ColumnArray::Append(ColumnRef column) {
@@ -47,13 +132,25 @@ void ColumnArray::Append(ColumnRef column) {
         if (!col->data_->Type()->IsEqual(data_->Type())) {
             return;
         }
+        if (col.get() == this) {
+            col = Slice(0, Size())->As<ColumnArray>();
+        }
 
-        for (size_t i = 0; i < col->Size(); ++i) {
-            AppendAsColumn(col->GetAsColumn(i));
+        const size_t base = GetOffset(Size());
+        const size_t rows = col->Size();
+
+        for (size_t i = 0; i < rows; ++i) {
+            offsets_->Append(base + (*col->offsets_)[i]);
         }
+
+        data_->Append(col->data_);
     }
 }
 
+bool ColumnArray::LoadPrefix(CodedInputStream* input, size_t rows) {
+    return data_->LoadPrefix(input, rows);
+}
+
 bool ColumnArray::Load(CodedInputStream* input, size_t rows) {
     if (!rows) {
         return true;
@@ -67,6 +164,10 @@ bool ColumnArray::Load(CodedInputStream* input, size_t rows) {
     return true;
 }
 
+void ColumnArray::SavePrefix(CodedOutputStream* output) {
+    data_->SavePrefix(output);
+}
+
 void ColumnArray::Save(CodedOutputStream* output) {
     offsets_->Save(output);
     data_->Save(output);
@@ -85,12 +186,4 @@ void ColumnArray::OffsetsIncrease(size_t n) {
     offsets_->Append(n);
 }
 
-size_t ColumnArray::GetOffset(size_t n) const {
-    return (n == 0) ? 0 : (*offsets_)[n - 1];
-}
-
-size_t ColumnArray::GetSize(size_t n) const {
-    return (n == 0) ? (*offsets_)[n] : ((*offsets_)[n] - (*offsets_)[n - 1]);
-}
-
 }
@@ -2,6 +2,10 @@
 
 #include "numeric.h"
 
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
 namespace clickhouse {
 
 /**
@@ -11,6 +15,9 @@ class ColumnArray : public Column {
 public:
     ColumnArray(ColumnRef data);
 
+    /// Makes array of the elements column and the end offsets of its rows.
+    ColumnArray(ColumnRef data, std::shared_ptr<ColumnUInt64> offsets);
+
     /// Converts input column to array and appends
     /// as one row to the current column.
     void AppendAsColumn(ColumnRef array);
@@ -19,13 +26,35 @@ public:
     /// Type of element of result column same as type of array element.
     ColumnRef GetAsColumn(size_t n) const;
 
+    /// Returns column holding elements of all arrays.
+    ColumnRef GetData() const {
+        return data_;
+    }
+
+    /// Returns position of the first element of array at pos n in the
+    /// column of elements.
+    inline size_t GetOffset(size_t n) const {
+        return (n == 0) ? 0 : (*offsets_)[n - 1];
+    }
+
+    /// Returns count of elements of array at pos n.
+    inline size_t GetSize(size_t n) const {
+        return (*offsets_)[n] - GetOffset(n);
+    }
+
 public:
     /// Appends content of given column to the end of current one.
     void Append(ColumnRef column) override;
 
+    /// Loads column prefix from input stream.
+    bool LoadPrefix(CodedInputStream* input, size_t rows) override;
+
     /// Loads column data from input stream.
     bool Load(CodedInputStream* input, size_t rows) override;
 
+    /// Saves column prefix to output stream.
+    void SavePrefix(CodedOutputStream* output) override;
+
     /// Saves column data to output stream.
     void Save(CodedOutputStream* output) override;
 
@@ -38,16 +67,207 @@ public:
     /// Makes slice of the current column.
     ColumnRef Slice(size_t, size_t) override;
 
+    /// Makes column of the rows selected by the mask.
+    ColumnRef Filter(const uint8_t* mask) const override;
+
+    /// Makes column of the rows at given positions.
+    ColumnRef Take(const uint32_t* indices, size_t count) const override;
+
+    /// Returns count of bytes of memory held by the column data.
+    size_t MemoryUsage() const override;
+
+    /// Preallocates memory for given total count of rows.
+    /// Memory of the nested column is not reserved, as its size is unknown.
+    void Reserve(size_t rows) override;
+
+    /// Releases memory reserved beyond the current content.
+    void ShrinkToFit() override;
+
+    /// Returns true if nested columns are not referenced from outside.
+    bool IsExclusivelyOwned() const override;
+
     void OffsetsIncrease(size_t);
 
-private:
-    size_t GetOffset(size_t n) const;
+protected:
+    template <typename> friend class ColumnArrayT;
+    friend class ColumnMap;
 
-    size_t GetSize(size_t n) const;
+    /// Returns true if the elements column has at most given count of
+    /// references and the nested columns are exclusively owned.
+    bool OwnsNested(long data_references) const;
 
-private:
+protected:
     ColumnRef data_;
     std::shared_ptr<ColumnUInt64> offsets_;
 };
 
+/**
+ * Represents column of Array(T) with nested column of known type.
+ *
+ * Rows are accessed through views into the nested column, without
+ * allocation of intermediate columns.  Views are invalidated by
+ * modification of the column.
+ */
+template <typename NestedColumnType>
+class ColumnArrayT : public ColumnArray {
+public:
+    /// View of one row of the column.
+    class ArrayValueView {
+    public:
+        using ValueType = std::decay_t<decltype(std::declval<const NestedColumnType&>()[0])>;
+
+        class Iterator {
+        public:
+            inline Iterator(const NestedColumnType* column, size_t pos) noexcept
+                : column_(column)
+                , pos_(pos)
+            { }
+
+            inline decltype(auto) operator * () const {
+                return (*column_)[pos_];
+            }
+
+            inline Iterator& operator ++ () noexcept {
+                ++pos_;
+                return *this;
+            }
+
+            inline bool operator == (const Iterator& other) const noexcept {
+                return pos_ == other.pos_ && column_ == other.column_;
+            }
+
+            inline bool operator != (const Iterator& other) const noexcept {
+                return !(*this == other);
+            }
+
+        private:
+            const NestedColumnType* column_;
+            size_t pos_;
+        };
+
+        inline ArrayValueView(const NestedColumnType* column, size_t offset, size_t size) noexcept
+            : column_(column)
+            , offset_(offset)
+            , size_(size)
+        { }
+
+        /// Returns element at given position in the array.
+        inline decltype(auto) operator [] (size_t n) const {
+            return (*column_)[offset_ + n];
+        }
+
+        /// Returns element at given position in the array with bounds checking.
+        inline decltype(auto) At(size_t n) const {
+            if (n >= size_) {
+                throw std::out_of_range("array index is out of range: " + std::to_string(n));
+            }
+            return (*column_)[offset_ + n];
+        }
+
+        /// Returns pointer to contiguous elements of the array,
+        /// available for numeric nested columns only.
+        template <typename C = NestedColumnType>
+        inline auto Data() const noexcept -> decltype(std::declval<const C&>().GetData().data()) {
+            return column_->GetData().data() + offset_;
+        }
+
+        inline size_t Size() const noexcept {
+            return size_;
+        }
+
+        inline bool Empty() const noexcept {
+            return size_ == 0;
+        }
+
+        inline Iterator begin() const noexcept {
+            return Iterator(column_, offset_);
+        }
+
+        inline Iterator end() const noexcept {
+            return Iterator(column_, offset_ + size_);
+        }
+
+    private:
+        const NestedColumnType* column_;
+        size_t offset_;
+        size_t size_;
+    };
+
+    explicit ColumnArrayT(std::shared_ptr<NestedColumnType> data)
+        : ColumnArray(data)
+        , typed_data_(std::move(data))
+    {
+    }
+
+    /// Makes typed column sharing data with the given array column.
+    /// Throws if the array's elements are not of NestedColumnType.
+    static std::shared_ptr<ColumnArrayT> Wrap(ColumnRef column) {
+        if (auto typed = std::dynamic_pointer_cast<ColumnArrayT>(column)) {
+            return typed;
+        }
+
+        auto array = column->As<ColumnArray>();
+        if (!array) {
+            throw std::runtime_error("can't wrap column of type " + column->Type()->GetName() + " as array");
+        }
+
+        auto data = array->data_->template As<NestedColumnType>();
+        if (!data) {
+            throw std::runtime_error("can't wrap array with elements of type " + array->data_->Type()->GetName());
+        }
+
+        return std::shared_ptr<ColumnArrayT>(new ColumnArrayT(std::move(data), array->offsets_));
+    }
+
+    /// Returns view of the array at given row number.
+    inline ArrayValueView At(size_t n) const {
+        if (n >= Size()) {
+            throw std::out_of_range("row index is out of range: " + std::to_string(n));
+        }
+        return (*this)[n];
+    }
+
+    /// Returns view of the array at given row number.
+    inline ArrayValueView operator [] (size_t n) const {
+        return ArrayValueView(typed_data_.get(), GetOffset(n), GetSize(n));
+    }
+
+    /// Returns typed column of elements of all arrays.
+    inline const std::shared_ptr<NestedColumnType>& GetData() const noexcept {
+        return typed_data_;
+    }
+
+public:
+    /// Makes slice of the current column.
+    ColumnRef Slice(size_t begin, size_t len) override {
+        return Wrap(ColumnArray::Slice(begin, len));
+    }
+
+    /// Makes column of the rows selected by the mask.
+    ColumnRef Filter(const uint8_t* mask) const override {
+        return Wrap(ColumnArray::Filter(mask));
+    }
+
+    /// Makes column of the rows at given positions.
+    ColumnRef Take(const uint32_t* indices, size_t count) const override {
+        return Wrap(ColumnArray::Take(indices, count));
+    }
+
+    /// Returns true if nested columns are not referenced from outside.
+    bool IsExclusivelyOwned() const override {
+        // The elements column is referenced by typed_data_ as well.
+        return OwnsNested(2);
+    }
+
+private:
+    ColumnArrayT(std::shared_ptr<NestedColumnType> data, std::shared_ptr<ColumnUInt64> offsets)
+        : ColumnArray(data, std::move(offsets))
+        , typed_data_(std::move(data))
+    {
+    }
+
+private:
+    std::shared_ptr<NestedColumnType> typed_data_;
+};
+
 }
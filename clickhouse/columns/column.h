@@ -4,18 +4,39 @@
 #include "../base/coded.h"
 #include "../types/types.h"
 
+#include <memory_resource>
+#include <type_traits>
+
 namespace clickhouse {
 
 using ColumnRef = std::shared_ptr<class Column>;
 
+/**
+ * Makes column of type T whose object and storage are allocated from
+ * the resource.  The resource is passed to the constructor as the last
+ * argument and must outlive the column.  Columns built of other columns,
+ * like Nullable, take no resource argument and store their data in the
+ * given columns.
+ */
+template <typename T, typename... Args>
+inline std::shared_ptr<T> MakeColumn(std::pmr::memory_resource* resource, Args&&... args) {
+    const std::pmr::polymorphic_allocator<T> alloc(resource);
+    if constexpr (std::is_constructible_v<T, Args..., std::pmr::memory_resource*>) {
+        return std::allocate_shared<T>(alloc, std::forward<Args>(args)..., resource);
+    } else {
+        return std::allocate_shared<T>(alloc, std::forward<Args>(args)...);
+    }
+}
+
 /**
  * An abstract base of all columns classes.
  */
 class Column : public std::enable_shared_from_this<Column>
 {
 public:
-    explicit inline Column(TypeRef type)
+    explicit inline Column(TypeRef type, std::pmr::memory_resource* resource = std::pmr::get_default_resource())
         : type_(type)
+        , resource_(resource)
     {
     }
 
@@ -37,12 +58,24 @@ public:
     /// Get type object of the column.
     inline TypeRef Type() const { return type_; }
 
+    /// Memory resource which provides storage of the column.
+    inline std::pmr::memory_resource* GetMemoryResource() const { return resource_; }
+
     /// Appends content of given column to the end of current one.
     virtual void Append(ColumnRef column) = 0;
 
+    /// Loads column prefix from input stream.
+    /// In the native format prefixes of a column and all its nested
+    /// columns precede the data (e.g. LowCardinality keeps its
+    /// serialization version there).
+    virtual bool LoadPrefix(CodedInputStream*, size_t) { return true; }
+
     /// Loads column data from input stream.
     virtual bool Load(CodedInputStream* input, size_t rows) = 0;
 
+    /// Saves column prefix to output stream.
+    virtual void SavePrefix(CodedOutputStream*) { }
+
     /// Saves column data to output stream.
     virtual void Save(CodedOutputStream* output) = 0;
 
@@ -55,8 +88,48 @@ public:
     /// Makes slice of the current column.
     virtual ColumnRef Slice(size_t begin, size_t len) = 0;
 
+    /// Makes column of the rows for which mask has nonzero bytes.
+    /// The mask holds one byte per row.
+    virtual ColumnRef Filter(const uint8_t* mask) const = 0;
+
+    /// Makes column of the rows at given positions, in that order.
+    /// Positions may repeat.  Throws std::out_of_range if a position
+    /// is not less than Size().
+    virtual ColumnRef Take(const uint32_t* indices, size_t count) const = 0;
+
+    /// Makes column of all rows reordered so that row i of the result
+    /// is row permutation[i] of the current column.
+    inline ColumnRef Permute(const uint32_t* permutation) const {
+        return Take(permutation, Size());
+    }
+
+    /// Returns count of bytes of memory held by the column data,
+    /// including reserved capacity and nested columns.
+    virtual size_t MemoryUsage() const = 0;
+
+    /// Preallocates memory for given total count of rows, so appending
+    /// up to that count doesn't reallocate.
+    virtual void Reserve(size_t rows) = 0;
+
+    /// Releases memory reserved beyond the current content.
+    virtual void ShrinkToFit() = 0;
+
+    /// Returns true if columns nested into this one are not referenced
+    /// from outside of it, so clearing or refilling the column is not
+    /// observed through other references.  References to the column
+    /// itself are for the caller to check.
+    virtual bool IsExclusivelyOwned() const { return true; }
+
 protected:
+    /// Returns true if the nested column has at most given count of
+    /// references and is exclusively owned itself.
+    template <typename T>
+    static bool IsNestedOwned(const std::shared_ptr<T>& nested, long references = 1) {
+        return nested.use_count() <= references && nested->IsExclusivelyOwned();
+    }
+
     TypeRef type_;
+    std::pmr::memory_resource* resource_;
 };
 
 }
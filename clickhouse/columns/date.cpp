@@ -1,10 +1,122 @@
 #include "date.h"
 
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   include <emmintrin.h>
+#   define CLICKHOUSE_DATE_SSE2
+#endif
+
 namespace clickhouse {
+namespace {
+
+constexpr int64_t kNanosPerSecond = 1000000000;
+constexpr int64_t kNanosPerDay = 86400 * kNanosPerSecond;
+
+void CheckRows(size_t size, size_t begin, size_t count) {
+    if (begin > size || count > size - begin) {
+        throw std::out_of_range("rows are out of range: " + std::to_string(begin) + "+" + std::to_string(count));
+    }
+}
+
+#if defined(CLICKHOUSE_DATE_SSE2)
+/// Stores four unsigned 32-bit lanes of v multiplied by factor, plus bias,
+/// as 64-bit integers.  Arithmetic wraps modulo 2^64.
+inline void MulAdd4(__m128i v, __m128i factor_lo, __m128i factor_hi, __m128i bias, int64_t* out) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i halves[2] = {_mm_unpacklo_epi32(v, zero), _mm_unpackhi_epi32(v, zero)};
+
+    for (size_t i = 0; i < 2; ++i) {
+        const __m128i lo = _mm_mul_epu32(halves[i], factor_lo);
+        const __m128i hi = _mm_slli_epi64(_mm_mul_epu32(halves[i], factor_hi), 32);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 2), _mm_add_epi64(_mm_add_epi64(lo, hi), bias));
+    }
+}
+#endif
+
+/// Returns value * factor for positive factor, saturated to the range
+/// of int64_t.
+inline int64_t MulSaturate(int64_t value, int64_t factor) {
+    if (value > std::numeric_limits<int64_t>::max() / factor) {
+        return std::numeric_limits<int64_t>::max();
+    }
+    if (value < std::numeric_limits<int64_t>::min() / factor) {
+        return std::numeric_limits<int64_t>::min();
+    }
+    return value * factor;
+}
+
+/// Computes out[i] = in[i] * factor for days or seconds, saturating on overflow.
+template <typename T>
+void Scale(const T* in, size_t count, int64_t factor, int64_t* out) {
+    static_assert(sizeof(T) <= 4, "only 16- and 32-bit values are supported");
+    size_t i = 0;
+
+#if defined(CLICKHOUSE_DATE_SSE2)
+    // Products of values within the limits fit into int64_t.
+    const int64_t max_value = std::numeric_limits<int64_t>::max() / factor;
+    const int64_t min_value = std::numeric_limits<int64_t>::min() / factor;
+    const bool exact = std::numeric_limits<T>::max() <= max_value && std::numeric_limits<T>::lowest() >= min_value;
+    const __m128i factor_lo = _mm_set1_epi64x(static_cast<int64_t>(static_cast<uint64_t>(factor) & 0xFFFFFFFF));
+    const __m128i factor_hi = _mm_set1_epi64x(static_cast<int64_t>(static_cast<uint64_t>(factor) >> 32));
+
+    if constexpr (sizeof(T) == 2) {
+        const __m128i zero = _mm_setzero_si128();
+        for (; exact && i + 8 <= count; i += 8) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+            MulAdd4(_mm_unpacklo_epi16(v, zero), factor_lo, factor_hi, zero, out + i);
+            MulAdd4(_mm_unpackhi_epi16(v, zero), factor_lo, factor_hi, zero, out + i + 4);
+        }
+    } else if (exact || std::is_signed<T>::value) {
+        // Signed values are biased by 2^31 to make them unsigned, the bias
+        // is subtracted back from the products.
+        const bool is_signed = std::is_signed<T>::value;
+        const __m128i flip = _mm_set1_epi32(is_signed ? static_cast<int32_t>(0x80000000u) : 0);
+        const __m128i bias = _mm_set1_epi64x(is_signed ? static_cast<int64_t>(0 - (uint64_t(1) << 31) * static_cast<uint64_t>(factor)) : 0);
+        // Groups with signed values beyond the limits are left to the
+        // saturating code.
+        const __m128i upper = _mm_set1_epi32(static_cast<int32_t>(std::min<int64_t>(max_value, std::numeric_limits<int32_t>::max())));
+        const __m128i lower = _mm_set1_epi32(static_cast<int32_t>(std::max<int64_t>(min_value, std::numeric_limits<int32_t>::min())));
+        for (; i + 4 <= count; i += 4) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+            if (is_signed && _mm_movemask_epi8(_mm_or_si128(_mm_cmpgt_epi32(v, upper), _mm_cmplt_epi32(v, lower)))) {
+                for (size_t j = i; j < i + 4; ++j) {
+                    out[j] = MulSaturate(static_cast<int64_t>(in[j]), factor);
+                }
+                continue;
+            }
+            MulAdd4(_mm_xor_si128(v, flip), factor_lo, factor_hi, bias, out + i);
+        }
+    }
+#endif
+    for (; i < count; ++i) {
+        out[i] = MulSaturate(static_cast<int64_t>(in[i]), factor);
+    }
+}
 
-ColumnDate::ColumnDate()
-    : Column(Type::CreateDate())
-    , data_(std::make_shared<ColumnUInt16>())
+/// Converts rows through GetUnixNanos in chunks.
+template <typename ColumnType>
+void ToTimePoints(const ColumnType& column, size_t begin, size_t count, TimePoint* out) {
+    int64_t nanos[256];
+
+    for (size_t i = 0; i < count; ) {
+        const size_t n = std::min(count - i, sizeof(nanos) / sizeof(nanos[0]));
+        column.GetUnixNanos(begin + i, n, nanos);
+        for (size_t j = 0; j < n; ++j) {
+            out[i + j] = TimePoint(std::chrono::nanoseconds(nanos[j]));
+        }
+        i += n;
+    }
+}
+
+}
+
+ColumnDate::ColumnDate(std::pmr::memory_resource* resource)
+    : Column(Type::CreateDate(), resource)
+    , data_(MakeColumn<ColumnUInt16>(resource))
 {
 }
 
@@ -20,6 +132,15 @@ std::time_t ColumnDate::At(size_t n) const {
     return static_cast<std::time_t>(data_->At(n)) * 86400;
 }
 
+void ColumnDate::GetUnixNanos(size_t begin, size_t count, int64_t* out) const {
+    CheckRows(Size(), begin, count);
+    Scale(data_->GetData().data() + begin, count, kNanosPerDay, out);
+}
+
+void ColumnDate::GetTimePoints(size_t begin, size_t count, TimePoint* out) const {
+    ToTimePoints(*this, begin, count, out);
+}
+
 void ColumnDate::Append(ColumnRef column) {
     if (auto col = column->As<ColumnDate>()) {
         data_->Append(col->data_);
@@ -40,23 +161,133 @@ size_t ColumnDate::Size() const {
 
 ColumnRef ColumnDate::Slice(size_t begin, size_t len) {
     auto col = data_->Slice(begin, len)->As<ColumnUInt16>();
-    auto result = std::make_shared<ColumnDate>();
+    auto result = MakeColumn<ColumnDate>(resource_);
 
     result->data_->Append(col);
 
     return result;
 }
 
+ColumnRef ColumnDate::Filter(const uint8_t* mask) const {
+    auto result = MakeColumn<ColumnDate>(resource_);
+    result->data_ = data_->Filter(mask)->As<ColumnUInt16>();
+    return result;
+}
+
+ColumnRef ColumnDate::Take(const uint32_t* indices, size_t count) const {
+    auto result = MakeColumn<ColumnDate>(resource_);
+    result->data_ = data_->Take(indices, count)->As<ColumnUInt16>();
+    return result;
+}
+
+size_t ColumnDate::MemoryUsage() const {
+    return data_->MemoryUsage();
+}
+
+void ColumnDate::Reserve(size_t rows) {
+    data_->Reserve(rows);
+}
+
+void ColumnDate::ShrinkToFit() {
+    data_->ShrinkToFit();
+}
+
+bool ColumnDate::IsExclusivelyOwned() const {
+    return IsNestedOwned(data_);
+}
+
+ColumnDate32::ColumnDate32(std::pmr::memory_resource* resource)
+    : Column(Type::CreateDate32(), resource)
+    , data_(MakeColumn<ColumnInt32>(resource))
+{
+}
+
+void ColumnDate32::Append(const std::time_t& value) {
+    // Round down, so times before epoch map to the day they belong to.
+    data_->Append(static_cast<int32_t>(value / 86400 - (value % 86400 < 0)));
+}
+
+void ColumnDate32::Clear() {
+    data_->Clear();
+}
+
+std::time_t ColumnDate32::At(size_t n) const {
+    return static_cast<std::time_t>(data_->At(n)) * 86400;
+}
+
+void ColumnDate32::GetUnixNanos(size_t begin, size_t count, int64_t* out) const {
+    CheckRows(Size(), begin, count);
+    Scale(data_->GetData().data() + begin, count, kNanosPerDay, out);
+}
+
+void ColumnDate32::GetTimePoints(size_t begin, size_t count, TimePoint* out) const {
+    ToTimePoints(*this, begin, count, out);
+}
+
+void ColumnDate32::Append(ColumnRef column) {
+    if (auto col = column->As<ColumnDate32>()) {
+        data_->Append(col->data_);
+    }
+}
+
+bool ColumnDate32::Load(CodedInputStream* input, size_t rows) {
+    return data_->Load(input, rows);
+}
+
+void ColumnDate32::Save(CodedOutputStream* output) {
+    data_->Save(output);
+}
+
+size_t ColumnDate32::Size() const {
+    return data_->Size();
+}
+
+ColumnRef ColumnDate32::Slice(size_t begin, size_t len) {
+    auto result = MakeColumn<ColumnDate32>(resource_);
+
+    result->data_->Append(data_->Slice(begin, len));
+
+    return result;
+}
+
+ColumnRef ColumnDate32::Filter(const uint8_t* mask) const {
+    auto result = MakeColumn<ColumnDate32>(resource_);
+    result->data_ = data_->Filter(mask)->As<ColumnInt32>();
+    return result;
+}
+
+ColumnRef ColumnDate32::Take(const uint32_t* indices, size_t count) const {
+    auto result = MakeColumn<ColumnDate32>(resource_);
+    result->data_ = data_->Take(indices, count)->As<ColumnInt32>();
+    return result;
+}
+
+size_t ColumnDate32::MemoryUsage() const {
+    return data_->MemoryUsage();
+}
+
+void ColumnDate32::Reserve(size_t rows) {
+    data_->Reserve(rows);
+}
+
+void ColumnDate32::ShrinkToFit() {
+    data_->ShrinkToFit();
+}
+
+bool ColumnDate32::IsExclusivelyOwned() const {
+    return IsNestedOwned(data_);
+}
+
 
-ColumnDateTime::ColumnDateTime()
-    : Column(Type::CreateDateTime())
-    , data_(std::make_shared<ColumnUInt32>())
+ColumnDateTime::ColumnDateTime(std::pmr::memory_resource* resource)
+    : Column(Type::CreateDateTime(), resource)
+    , data_(MakeColumn<ColumnUInt32>(resource))
 {
 }
 
-ColumnDateTime::ColumnDateTime(std::string timezone)
-    : Column(Type::CreateDateTime(std::move(timezone)))
-    , data_(std::make_shared<ColumnUInt32>())
+ColumnDateTime::ColumnDateTime(std::string timezone, std::pmr::memory_resource* resource)
+    : Column(Type::CreateDateTime(std::move(timezone)), resource)
+    , data_(MakeColumn<ColumnUInt32>(resource))
 {
 }
 
@@ -72,6 +303,20 @@ std::string ColumnDateTime::Timezone() const {
     return DateTimeType(type_).Timezone();
 }
 
+void ColumnDateTime::GetUnixNanos(size_t begin, size_t count, int64_t* out) const {
+    CheckRows(Size(), begin, count);
+    Scale(data_->GetData().data() + begin, count, kNanosPerSecond, out);
+}
+
+void ColumnDateTime::GetLocalUnixNanos(size_t begin, size_t count, int64_t* out, const TimeZone& zone) const {
+    GetUnixNanos(begin, count, out);
+    zone.ToLocalNanos(out, count);
+}
+
+void ColumnDateTime::GetTimePoints(size_t begin, size_t count, TimePoint* out) const {
+    ToTimePoints(*this, begin, count, out);
+}
+
 void ColumnDateTime::Append(ColumnRef column) {
     if (auto col = column->As<ColumnDateTime>()) {
         data_->Append(col->data_);
@@ -95,30 +340,55 @@ void ColumnDateTime::Clear() {
 }
 
 ColumnRef ColumnDateTime::Slice(size_t begin, size_t len) {
-    auto col = data_->Slice(begin, len)->As<ColumnUInt32>();
-    auto result = std::make_shared<ColumnDateTime>();
+    auto result = MakeColumn<ColumnDateTime>(resource_);
+    // Keeps the time zone of the type.
+    result->type_ = type_;
+    result->data_ = data_->Slice(begin, len)->As<ColumnUInt32>();
+    return result;
+}
 
-    result->data_->Append(col);
+ColumnRef ColumnDateTime::Filter(const uint8_t* mask) const {
+    auto result = MakeColumn<ColumnDateTime>(resource_);
+    // Keeps the time zone of the type.
+    result->type_ = type_;
+    result->data_ = data_->Filter(mask)->As<ColumnUInt32>();
+    return result;
+}
 
+ColumnRef ColumnDateTime::Take(const uint32_t* indices, size_t count) const {
+    auto result = MakeColumn<ColumnDateTime>(resource_);
+    // Keeps the time zone of the type.
+    result->type_ = type_;
+    result->data_ = data_->Take(indices, count)->As<ColumnUInt32>();
     return result;
 }
 
+size_t ColumnDateTime::MemoryUsage() const {
+    return data_->MemoryUsage();
+}
+
+void ColumnDateTime::Reserve(size_t rows) {
+    data_->Reserve(rows);
+}
 
-ColumnDateTime64::ColumnDateTime64(size_t precision)
-    : Column(Type::CreateDateTime64(precision))
-    , data_(std::make_shared<ColumnUInt64>())
-{
+void ColumnDateTime::ShrinkToFit() {
+    data_->ShrinkToFit();
+}
+
+bool ColumnDateTime::IsExclusivelyOwned() const {
+    return IsNestedOwned(data_);
 }
 
-ColumnDateTime64::ColumnDateTime64(size_t precision, std::string timezone)
-    : Column(Type::CreateDateTime64(precision, std::move(timezone)))
-    , data_(std::make_shared<ColumnUInt64>())
+
+ColumnDateTime64::ColumnDateTime64(size_t precision, std::pmr::memory_resource* resource)
+    : Column(Type::CreateDateTime64(precision), resource)
+    , data_(MakeColumn<ColumnUInt64>(resource))
 {
 }
 
-ColumnDateTime64::ColumnDateTime64(TypeRef type, std::shared_ptr<ColumnUInt64> data)
-    : Column(type)
-    , data_(std::move(data))
+ColumnDateTime64::ColumnDateTime64(size_t precision, std::string timezone, std::pmr::memory_resource* resource)
+    : Column(Type::CreateDateTime64(precision, std::move(timezone)), resource)
+    , data_(MakeColumn<ColumnUInt64>(resource))
 {
 }
 
@@ -134,6 +404,46 @@ std::string ColumnDateTime64::Timezone() const {
     return DateTimeType(type_).Timezone();
 }
 
+size_t ColumnDateTime64::GetPrecision() const {
+    return DateTimeType(type_).Precision();
+}
+
+void ColumnDateTime64::GetUnixNanos(size_t begin, size_t count, int64_t* out) const {
+    CheckRows(Size(), begin, count);
+
+    // Ticks are signed in the native format.
+    const uint64_t* ticks = data_->GetData().data() + begin;
+    const size_t precision = GetPrecision();
+
+    if (precision <= 9) {
+        int64_t factor = 1;
+        for (size_t i = precision; i < 9; ++i) {
+            factor *= 10;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = MulSaturate(static_cast<int64_t>(ticks[i]), factor);
+        }
+    } else {
+        int64_t divisor = 1;
+        for (size_t i = 9; i < precision; ++i) {
+            divisor *= 10;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            const int64_t value = static_cast<int64_t>(ticks[i]);
+            out[i] = value / divisor - (value % divisor < 0);
+        }
+    }
+}
+
+void ColumnDateTime64::GetLocalUnixNanos(size_t begin, size_t count, int64_t* out, const TimeZone& zone) const {
+    GetUnixNanos(begin, count, out);
+    zone.ToLocalNanos(out, count);
+}
+
+void ColumnDateTime64::GetTimePoints(size_t begin, size_t count, TimePoint* out) const {
+    ToTimePoints(*this, begin, count, out);
+}
+
 void ColumnDateTime64::Append(ColumnRef column) {
     if (auto col = column->As<ColumnDateTime64>()) {
         data_->Append(col->data_);
@@ -157,9 +467,43 @@ void ColumnDateTime64::Clear() {
 }
 
 ColumnRef ColumnDateTime64::Slice(size_t begin, size_t len) {
-    auto col = data_->Slice(begin, len)->As<ColumnUInt64>();
-    std::shared_ptr<ColumnDateTime64> result(new ColumnDateTime64(type_, std::move(col)));
+    auto result = MakeColumn<ColumnDateTime64>(resource_, GetPrecision());
+    // Keeps the time zone of the type.
+    result->type_ = type_;
+    result->data_ = data_->Slice(begin, len)->As<ColumnUInt64>();
+    return result;
+}
+
+ColumnRef ColumnDateTime64::Filter(const uint8_t* mask) const {
+    auto result = MakeColumn<ColumnDateTime64>(resource_, GetPrecision());
+    // Keeps the time zone of the type.
+    result->type_ = type_;
+    result->data_ = data_->Filter(mask)->As<ColumnUInt64>();
     return result;
 }
 
+ColumnRef ColumnDateTime64::Take(const uint32_t* indices, size_t count) const {
+    auto result = MakeColumn<ColumnDateTime64>(resource_, GetPrecision());
+    // Keeps the time zone of the type.
+    result->type_ = type_;
+    result->data_ = data_->Take(indices, count)->As<ColumnUInt64>();
+    return result;
+}
+
+size_t ColumnDateTime64::MemoryUsage() const {
+    return data_->MemoryUsage();
+}
+
+void ColumnDateTime64::Reserve(size_t rows) {
+    data_->Reserve(rows);
+}
+
+void ColumnDateTime64::ShrinkToFit() {
+    data_->ShrinkToFit();
+}
+
+bool ColumnDateTime64::IsExclusivelyOwned() const {
+    return IsNestedOwned(data_);
+}
+
 }
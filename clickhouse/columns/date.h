@@ -1,15 +1,22 @@
 #pragma once
 
 #include "numeric.h"
+#include "../base/timezone.h"
 
+#include <chrono>
 #include <ctime>
 
 namespace clickhouse {
 
+/// Point in time with nanosecond resolution, produced by bulk conversions.
+/// Nanoseconds since epoch in int64_t cover 1677-09-21 to 2262-04-11,
+/// conversions of values beyond that saturate to the limits of int64_t.
+using TimePoint = std::chrono::time_point<std::chrono::system_clock, std::chrono::nanoseconds>;
+
 /** */
 class ColumnDate : public Column {
 public:
-    ColumnDate();
+    explicit ColumnDate(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 
     /// Appends one element to the end of column.
     void Append(const std::time_t& value);
@@ -17,6 +24,12 @@ public:
     /// Returns element at given row number.
     std::time_t At(size_t n) const;
 
+    /// Converts rows [begin, begin + count) to nanoseconds since epoch.
+    void GetUnixNanos(size_t begin, size_t count, int64_t* out) const;
+
+    /// Converts rows [begin, begin + count) to time points.
+    void GetTimePoints(size_t begin, size_t count, TimePoint* out) const;
+
 public:
     /// Appends content of given column to the end of current one.
     void Append(ColumnRef column) override;
@@ -36,15 +49,92 @@ public:
     /// Makes slice of the current column.
     ColumnRef Slice(size_t begin, size_t len) override;
 
+    /// Makes column of the rows selected by the mask.
+    ColumnRef Filter(const uint8_t* mask) const override;
+
+    /// Makes column of the rows at given positions.
+    ColumnRef Take(const uint32_t* indices, size_t count) const override;
+
+    /// Returns count of bytes of memory held by the column data.
+    size_t MemoryUsage() const override;
+
+    /// Preallocates memory for given total count of rows.
+    void Reserve(size_t rows) override;
+
+    /// Releases memory reserved beyond the current content.
+    void ShrinkToFit() override;
+
+    /// Returns true if nested columns are not referenced from outside.
+    bool IsExclusivelyOwned() const override;
+
 private:
     std::shared_ptr<ColumnUInt16> data_;
 };
 
+/** Represents column of Date32, days since epoch which may be negative. */
+class ColumnDate32 : public Column {
+public:
+    explicit ColumnDate32(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    /// Appends one element to the end of column.
+    void Append(const std::time_t& value);
+
+    /// Returns element at given row number.
+    std::time_t At(size_t n) const;
+
+    /// Converts rows [begin, begin + count) to nanoseconds since epoch.
+    /// Days beyond 2262-04-11 (or before 1677-09-21) saturate.
+    void GetUnixNanos(size_t begin, size_t count, int64_t* out) const;
+
+    /// Converts rows [begin, begin + count) to time points.
+    void GetTimePoints(size_t begin, size_t count, TimePoint* out) const;
+
+public:
+    /// Appends content of given column to the end of current one.
+    void Append(ColumnRef column) override;
+
+    /// Loads column data from input stream.
+    bool Load(CodedInputStream* input, size_t rows) override;
+
+    /// Saves column data to output stream.
+    void Save(CodedOutputStream* output) override;
+
+    /// Clear column data .
+    void Clear() override;
+
+    /// Returns count of rows in the column.
+    size_t Size() const override;
+
+    /// Makes slice of the current column.
+    ColumnRef Slice(size_t begin, size_t len) override;
+
+    /// Makes column of the rows selected by the mask.
+    ColumnRef Filter(const uint8_t* mask) const override;
+
+    /// Makes column of the rows at given positions.
+    ColumnRef Take(const uint32_t* indices, size_t count) const override;
+
+    /// Returns count of bytes of memory held by the column data.
+    size_t MemoryUsage() const override;
+
+    /// Preallocates memory for given total count of rows.
+    void Reserve(size_t rows) override;
+
+    /// Releases memory reserved beyond the current content.
+    void ShrinkToFit() override;
+
+    /// Returns true if nested columns are not referenced from outside.
+    bool IsExclusivelyOwned() const override;
+
+private:
+    std::shared_ptr<ColumnInt32> data_;
+};
+
 /** */
 class ColumnDateTime : public Column {
 public:
-    ColumnDateTime();
-    explicit ColumnDateTime(std::string timezone);
+    explicit ColumnDateTime(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+    explicit ColumnDateTime(std::string timezone, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 
     /// Appends one element to the end of column.
     void Append(const std::time_t& value);
@@ -55,6 +145,16 @@ public:
     /// Timezone associated with a data column.
     std::string Timezone() const;
 
+    /// Converts rows [begin, begin + count) to nanoseconds since epoch.
+    void GetUnixNanos(size_t begin, size_t count, int64_t* out) const;
+
+    /// Converts rows [begin, begin + count) to nanoseconds since epoch
+    /// of the wall clock time in given zone.
+    void GetLocalUnixNanos(size_t begin, size_t count, int64_t* out, const TimeZone& zone) const;
+
+    /// Converts rows [begin, begin + count) to time points.
+    void GetTimePoints(size_t begin, size_t count, TimePoint* out) const;
+
 public:
     /// Appends content of given column to the end of current one.
     void Append(ColumnRef column) override;
@@ -74,6 +174,24 @@ public:
     /// Makes slice of the current column.
     ColumnRef Slice(size_t begin, size_t len) override;
 
+    /// Makes column of the rows selected by the mask.
+    ColumnRef Filter(const uint8_t* mask) const override;
+
+    /// Makes column of the rows at given positions.
+    ColumnRef Take(const uint32_t* indices, size_t count) const override;
+
+    /// Returns count of bytes of memory held by the column data.
+    size_t MemoryUsage() const override;
+
+    /// Preallocates memory for given total count of rows.
+    void Reserve(size_t rows) override;
+
+    /// Releases memory reserved beyond the current content.
+    void ShrinkToFit() override;
+
+    /// Returns true if nested columns are not referenced from outside.
+    bool IsExclusivelyOwned() const override;
+
 private:
     std::shared_ptr<ColumnUInt32> data_;
 };
@@ -81,8 +199,8 @@ private:
 /** */
 class ColumnDateTime64 : public Column {
 public:
-    explicit ColumnDateTime64(size_t precision);
-    ColumnDateTime64(size_t precision, std::string timezone);
+    explicit ColumnDateTime64(size_t precision, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+    ColumnDateTime64(size_t precision, std::string timezone, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 
     /// Appends one element to the end of column.
     void Append(const uint64_t& value);
@@ -93,6 +211,21 @@ public:
     /// Timezone associated with a data column.
     std::string Timezone() const;
 
+    /// Count of fractional second digits of the values.
+    size_t GetPrecision() const;
+
+    /// Converts rows [begin, begin + count) to nanoseconds since epoch,
+    /// scaling ticks by the precision.  Values beyond 2262-04-11 (or
+    /// before 1677-09-21) saturate.
+    void GetUnixNanos(size_t begin, size_t count, int64_t* out) const;
+
+    /// Converts rows [begin, begin + count) to nanoseconds since epoch
+    /// of the wall clock time in given zone.
+    void GetLocalUnixNanos(size_t begin, size_t count, int64_t* out, const TimeZone& zone) const;
+
+    /// Converts rows [begin, begin + count) to time points.
+    void GetTimePoints(size_t begin, size_t count, TimePoint* out) const;
+
 public:
     /// Appends content of given column to the end of current one.
     void Append(ColumnRef column) override;
@@ -112,10 +245,26 @@ public:
     /// Makes slice of the current column.
     ColumnRef Slice(size_t begin, size_t len) override;
 
+    /// Makes column of the rows selected by the mask.
+    ColumnRef Filter(const uint8_t* mask) const override;
+
+    /// Makes column of the rows at given positions.
+    ColumnRef Take(const uint32_t* indices, size_t count) const override;
+
+    /// Returns count of bytes of memory held by the column data.
+    size_t MemoryUsage() const override;
+
+    /// Preallocates memory for given total count of rows.
+    void Reserve(size_t rows) override;
+
+    /// Releases memory reserved beyond the current content.
+    void ShrinkToFit() override;
+
+    /// Returns true if nested columns are not referenced from outside.
+    bool IsExclusivelyOwned() const override;
+
 private:
     std::shared_ptr<ColumnUInt64> data_;
-
-    explicit ColumnDateTime64(TypeRef type, std::shared_ptr<ColumnUInt64> data); // for `Slice(…)`
 };
 
 }
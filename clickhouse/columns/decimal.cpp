@@ -1,72 +1,424 @@
 #include "decimal.h"
 
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+
 namespace clickhouse {
+namespace {
+
+constexpr uint64_t kPow10[20] = {
+    1ull,
+    10ull,
+    100ull,
+    1000ull,
+    10000ull,
+    100000ull,
+    1000000ull,
+    10000000ull,
+    100000000ull,
+    1000000000ull,
+    10000000000ull,
+    100000000000ull,
+    1000000000000ull,
+    10000000000000ull,
+    100000000000000ull,
+    1000000000000000ull,
+    10000000000000000ull,
+    100000000000000000ull,
+    1000000000000000000ull,
+    10000000000000000000ull,
+};
+
+/// Count of decimal digits which always fit into uint64_t.
+constexpr size_t kChunkDigits = 19;
+
+inline void MulAdd(uint64_t& value, uint64_t mul, uint64_t add) {
+    value = value * mul + add;
+}
+
+inline void MulAdd(absl::uint128& value, uint64_t mul, uint64_t add) {
+    value = value * mul + add;
+}
+
+inline void MulAdd(UInt256& value, uint64_t mul, uint64_t add) {
+    value.MulAdd(mul, add);
+}
+
+inline uint64_t DivMod(uint64_t& value, uint64_t divisor) {
+    const uint64_t remainder = value % divisor;
+    value /= divisor;
+    return remainder;
+}
+
+inline uint64_t DivMod(absl::uint128& value, uint64_t divisor) {
+    const uint64_t remainder = absl::Uint128Low64(value % divisor);
+    value /= divisor;
+    return remainder;
+}
+
+inline uint64_t DivMod(UInt256& value, uint64_t divisor) {
+    return value.DivMod(divisor);
+}
+
+inline bool IsZero(uint64_t value) {
+    return value == 0;
+}
+
+inline bool IsZero(absl::uint128 value) {
+    return value == 0;
+}
+
+inline bool IsZero(const UInt256& value) {
+    return value.IsZero();
+}
+
+inline bool IsDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+#if !(defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+/// Converts eight ASCII digits to a number with a few multiplications.
+inline uint32_t ParseEightDigits(const char* p) {
+    uint64_t value;
+    memcpy(&value, p, sizeof(value));
+    value = ((value & 0x0F0F0F0F0F0F0F0Full) * 2561) >> 8;
+    value = ((value & 0x00FF00FF00FF00FFull) * 6553601) >> 16;
+    return static_cast<uint32_t>(((value & 0x0000FFFF0000FFFFull) * 42949672960001ull) >> 32);
+}
+#   define CLICKHOUSE_DECIMAL_SWAR
+#endif
+
+/// Accumulates digits in 64-bit chunks, so a wide value is updated once
+/// per up to 19 digits.
+template <typename U>
+class DigitAccumulator {
+public:
+    /// Appends a run of validated digits.
+    void Digits(const char* p, size_t count) {
+        while (count) {
+#if defined(CLICKHOUSE_DECIMAL_SWAR)
+            if (count >= 8 && chunk_digits_ + 8 <= kChunkDigits) {
+                chunk_ = chunk_ * kPow10[8] + ParseEightDigits(p);
+                chunk_digits_ += 8;
+                p += 8;
+                count -= 8;
+            } else
+#endif
+            {
+                chunk_ = chunk_ * 10 + static_cast<uint64_t>(*p - '0');
+                ++chunk_digits_;
+                ++p;
+                --count;
+            }
+            if (chunk_digits_ == kChunkDigits) {
+                Flush();
+            }
+        }
+    }
+
+    /// Appends given count of zero digits.
+    void Zeros(size_t count) {
+        while (count) {
+            const size_t n = std::min(count, kChunkDigits - chunk_digits_);
+            chunk_ *= kPow10[n];
+            chunk_digits_ += n;
+            count -= n;
+            if (chunk_digits_ == kChunkDigits) {
+                Flush();
+            }
+        }
+    }
+
+    U Finish() {
+        Flush();
+        return value_;
+    }
+
+private:
+    void Flush() {
+        if (chunk_digits_) {
+            MulAdd(value_, kPow10[chunk_digits_], chunk_);
+            chunk_ = 0;
+            chunk_digits_ = 0;
+        }
+    }
+
+private:
+    U value_ = U();
+    uint64_t chunk_ = 0;
+    size_t chunk_digits_ = 0;
+};
+
+/// Parses decimal string into magnitude of the unscaled value.
+template <typename U>
+U ParseDecimal(std::string_view str, size_t precision, size_t scale, bool* negative) {
+    size_t i = 0;
+
+    *negative = false;
+    if (i < str.size() && (str[i] == '-' || str[i] == '+')) {
+        *negative = str[i] == '-';
+        ++i;
+    }
+
+    const size_t int_begin = i;
+    while (i < str.size() && IsDigit(str[i])) {
+        ++i;
+    }
+    const size_t int_end = i;
+
+    size_t frac_begin = i;
+    size_t frac_end = i;
+    if (i < str.size() && str[i] == '.') {
+        frac_begin = ++i;
+        while (i < str.size() && IsDigit(str[i])) {
+            ++i;
+        }
+        frac_end = i;
+    }
+
+    if (i != str.size() || (int_begin == int_end && frac_begin == frac_end)) {
+        throw std::runtime_error("invalid decimal value: '" + std::string(str) + "'");
+    }
+
+    size_t first = int_begin;
+    while (first < int_end && str[first] == '0') {
+        ++first;
+    }
+
+    const size_t int_digits = int_end - first;
+    if (int_digits + scale > precision) {
+        throw std::runtime_error("decimal value is out of range: '" + std::string(str) + "'");
+    }
+
+    const size_t frac_digits = std::min(frac_end - frac_begin, scale);
+    DigitAccumulator<U> acc;
+    acc.Digits(str.data() + first, int_digits);
+    acc.Digits(str.data() + frac_begin, frac_digits);
+    acc.Zeros(scale - frac_digits);
+
+    return acc.Finish();
+}
+
+/// Formats magnitude of the unscaled value as decimal string.
+template <typename U>
+std::string FormatDecimal(U magnitude, bool negative, size_t scale) {
+    char buffer[96];
+    char* const end = buffer + sizeof(buffer);
+    char* p = end;
+
+    do {
+        uint64_t chunk = DivMod(magnitude, kPow10[kChunkDigits]);
+        const bool last = IsZero(magnitude);
+        // All chunks except the most significant one are zero padded.
+        for (size_t i = 0; i < kChunkDigits && (!last || chunk != 0 || p == end); ++i) {
+            *--p = static_cast<char>('0' + chunk % 10);
+            chunk /= 10;
+        }
+    } while (!IsZero(magnitude));
+
+    while (size_t(end - p) <= scale) {
+        *--p = '0';
+    }
 
-ColumnDecimal::ColumnDecimal(size_t precision, size_t scale)
-    : Column(Type::CreateDecimal(precision, scale))
+    std::string result;
+    result.reserve(end - p + 2);
+    if (negative) {
+        result += '-';
+    }
+    result.append(p, end - scale);
+    if (scale) {
+        result += '.';
+        result.append(end - scale, end);
+    }
+    return result;
+}
+
+/// Converts between unscaled values of different widths, truncating.
+template <typename To, typename From>
+inline To ConvertValue(const From& value) {
+    return static_cast<To>(value);
+}
+
+template <typename C, typename T>
+void AppendValues(C& column, const T* values, size_t count) {
+    using DataType = typename C::DataType;
+
+    if constexpr (std::is_same<DataType, T>::value) {
+        column.Append(values, values + count);
+    } else {
+        for (size_t i = 0; i < count; ++i) {
+            column.Append(ConvertValue<DataType>(values[i]));
+        }
+    }
+}
+
+template <typename C, typename T>
+void GetValues(const C& column, size_t begin, size_t count, T* out) {
+    if (begin > column.Size() || count > column.Size() - begin) {
+        throw std::out_of_range("rows are out of range: " + std::to_string(begin) + "+" + std::to_string(count));
+    }
+
+    const auto* data = column.GetData().data() + begin;
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = ConvertValue<T>(data[i]);
+    }
+}
+
+}
+
+ColumnDecimal::ColumnDecimal(size_t precision, size_t scale, std::pmr::memory_resource* resource)
+    : Column(Type::CreateDecimal(precision, scale), resource)
+    , precision_(precision)
+    , scale_(scale)
 {
     if (precision <= 9) {
-        data_ = std::make_shared<ColumnInt32>();
+        data_ = MakeColumn<ColumnInt32>(resource);
     } else if (precision <= 18) {
-        data_ = std::make_shared<ColumnInt64>();
+        data_ = MakeColumn<ColumnInt64>(resource);
+    } else if (precision <= 38) {
+        data_ = MakeColumn<ColumnInt128>(resource);
     } else {
-        data_ = std::make_shared<ColumnInt128>();
+        data_ = MakeColumn<ColumnInt256>(resource);
     }
+    storage_ = data_->Type()->GetCode();
 }
 
-ColumnDecimal::ColumnDecimal(TypeRef type)
-    : Column(type)
-{
+void ColumnDecimal::Append(const Int128& value) {
+    AppendMany(&value, 1);
 }
 
-void ColumnDecimal::Append(const Int128& value) {
-    if (data_->Type()->GetCode() == Type::Int32) {
-        data_->As<ColumnInt32>()->Append(static_cast<ColumnInt32::DataType>(value));
-    } else if (data_->Type()->GetCode() == Type::Int64) {
-        data_->As<ColumnInt64>()->Append(static_cast<ColumnInt64::DataType>(value));
-    } else {
-        data_->As<ColumnInt128>()->Append(static_cast<ColumnInt128::DataType>(value));
-    }
+void ColumnDecimal::Append(const Int256& value) {
+    AppendMany(&value, 1);
 }
 
 void ColumnDecimal::Append(const std::string& value) {
-    Int128 int_value = 0;
-    auto c = value.begin();
-    bool sign = true;
-
-    while (c != value.end()) {
-        if (*c == '-') {
-            sign = false;
-            if (c != value.begin()) {
-                break;
+    bool negative;
+
+    switch (storage_) {
+        case Type::Int32:
+        case Type::Int64: {
+            // Precision is at most 18 digits, so the value fits into int64_t.
+            const auto magnitude = static_cast<int64_t>(ParseDecimal<uint64_t>(value, precision_, scale_, &negative));
+            const int64_t result = negative ? -magnitude : magnitude;
+            AppendMany(&result, 1);
+            break;
+        }
+        case Type::Int128: {
+            const auto magnitude = static_cast<Int128>(ParseDecimal<absl::uint128>(value, precision_, scale_, &negative));
+            Append(negative ? -magnitude : magnitude);
+            break;
+        }
+        default: {
+            const auto magnitude = Int256(ParseDecimal<UInt256>(value, precision_, scale_, &negative));
+            Append(negative ? -magnitude : magnitude);
+            break;
+        }
+    }
+}
+
+Int128 ColumnDecimal::At(size_t i) const {
+    switch (storage_) {
+        case Type::Int32:
+            return Data<ColumnInt32>().At(i);
+        case Type::Int64:
+            return Data<ColumnInt64>().At(i);
+        case Type::Int128:
+            return Data<ColumnInt128>().At(i);
+        default: {
+            const Int256& value = Data<ColumnInt256>().At(i);
+            const Int128 result = static_cast<Int128>(value);
+            if (Int256(result) != value) {
+                throw std::overflow_error("decimal value does not fit into Int128");
             }
-        } else if (*c == '.') {
-            // TODO: compare distance with `scale`
-        } else if (*c >= '0' && *c <= '9') {
-            int_value = int_value * 10 + (*c - '0');
-        } else {
-            // TODO: throw exception on unexpected symbol
+            return result;
         }
-        ++c;
     }
+}
 
-    if (c != value.end()) {
-        // TODO: throw exception about symbols after 'minus'
+Int256 ColumnDecimal::AtWide(size_t i) const {
+    if (storage_ == Type::Int256) {
+        return Data<ColumnInt256>().At(i);
     }
+    return Int256(At(i));
+}
 
-    Append(sign ? int_value : -int_value);
+std::string ColumnDecimal::AsString(size_t i) const {
+    switch (storage_) {
+        case Type::Int32:
+        case Type::Int64: {
+            const auto value = static_cast<int64_t>(At(i));
+            const uint64_t magnitude = value < 0 ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+            return FormatDecimal(magnitude, value < 0, scale_);
+        }
+        case Type::Int128: {
+            const Int128 value = At(i);
+            const absl::uint128 magnitude = value < 0 ? -absl::uint128(value) : absl::uint128(value);
+            return FormatDecimal(magnitude, value < 0, scale_);
+        }
+        default: {
+            const Int256 value = AtWide(i);
+            return FormatDecimal(UInt256(value.IsNegative() ? -value : value), value.IsNegative(), scale_);
+        }
+    }
 }
 
-Int128 ColumnDecimal::At(size_t i) const {
-    if (data_->Type()->GetCode() == Type::Int32) {
-        return static_cast<Int128>(data_->As<ColumnInt32>()->At(i));
-    } else if (data_->Type()->GetCode() == Type::Int64) {
-        return static_cast<Int128>(data_->As<ColumnInt64>()->At(i));
-    } else {
-        return data_->As<ColumnInt128>()->At(i);
+template <typename T>
+void ColumnDecimal::AppendMany(const T* values, size_t count) {
+    switch (storage_) {
+        case Type::Int32:
+            AppendValues(Data<ColumnInt32>(), values, count);
+            break;
+        case Type::Int64:
+            AppendValues(Data<ColumnInt64>(), values, count);
+            break;
+        case Type::Int128:
+            AppendValues(Data<ColumnInt128>(), values, count);
+            break;
+        default:
+            AppendValues(Data<ColumnInt256>(), values, count);
+            break;
+    }
+}
+
+template <typename T>
+void ColumnDecimal::GetMany(size_t begin, size_t count, T* out) const {
+    switch (storage_) {
+        case Type::Int32:
+            GetValues(Data<ColumnInt32>(), begin, count, out);
+            break;
+        case Type::Int64:
+            GetValues(Data<ColumnInt64>(), begin, count, out);
+            break;
+        case Type::Int128:
+            GetValues(Data<ColumnInt128>(), begin, count, out);
+            break;
+        default:
+            GetValues(Data<ColumnInt256>(), begin, count, out);
+            break;
     }
 }
 
+template void ColumnDecimal::AppendMany<int32_t>(const int32_t*, size_t);
+template void ColumnDecimal::AppendMany<int64_t>(const int64_t*, size_t);
+template void ColumnDecimal::AppendMany<Int128>(const Int128*, size_t);
+template void ColumnDecimal::AppendMany<Int256>(const Int256*, size_t);
+
+template void ColumnDecimal::GetMany<int32_t>(size_t, size_t, int32_t*) const;
+template void ColumnDecimal::GetMany<int64_t>(size_t, size_t, int64_t*) const;
+template void ColumnDecimal::GetMany<Int128>(size_t, size_t, Int128*) const;
+template void ColumnDecimal::GetMany<Int256>(size_t, size_t, Int256*) const;
+
+size_t ColumnDecimal::GetPrecision() const {
+    return precision_;
+}
+
+size_t ColumnDecimal::GetScale() const {
+    return scale_;
+}
+
 void ColumnDecimal::Append(ColumnRef column) {
     if (auto col = column->As<ColumnDecimal>()) {
         data_->Append(col->data_);
@@ -90,9 +442,43 @@ size_t ColumnDecimal::Size() const {
 }
 
 ColumnRef ColumnDecimal::Slice(size_t begin, size_t len) {
-    std::shared_ptr<ColumnDecimal> slice(new ColumnDecimal(type_));
+    auto slice = MakeColumn<ColumnDecimal>(resource_, precision_, scale_);
+    slice->type_ = type_;
     slice->data_ = data_->Slice(begin, len);
+    slice->storage_ = storage_;
     return slice;
 }
 
+ColumnRef ColumnDecimal::Filter(const uint8_t* mask) const {
+    auto result = MakeColumn<ColumnDecimal>(resource_, precision_, scale_);
+    result->type_ = type_;
+    result->data_ = data_->Filter(mask);
+    result->storage_ = storage_;
+    return result;
+}
+
+ColumnRef ColumnDecimal::Take(const uint32_t* indices, size_t count) const {
+    auto result = MakeColumn<ColumnDecimal>(resource_, precision_, scale_);
+    result->type_ = type_;
+    result->data_ = data_->Take(indices, count);
+    result->storage_ = storage_;
+    return result;
+}
+
+size_t ColumnDecimal::MemoryUsage() const {
+    return data_->MemoryUsage();
+}
+
+void ColumnDecimal::Reserve(size_t rows) {
+    data_->Reserve(rows);
+}
+
+void ColumnDecimal::ShrinkToFit() {
+    data_->ShrinkToFit();
+}
+
+bool ColumnDecimal::IsExclusivelyOwned() const {
+    return IsNestedOwned(data_);
+}
+
 }
@@ -11,13 +11,43 @@ namespace clickhouse {
  */
 class ColumnDecimal : public Column {
 public:
-    ColumnDecimal(size_t precision, size_t scale);
+    ColumnDecimal(size_t precision, size_t scale, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 
+    /// Appends unscaled value, e.g. 12345 for 123.45 of scale 2.
     void Append(const Int128& value);
+    void Append(const Int256& value);
+
+    /// Parses and appends decimal string like "-123.45".  Digits of the
+    /// fractional part beyond the scale are truncated.  Throws
+    /// std::runtime_error on invalid input or if the value does not fit
+    /// the precision.
     void Append(const std::string& value);
 
+    /// Returns unscaled value at given row number.  Throws
+    /// std::overflow_error if the value of Decimal256 does not fit.
     Int128 At(size_t i) const;
 
+    /// Returns unscaled value at given row number.
+    Int256 AtWide(size_t i) const;
+
+    /// Returns decimal string representation of the value with all
+    /// digits of the scale, e.g. "-123.450".
+    std::string AsString(size_t i) const;
+
+    /// Appends unscaled values, converting them to the storage type.
+    /// T is one of int32_t, int64_t, Int128 or Int256.
+    template <typename T>
+    void AppendMany(const T* values, size_t count);
+
+    /// Copies unscaled values of rows [begin, begin + count) to out.
+    /// T is one of int32_t, int64_t, Int128 or Int256.
+    template <typename T>
+    void GetMany(size_t begin, size_t count, T* out) const;
+
+    size_t GetPrecision() const;
+
+    size_t GetScale() const;
+
 public:
     void Append(ColumnRef column) override;
     bool Load(CodedInputStream* input, size_t rows) override;
@@ -25,15 +55,31 @@ public:
     void Clear() override;
     size_t Size() const override;
     ColumnRef Slice(size_t begin, size_t len) override;
+    ColumnRef Filter(const uint8_t* mask) const override;
+    ColumnRef Take(const uint32_t* indices, size_t count) const override;
+    size_t MemoryUsage() const override;
+    void Reserve(size_t rows) override;
+    void ShrinkToFit() override;
+    bool IsExclusivelyOwned() const override;
+
+private:
+    /// Returns storage column of the known type.
+    template <typename C>
+    inline C& Data() const {
+        return static_cast<C&>(*data_);
+    }
 
 private:
     /// Depending on a precision it can be one of:
     ///  - ColumnInt32
     ///  - ColumnInt64
     ///  - ColumnInt128
+    ///  - ColumnInt256
     ColumnRef data_;
-
-    explicit ColumnDecimal(TypeRef type); // for `Slice(…)`
+    /// Type code of the storage column, fixed at construction.
+    Type::Code storage_;
+    size_t precision_;
+    size_t scale_;
 };
 
 }
@@ -4,15 +4,16 @@
 namespace clickhouse {
 
 template <typename T>
-ColumnEnum<T>::ColumnEnum(TypeRef type)
-    : Column(type)
+ColumnEnum<T>::ColumnEnum(TypeRef type, std::pmr::memory_resource* resource)
+    : Column(type, resource)
+    , data_(resource)
 {
 }
 
 template <typename T>
-ColumnEnum<T>::ColumnEnum(TypeRef type, const std::vector<T>& data)
-    : Column(type)
-    , data_(data)
+ColumnEnum<T>::ColumnEnum(TypeRef type, const std::vector<T>& data, std::pmr::memory_resource* resource)
+    : Column(type, resource)
+    , data_(data.begin(), data.end(), resource)
 {
 }
 
@@ -87,7 +88,38 @@ size_t ColumnEnum<T>::Size() const {
 
 template <typename T>
 ColumnRef ColumnEnum<T>::Slice(size_t begin, size_t len) {
-    return std::make_shared<ColumnEnum<T>>(type_, SliceVector(data_, begin, len));
+    auto result = MakeColumn<ColumnEnum<T>>(resource_, type_);
+    result->data_ = SliceVector(data_, begin, len);
+    return result;
+}
+
+template <typename T>
+ColumnRef ColumnEnum<T>::Filter(const uint8_t* mask) const {
+    auto result = MakeColumn<ColumnEnum<T>>(resource_, type_);
+    result->data_ = FilterVector(data_, mask);
+    return result;
+}
+
+template <typename T>
+ColumnRef ColumnEnum<T>::Take(const uint32_t* indices, size_t count) const {
+    auto result = MakeColumn<ColumnEnum<T>>(resource_, type_);
+    result->data_ = TakeVector(data_, indices, count);
+    return result;
+}
+
+template <typename T>
+size_t ColumnEnum<T>::MemoryUsage() const {
+    return data_.capacity() * sizeof(T);
+}
+
+template <typename T>
+void ColumnEnum<T>::Reserve(size_t rows) {
+    data_.reserve(rows);
+}
+
+template <typename T>
+void ColumnEnum<T>::ShrinkToFit() {
+    data_.shrink_to_fit();
 }
 
 template class ColumnEnum<int8_t>;
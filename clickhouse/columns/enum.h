@@ -8,8 +8,8 @@ namespace clickhouse {
 template <typename T>
 class ColumnEnum : public Column {
 public:
-    ColumnEnum(TypeRef type);
-    ColumnEnum(TypeRef type, const std::vector<T>& data);
+    explicit ColumnEnum(TypeRef type, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+    ColumnEnum(TypeRef type, const std::vector<T>& data, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 
     /// Appends one element to the end of column.
     void Append(const T& value, bool checkValue = false);
@@ -45,8 +45,23 @@ public:
     /// Makes slice of the current column.
     ColumnRef Slice(size_t begin, size_t len) override;
 
+    /// Makes column of the rows selected by the mask.
+    ColumnRef Filter(const uint8_t* mask) const override;
+
+    /// Makes column of the rows at given positions.
+    ColumnRef Take(const uint32_t* indices, size_t count) const override;
+
+    /// Returns count of bytes of memory held by the column data.
+    size_t MemoryUsage() const override;
+
+    /// Preallocates memory for given total count of rows.
+    void Reserve(size_t rows) override;
+
+    /// Releases memory reserved beyond the current content.
+    void ShrinkToFit() override;
+
 private:
-    std::vector<T> data_;
+    std::pmr::vector<T> data_;
 };
 
 using ColumnEnum8 = ColumnEnum<int8_t>;
@@ -6,6 +6,8 @@
 #include "enum.h"
 #include "ip4.h"
 #include "ip6.h"
+#include "lowcardinality.h"
+#include "map.h"
 #include "nothing.h"
 #include "nullable.h"
 #include "numeric.h"
@@ -18,96 +20,135 @@
 namespace clickhouse {
 namespace {
 
-static ColumnRef CreateTerminalColumn(const TypeAst& ast) {
+/// Allocates column object from the resource.  Composite columns take
+/// memory resource of their nested columns.
+template <typename T, typename... Args>
+inline std::shared_ptr<T> AllocateColumn(std::pmr::memory_resource* resource, Args&&... args) {
+    return std::allocate_shared<T>(std::pmr::polymorphic_allocator<T>(resource), std::forward<Args>(args)...);
+}
+
+static ColumnRef CreateTerminalColumn(const TypeAst& ast, std::pmr::memory_resource* resource) {
     switch (ast.code) {
     case Type::Void:
-        return std::make_shared<ColumnNothing>();
+        return AllocateColumn<ColumnNothing>(resource);
 
     case Type::UInt8:
-        return std::make_shared<ColumnUInt8>();
+        return MakeColumn<ColumnUInt8>(resource);
     case Type::UInt16:
-        return std::make_shared<ColumnUInt16>();
+        return MakeColumn<ColumnUInt16>(resource);
     case Type::UInt32:
-        return std::make_shared<ColumnUInt32>();
+        return MakeColumn<ColumnUInt32>(resource);
     case Type::UInt64:
-        return std::make_shared<ColumnUInt64>();
+        return MakeColumn<ColumnUInt64>(resource);
+    case Type::UInt128:
+        return MakeColumn<ColumnUInt128>(resource);
+    case Type::UInt256:
+        return MakeColumn<ColumnUInt256>(resource);
 
     case Type::Int8:
-        return std::make_shared<ColumnInt8>();
+        return MakeColumn<ColumnInt8>(resource);
     case Type::Int16:
-        return std::make_shared<ColumnInt16>();
+        return MakeColumn<ColumnInt16>(resource);
     case Type::Int32:
-        return std::make_shared<ColumnInt32>();
+        return MakeColumn<ColumnInt32>(resource);
     case Type::Int64:
-        return std::make_shared<ColumnInt64>();
+        return MakeColumn<ColumnInt64>(resource);
+    case Type::Int128:
+        return MakeColumn<ColumnInt128>(resource);
+    case Type::Int256:
+        return MakeColumn<ColumnInt256>(resource);
 
     case Type::Float32:
-        return std::make_shared<ColumnFloat32>();
+        return MakeColumn<ColumnFloat32>(resource);
     case Type::Float64:
-        return std::make_shared<ColumnFloat64>();
+        return MakeColumn<ColumnFloat64>(resource);
 
     case Type::Decimal:
-        return std::make_shared<ColumnDecimal>(ast.elements.front().value, ast.elements.back().value);
+        return MakeColumn<ColumnDecimal>(resource, ast.elements.front().value, ast.elements.back().value);
     case Type::Decimal32:
-        return std::make_shared<ColumnDecimal>(9, ast.elements.front().value);
+        return MakeColumn<ColumnDecimal>(resource, 9, ast.elements.front().value);
     case Type::Decimal64:
-        return std::make_shared<ColumnDecimal>(18, ast.elements.front().value);
+        return MakeColumn<ColumnDecimal>(resource, 18, ast.elements.front().value);
     case Type::Decimal128:
-        return std::make_shared<ColumnDecimal>(38, ast.elements.front().value);
+        return MakeColumn<ColumnDecimal>(resource, 38, ast.elements.front().value);
+    case Type::Decimal256:
+        return MakeColumn<ColumnDecimal>(resource, 76, ast.elements.front().value);
 
     case Type::String:
-        return std::make_shared<ColumnString>();
+        return MakeColumn<ColumnString>(resource);
     case Type::FixedString:
-        return std::make_shared<ColumnFixedString>(ast.elements.front().value);
+        return MakeColumn<ColumnFixedString>(resource, ast.elements.front().value);
 
     case Type::DateTime:
         if (ast.elements.empty()) {
-            return std::make_shared<ColumnDateTime>();
+            return MakeColumn<ColumnDateTime>(resource);
         } else {
-            return std::make_shared<ColumnDateTime>(ast.elements[0].value_string);
+            return MakeColumn<ColumnDateTime>(resource, ast.elements[0].value_string);
         }
     case Type::DateTime64:
         if (ast.elements.empty()) {
             return nullptr;
         }
         if (ast.elements.size() == 1) {
-            return std::make_shared<ColumnDateTime64>(ast.elements[0].value);
+            return MakeColumn<ColumnDateTime64>(resource, ast.elements[0].value);
         } else {
-            return std::make_shared<ColumnDateTime64>(ast.elements[0].value, ast.elements[1].value_string);
+            return MakeColumn<ColumnDateTime64>(resource, ast.elements[0].value, ast.elements[1].value_string);
         }
     case Type::Date:
-        return std::make_shared<ColumnDate>();
+        return MakeColumn<ColumnDate>(resource);
+    case Type::Date32:
+        return MakeColumn<ColumnDate32>(resource);
 
     case Type::IPv4:
-        return std::make_shared<ColumnIPv4>();
+        return MakeColumn<ColumnIPv4>(resource);
     case Type::IPv6:
-        return std::make_shared<ColumnIPv6>();
+        return MakeColumn<ColumnIPv6>(resource);
 
     case Type::UUID:
-        return std::make_shared<ColumnUUID>();
+        return MakeColumn<ColumnUUID>(resource);
 
     default:
         return nullptr;
     }
 }
 
-static ColumnRef CreateColumnFromAst(const TypeAst& ast) {
+static ColumnRef CreateColumnFromAst(const TypeAst& ast, std::pmr::memory_resource* resource) {
     switch (ast.meta) {
         case TypeAst::Array: {
-            return std::make_shared<ColumnArray>(
-                CreateColumnFromAst(ast.elements.front())
+            return AllocateColumn<ColumnArray>(resource,
+                CreateColumnFromAst(ast.elements.front(), resource)
             );
         }
 
         case TypeAst::Nullable: {
-            return std::make_shared<ColumnNullable>(
-                CreateColumnFromAst(ast.elements.front()),
-                std::make_shared<ColumnUInt8>()
+            return AllocateColumn<ColumnNullable>(resource,
+                CreateColumnFromAst(ast.elements.front(), resource),
+                MakeColumn<ColumnUInt8>(resource)
             );
         }
 
+        case TypeAst::LowCardinality: {
+            if (auto nested = CreateColumnFromAst(ast.elements.front(), resource)) {
+                return AllocateColumn<ColumnLowCardinality>(resource, nested);
+            }
+            break;
+        }
+
+        case TypeAst::Map: {
+            if (ast.elements.size() != 2) {
+                break;
+            }
+
+            auto keys = CreateColumnFromAst(ast.elements[0], resource);
+            auto values = CreateColumnFromAst(ast.elements[1], resource);
+            if (keys && values) {
+                return AllocateColumn<ColumnMap>(resource, keys, values);
+            }
+            break;
+        }
+
         case TypeAst::Terminal: {
-            return CreateTerminalColumn(ast);
+            return CreateTerminalColumn(ast, resource);
         }
 
         case TypeAst::Tuple: {
@@ -115,14 +156,14 @@ static ColumnRef CreateColumnFromAst(const TypeAst& ast) {
 
             columns.reserve(ast.elements.size());
             for (const auto& elem : ast.elements) {
-                if (auto col = CreateColumnFromAst(elem)) {
+                if (auto col = CreateColumnFromAst(elem, resource)) {
                     columns.push_back(col);
                 } else {
                     return nullptr;
                 }
             }
 
-            return std::make_shared<ColumnTuple>(columns);
+            return AllocateColumn<ColumnTuple>(resource, columns);
         }
 
         case TypeAst::Enum: {
@@ -136,11 +177,11 @@ static ColumnRef CreateColumnFromAst(const TypeAst& ast) {
             }
 
             if (ast.code == Type::Enum8) {
-                return std::make_shared<ColumnEnum8>(
+                return MakeColumn<ColumnEnum8>(resource,
                     Type::CreateEnum8(enum_items)
                 );
             } else if (ast.code == Type::Enum16) {
-                return std::make_shared<ColumnEnum16>(
+                return MakeColumn<ColumnEnum16>(resource,
                     Type::CreateEnum16(enum_items)
                 );
             }
@@ -160,10 +201,10 @@ static ColumnRef CreateColumnFromAst(const TypeAst& ast) {
 } // namespace
 
 
-ColumnRef CreateColumnByType(const std::string& type_name) {
+ColumnRef CreateColumnByType(const std::string& type_name, std::pmr::memory_resource* resource) {
     auto ast = ParseTypeName(type_name);
     if (ast != nullptr) {
-        return CreateColumnFromAst(*ast);
+        return CreateColumnFromAst(*ast, resource);
     }
 
     return nullptr;
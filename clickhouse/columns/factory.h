@@ -4,6 +4,9 @@
 
 namespace clickhouse {
 
-ColumnRef CreateColumnByType(const std::string& type_name);
+/// Creates empty column of the type.  Storage of the column is allocated
+/// from the resource, which must outlive the column.
+ColumnRef CreateColumnByType(const std::string& type_name,
+                             std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 
 }
@@ -0,0 +1,107 @@
+#include "hash.h"
+#include "date.h"
+#include "enum.h"
+#include "lowcardinality.h"
+#include "numeric.h"
+#include "string.h"
+
+#include <cityhash/city.h>
+
+#include <stdexcept>
+#include <vector>
+
+namespace clickhouse {
+namespace {
+
+template <typename T>
+void HashVector(const ColumnRef& column, uint64_t* hashes) {
+    const auto& data = column->As<ColumnVector<T>>()->GetData();
+    for (size_t i = 0; i < data.size(); ++i) {
+        hashes[i] = HashValue(data[i]);
+    }
+}
+
+/// Hashes values of column C, stored as values of T by ClickHouse.
+template <typename T, typename C, typename Func>
+void HashValues(const ColumnRef& column, uint64_t* hashes, Func&& value) {
+    const auto col = column->As<C>();
+    const size_t size = col->Size();
+    for (size_t i = 0; i < size; ++i) {
+        hashes[i] = HashValue(static_cast<T>(value(*col, i)));
+    }
+}
+
+template <typename C>
+void HashStrings(const ColumnRef& column, uint64_t* hashes) {
+    const auto col = column->As<C>();
+    const size_t size = col->Size();
+    for (size_t i = 0; i < size; ++i) {
+        const std::string& value = (*col)[i];
+        hashes[i] = CityHash64(value.data(), value.size());
+    }
+}
+
+void HashLowCardinality(const ColumnRef& column, uint64_t* hashes) {
+    const auto col = column->As<ColumnLowCardinality>();
+    if (col->IsNullable()) {
+        throw std::runtime_error("can't hash column of nullable type " + column->Type()->GetName());
+    }
+
+    // Each value of the dictionary is hashed once.
+    const auto dictionary = col->GetDictionary();
+    std::vector<uint64_t> values(dictionary->Size());
+    HashColumn(dictionary, values.data());
+
+    const size_t size = col->Size();
+    for (size_t i = 0; i < size; ++i) {
+        hashes[i] = values[col->GetIndex(i)];
+    }
+}
+
+}
+
+void HashColumn(const ColumnRef& column, uint64_t* hashes) {
+    switch (column->Type()->GetCode()) {
+        case Type::Int8:    return HashVector<int8_t>(column, hashes);
+        case Type::Int16:   return HashVector<int16_t>(column, hashes);
+        case Type::Int32:   return HashVector<int32_t>(column, hashes);
+        case Type::Int64:   return HashVector<int64_t>(column, hashes);
+        case Type::UInt8:   return HashVector<uint8_t>(column, hashes);
+        case Type::UInt16:  return HashVector<uint16_t>(column, hashes);
+        case Type::UInt32:  return HashVector<uint32_t>(column, hashes);
+        case Type::UInt64:  return HashVector<uint64_t>(column, hashes);
+        case Type::Float32: return HashVector<float>(column, hashes);
+        case Type::Float64: return HashVector<double>(column, hashes);
+
+        // Dates are days and date times are seconds since epoch.
+        case Type::Date:
+            return HashValues<uint16_t, ColumnDate>(column, hashes, [] (const ColumnDate& col, size_t i) {
+                return col.At(i) / 86400;
+            });
+        case Type::Date32:
+            return HashValues<int32_t, ColumnDate32>(column, hashes, [] (const ColumnDate32& col, size_t i) {
+                return col.At(i) / 86400;
+            });
+        case Type::DateTime:
+            return HashValues<uint32_t, ColumnDateTime>(column, hashes, [] (const ColumnDateTime& col, size_t i) {
+                return col.At(i);
+            });
+        case Type::Enum8:
+            return HashValues<int8_t, ColumnEnum8>(column, hashes, [] (const ColumnEnum8& col, size_t i) {
+                return col.At(i);
+            });
+        case Type::Enum16:
+            return HashValues<int16_t, ColumnEnum16>(column, hashes, [] (const ColumnEnum16& col, size_t i) {
+                return col.At(i);
+            });
+
+        case Type::String:         return HashStrings<ColumnString>(column, hashes);
+        case Type::FixedString:    return HashStrings<ColumnFixedString>(column, hashes);
+        case Type::LowCardinality: return HashLowCardinality(column, hashes);
+
+        default:
+            throw std::runtime_error("can't hash column of type " + column->Type()->GetName());
+    }
+}
+
+}
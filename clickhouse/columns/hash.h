@@ -0,0 +1,38 @@
+#pragma once
+
+#include "column.h"
+
+#include <cstring>
+
+namespace clickhouse {
+
+/// intHash64 of ClickHouse, the finalizer of MurmurHash3.
+inline uint64_t IntHash64(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+/// Hash of a value of an integer or float type: intHash64 of its bits
+/// zero-extended to 64 bits, as bit_cast of ClickHouse does.
+template <typename T>
+inline uint64_t HashValue(T value) {
+    static_assert(sizeof(T) <= sizeof(uint64_t), "value must fit 64 bits");
+    uint64_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(T));
+    return IntHash64(bits);
+}
+
+/// Computes hash of each row of the column as cityHash64 of ClickHouse
+/// with the column as its only argument: values of integer, float, date
+/// and enum types are hashed with intHash64 of their bits, strings with
+/// CityHash64 of their bytes.  LowCardinality columns are hashed as their
+/// values.  Throws std::runtime_error for columns of other types.
+///
+/// @param hashes buffer of Size() values to store hashes to.
+void HashColumn(const ColumnRef& column, uint64_t* hashes);
+
+}
@@ -9,14 +9,14 @@ using in_addr_t = unsigned long;
 
 namespace clickhouse {
 
-ColumnIPv4::ColumnIPv4()
-    : Column(Type::CreateIPv4())
-    , data_(std::make_shared<ColumnUInt32>())
+ColumnIPv4::ColumnIPv4(std::pmr::memory_resource* resource)
+    : Column(Type::CreateIPv4(), resource)
+    , data_(MakeColumn<ColumnUInt32>(resource))
 {
 }
 
 ColumnIPv4::ColumnIPv4(ColumnRef data)
-    : Column(Type::CreateIPv4())
+    : Column(Type::CreateIPv4(), data->GetMemoryResource())
     , data_(data->As<ColumnUInt32>())
 {
     if (data_->Size() != 0) {
@@ -75,7 +75,37 @@ size_t ColumnIPv4::Size() const {
 }
 
 ColumnRef ColumnIPv4::Slice(size_t begin, size_t len) {
-    return std::make_shared<ColumnIPv4>(data_->Slice(begin, len));
+    auto result = MakeColumn<ColumnIPv4>(resource_);
+    result->data_ = data_->Slice(begin, len)->As<ColumnUInt32>();
+    return result;
+}
+
+ColumnRef ColumnIPv4::Filter(const uint8_t* mask) const {
+    auto result = MakeColumn<ColumnIPv4>(resource_);
+    result->data_ = data_->Filter(mask)->As<ColumnUInt32>();
+    return result;
+}
+
+ColumnRef ColumnIPv4::Take(const uint32_t* indices, size_t count) const {
+    auto result = MakeColumn<ColumnIPv4>(resource_);
+    result->data_ = data_->Take(indices, count)->As<ColumnUInt32>();
+    return result;
+}
+
+size_t ColumnIPv4::MemoryUsage() const {
+    return data_->MemoryUsage();
+}
+
+void ColumnIPv4::Reserve(size_t rows) {
+    data_->Reserve(rows);
+}
+
+void ColumnIPv4::ShrinkToFit() {
+    data_->ShrinkToFit();
+}
+
+bool ColumnIPv4::IsExclusivelyOwned() const {
+    return IsNestedOwned(data_);
 }
 
 }
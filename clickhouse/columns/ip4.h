@@ -7,7 +7,7 @@ namespace clickhouse {
 
 class ColumnIPv4 : public Column {
 public:
-    ColumnIPv4();
+    explicit ColumnIPv4(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
     explicit ColumnIPv4(ColumnRef data);
 
     /// Appends one element to the column.
@@ -43,6 +43,24 @@ public:
     /// Makes slice of the current column.
     ColumnRef Slice(size_t begin, size_t len) override;
 
+    /// Makes column of the rows selected by the mask.
+    ColumnRef Filter(const uint8_t* mask) const override;
+
+    /// Makes column of the rows at given positions.
+    ColumnRef Take(const uint32_t* indices, size_t count) const override;
+
+    /// Returns count of bytes of memory held by the column data.
+    size_t MemoryUsage() const override;
+
+    /// Preallocates memory for given total count of rows.
+    void Reserve(size_t rows) override;
+
+    /// Releases memory reserved beyond the current content.
+    void ShrinkToFit() override;
+
+    /// Returns true if nested columns are not referenced from outside.
+    bool IsExclusivelyOwned() const override;
+
 private:
     std::shared_ptr<ColumnUInt32> data_;
 };
@@ -7,14 +7,14 @@ namespace clickhouse {
 
 static_assert(sizeof(struct in6_addr) == 16, "sizeof in6_addr should be 16 bytes");
 
-ColumnIPv6::ColumnIPv6()
-    : Column(Type::CreateIPv6())
-    , data_(std::make_shared<ColumnFixedString>(16))
+ColumnIPv6::ColumnIPv6(std::pmr::memory_resource* resource)
+    : Column(Type::CreateIPv6(), resource)
+    , data_(MakeColumn<ColumnFixedString>(resource, 16))
 {
 }
 
 ColumnIPv6::ColumnIPv6(ColumnRef data)
-    : Column(Type::CreateIPv6())
+    : Column(Type::CreateIPv6(), data->GetMemoryResource())
     , data_(data->As<ColumnFixedString>())
 {
     if (data_->Size() != 0) {
@@ -75,7 +75,37 @@ size_t ColumnIPv6::Size() const {
 }
 
 ColumnRef ColumnIPv6::Slice(size_t begin, size_t len) {
-    return std::make_shared<ColumnIPv6>(data_->Slice(begin, len));
+    auto result = MakeColumn<ColumnIPv6>(resource_);
+    result->data_ = data_->Slice(begin, len)->As<ColumnFixedString>();
+    return result;
+}
+
+ColumnRef ColumnIPv6::Filter(const uint8_t* mask) const {
+    auto result = MakeColumn<ColumnIPv6>(resource_);
+    result->data_ = data_->Filter(mask)->As<ColumnFixedString>();
+    return result;
+}
+
+ColumnRef ColumnIPv6::Take(const uint32_t* indices, size_t count) const {
+    auto result = MakeColumn<ColumnIPv6>(resource_);
+    result->data_ = data_->Take(indices, count)->As<ColumnFixedString>();
+    return result;
+}
+
+size_t ColumnIPv6::MemoryUsage() const {
+    return data_->MemoryUsage();
+}
+
+void ColumnIPv6::Reserve(size_t rows) {
+    data_->Reserve(rows);
+}
+
+void ColumnIPv6::ShrinkToFit() {
+    data_->ShrinkToFit();
+}
+
+bool ColumnIPv6::IsExclusivelyOwned() const {
+    return IsNestedOwned(data_);
 }
 
 }
@@ -0,0 +1,631 @@
+#include "lowcardinality.h"
+#include "factory.h"
+#include "nullable.h"
+
+#include "../base/output.h"
+#include "../base/wire_format.h"
+
+#include <cityhash/city.h>
+
+#include <limits>
+#include <stdexcept>
+
+namespace clickhouse {
+namespace {
+
+/// Version of the serialization written into the prefix of a column.
+constexpr uint64_t kSharedDictionariesWithAdditionalKeys = 1;
+
+/// Flags and layout of the index serialization type.
+constexpr uint64_t kIndexTypeMask = 0xFFu;
+constexpr uint64_t kNeedGlobalDictionaryBit = 1u << 8u;
+constexpr uint64_t kHasAdditionalKeysBit = 1u << 9u;
+
+/// Codes of the index type.
+enum IndexType : uint64_t {
+    kUInt8 = 0,
+    kUInt16,
+    kUInt32,
+    kUInt64,
+};
+
+ColumnRef CreateIndexColumn(size_t width, std::pmr::memory_resource* resource) {
+    switch (width) {
+        case 1:
+            return MakeColumn<ColumnUInt8>(resource);
+        case 2:
+            return MakeColumn<ColumnUInt16>(resource);
+        case 4:
+            return MakeColumn<ColumnUInt32>(resource);
+        case 8:
+            return MakeColumn<ColumnUInt64>(resource);
+    }
+    throw std::runtime_error("invalid LowCardinality index width " + std::to_string(width));
+}
+
+size_t IndexWidthFromType(uint64_t type) {
+    switch (type) {
+        case kUInt8:
+            return 1;
+        case kUInt16:
+            return 2;
+        case kUInt32:
+            return 4;
+        case kUInt64:
+            return 8;
+    }
+    throw std::runtime_error("unknown LowCardinality index type " + std::to_string(type));
+}
+
+uint64_t IndexTypeFromWidth(size_t width) {
+    switch (width) {
+        case 1:
+            return kUInt8;
+        case 2:
+            return kUInt16;
+        case 4:
+            return kUInt32;
+    }
+    return kUInt64;
+}
+
+/// Smallest width of positions in a dictionary of given size.
+size_t IndexWidthForSize(size_t dictionary_size) {
+    if (dictionary_size <= std::numeric_limits<uint8_t>::max() + size_t(1)) {
+        return 1;
+    }
+    if (dictionary_size <= std::numeric_limits<uint16_t>::max() + size_t(1)) {
+        return 2;
+    }
+    if (dictionary_size <= std::numeric_limits<uint32_t>::max() + size_t(1)) {
+        return 4;
+    }
+    return 8;
+}
+
+/// Reads position at given row of an index column with known width.
+inline uint64_t IndexAt(const Column& index, size_t width, size_t n) {
+    switch (width) {
+        case 1:
+            return static_cast<const ColumnUInt8&>(index)[n];
+        case 2:
+            return static_cast<const ColumnUInt16&>(index)[n];
+        case 4:
+            return static_cast<const ColumnUInt32&>(index)[n];
+    }
+    return static_cast<const ColumnUInt64&>(index)[n];
+}
+
+ColumnRef CloneEmpty(const ColumnRef& column) {
+    return CreateColumnByType(column->Type()->GetName(), column->GetMemoryResource());
+}
+
+inline uint64_t HashKey(std::string_view value) {
+    return CityHash64(value.data(), value.size());
+}
+
+/// Returns native serialization of the keys.
+Buffer SerializeKeys(Column& keys) {
+    Buffer bytes;
+    BufferOutput output(&bytes);
+    CodedOutputStream coded(&output);
+    keys.Save(&coded);
+    coded.Flush();
+    return bytes;
+}
+
+/// Returns size of one of the keys serialized into given count of bytes.
+/// Types allowed in LowCardinality other than String have fixed size.
+size_t KeyWidth(size_t bytes, size_t keys) {
+    if (keys == 0 || bytes % keys != 0) {
+        throw std::runtime_error("LowCardinality keys must have fixed size");
+    }
+    return bytes / keys;
+}
+
+/// Keys of a dictionary as bytes, by which equal keys are found.
+class KeyBytes {
+public:
+    explicit KeyBytes(const Column& keys)
+        : strings_(dynamic_cast<const ColumnString*>(&keys))
+    {
+        if (!strings_ && keys.Size() != 0) {
+            // Saving doesn't change the column.
+            bytes_ = SerializeKeys(const_cast<Column&>(keys));
+            width_ = KeyWidth(bytes_.size(), keys.Size());
+        }
+    }
+
+    std::string_view operator [] (size_t key) const {
+        if (strings_) {
+            return (*strings_)[key];
+        }
+        return std::string_view(reinterpret_cast<const char*>(bytes_.data()) + key * width_, width_);
+    }
+
+private:
+    const ColumnString* strings_;
+    Buffer bytes_;
+    size_t width_ = 0;
+};
+
+/// Size of strings in the native format.
+size_t SerializedSize(const ColumnString& column) {
+    size_t size = 0;
+    for (size_t i = 0; i < column.Size(); ++i) {
+        uint64_t len = column[i].size();
+        size += len + 1;
+        while (len >= 0x80) {
+            len >>= 7;
+            ++size;
+        }
+    }
+    return size;
+}
+
+}
+
+ColumnLowCardinality::ColumnLowCardinality(ColumnRef nested)
+    : Column(Type::CreateLowCardinality(nested->Type()), nested->GetMemoryResource())
+    , index_(MakeColumn<ColumnUInt8>(resource_))
+    , index_width_(1)
+    , nullable_(nested->Type()->GetCode() == Type::Nullable)
+{
+    if (nested->Size() != 0) {
+        throw std::runtime_error("nested column of LowCardinality must be empty");
+    }
+
+    dictionary_ = nullable_ ? nested->As<ColumnNullable>()->Nested() : nested;
+    string_keys_ = dictionary_->Type()->GetCode() == Type::String;
+}
+
+ColumnLowCardinality::ColumnLowCardinality(TypeRef type, ColumnRef dictionary, ColumnRef index, size_t index_width, bool nullable)
+    : Column(type, index->GetMemoryResource())
+    , dictionary_(std::move(dictionary))
+    , index_(std::move(index))
+    , index_width_(index_width)
+    , nullable_(nullable)
+    , string_keys_(dictionary_->Type()->GetCode() == Type::String)
+{
+}
+
+void ColumnLowCardinality::Append(std::string_view value) {
+    ColumnString* dictionary = StringDictionary();
+
+    if (nullable_ && dictionary->Size() == 0) {
+        // Placeholder for NULL.
+        dictionary->Append(std::string());
+    }
+
+    UpdateHashTable();
+    bool inserted;
+    const size_t key = FindOrInsertKey(value, &inserted);
+    if (inserted) {
+        dictionary->Append(std::string(value));
+    }
+    EnsureIndexWidth(dictionary->Size());
+    AppendIndex(key);
+}
+
+void ColumnLowCardinality::AppendNull() {
+    if (!nullable_) {
+        throw std::runtime_error("can't append NULL to " + type_->GetName());
+    }
+    if (dictionary_->Size() == 0) {
+        StringDictionary()->Append(std::string());
+    }
+    AppendIndex(0);
+}
+
+size_t ColumnLowCardinality::GetIndex(size_t n) const {
+    if (n >= index_->Size()) {
+        throw std::out_of_range("row index is out of range: " + std::to_string(n));
+    }
+    return IndexAt(*index_, index_width_, n);
+}
+
+ColumnRef ColumnLowCardinality::GetDictionary() const {
+    return dictionary_;
+}
+
+ColumnRef ColumnLowCardinality::GetIndexColumn() const {
+    return index_;
+}
+
+bool ColumnLowCardinality::IsNullable() const {
+    return nullable_;
+}
+
+bool ColumnLowCardinality::IsNull(size_t n) const {
+    return nullable_ && GetIndex(n) == 0;
+}
+
+void ColumnLowCardinality::Append(ColumnRef column) {
+    auto col = column->As<ColumnLowCardinality>();
+    if (!col || !col->Type()->IsEqual(type_)) {
+        return;
+    }
+
+    if (col->dictionary_ == dictionary_) {
+        // Shared dictionary, only positions have to be appended.
+        const size_t rows = col->Size();
+        EnsureIndexWidth(dictionary_->Size());
+        for (size_t i = 0; i < rows; ++i) {
+            AppendIndex(IndexAt(*col->index_, col->index_width_, i));
+        }
+    } else {
+        AppendEncoded(*col->dictionary_, *col->index_, col->index_width_);
+    }
+}
+
+bool ColumnLowCardinality::LoadPrefix(CodedInputStream* input, size_t) {
+    uint64_t version;
+
+    if (!WireFormat::ReadFixed(input, &version)) {
+        return false;
+    }
+    if (version != kSharedDictionariesWithAdditionalKeys) {
+        throw std::runtime_error("unsupported LowCardinality serialization version " + std::to_string(version));
+    }
+
+    return true;
+}
+
+bool ColumnLowCardinality::Load(CodedInputStream* input, size_t rows) {
+    uint64_t index_serialization_type;
+    uint64_t number_of_keys;
+    uint64_t number_of_rows;
+
+    if (!WireFormat::ReadFixed(input, &index_serialization_type)) {
+        return false;
+    }
+    if (index_serialization_type & kNeedGlobalDictionaryBit) {
+        throw std::runtime_error("LowCardinality with global dictionary is not supported");
+    }
+    if (!(index_serialization_type & kHasAdditionalKeysBit)) {
+        throw std::runtime_error("LowCardinality without dictionary keys is not supported");
+    }
+
+    if (!WireFormat::ReadFixed(input, &number_of_keys)) {
+        return false;
+    }
+
+    ColumnRef keys = CloneEmpty(dictionary_);
+    if (!keys->Load(input, number_of_keys)) {
+        return false;
+    }
+
+    if (!WireFormat::ReadFixed(input, &number_of_rows)) {
+        return false;
+    }
+    if (number_of_rows != rows) {
+        throw std::runtime_error("unexpected count of rows in LowCardinality column: " +
+            std::to_string(number_of_rows) + ", expected: " + std::to_string(rows));
+    }
+
+    const size_t width = IndexWidthFromType(index_serialization_type & kIndexTypeMask);
+    ColumnRef indices = CreateIndexColumn(width, resource_);
+    if (!indices->Load(input, number_of_rows)) {
+        return false;
+    }
+
+    for (size_t i = 0; i < number_of_rows; ++i) {
+        if (IndexAt(*indices, width, i) >= number_of_keys) {
+            throw std::runtime_error("LowCardinality index is out of dictionary bounds");
+        }
+    }
+
+    if (Size() == 0 && width == IndexWidthForSize(number_of_keys)) {
+        dictionary_ = keys;
+        index_ = indices;
+        index_width_ = width;
+        ResetHashTable();
+    } else {
+        AppendEncoded(*keys, *indices, width);
+    }
+
+    return true;
+}
+
+void ColumnLowCardinality::SavePrefix(CodedOutputStream* output) {
+    WireFormat::WriteFixed(output, kSharedDictionariesWithAdditionalKeys);
+}
+
+void ColumnLowCardinality::Save(CodedOutputStream* output) {
+    const uint64_t index_serialization_type = IndexTypeFromWidth(index_width_) | kHasAdditionalKeysBit;
+
+    WireFormat::WriteFixed(output, index_serialization_type);
+    WireFormat::WriteFixed(output, static_cast<uint64_t>(dictionary_->Size()));
+    dictionary_->Save(output);
+    WireFormat::WriteFixed(output, static_cast<uint64_t>(index_->Size()));
+    index_->Save(output);
+}
+
+void ColumnLowCardinality::Clear() {
+    // The dictionary may be shared with slices of the column.
+    if (dictionary_.use_count() == 1) {
+        dictionary_->Clear();
+    } else {
+        dictionary_ = CloneEmpty(dictionary_);
+    }
+    // Keep capacity of the index, its width stays wide enough.
+    if (index_.use_count() == 1) {
+        index_->Clear();
+    } else {
+        index_ = MakeColumn<ColumnUInt8>(resource_);
+        index_width_ = 1;
+    }
+    ResetHashTable();
+}
+
+size_t ColumnLowCardinality::Size() const {
+    return index_->Size();
+}
+
+ColumnRef ColumnLowCardinality::Slice(size_t begin, size_t len) {
+    return ColumnRef(new ColumnLowCardinality(type_, dictionary_, index_->Slice(begin, len), index_width_, nullable_));
+}
+
+ColumnRef ColumnLowCardinality::Filter(const uint8_t* mask) const {
+    return ColumnRef(new ColumnLowCardinality(type_, dictionary_, index_->Filter(mask), index_width_, nullable_));
+}
+
+ColumnRef ColumnLowCardinality::Take(const uint32_t* indices, size_t count) const {
+    return ColumnRef(new ColumnLowCardinality(type_, dictionary_, index_->Take(indices, count), index_width_, nullable_));
+}
+
+size_t ColumnLowCardinality::MemoryUsage() const {
+    // The dictionary is counted even when it is shared with slices.
+    return dictionary_->MemoryUsage() + index_->MemoryUsage() +
+        hash_table_.capacity() * sizeof(HashSlot) + key_bytes_.capacity();
+}
+
+void ColumnLowCardinality::Reserve(size_t rows) {
+    index_->Reserve(rows);
+}
+
+void ColumnLowCardinality::ShrinkToFit() {
+    dictionary_->ShrinkToFit();
+    index_->ShrinkToFit();
+}
+
+bool ColumnLowCardinality::IsExclusivelyOwned() const {
+    return IsNestedOwned(dictionary_) && IsNestedOwned(index_);
+}
+
+ColumnString* ColumnLowCardinality::StringDictionary() const {
+    if (dictionary_->Type()->GetCode() != Type::String) {
+        throw std::runtime_error("can't append string to " + type_->GetName());
+    }
+    return static_cast<ColumnString*>(dictionary_.get());
+}
+
+void ColumnLowCardinality::ResetHashTable() {
+    hash_table_.clear();
+    hashed_keys_ = 0;
+    key_bytes_.clear();
+}
+
+void ColumnLowCardinality::UpdateHashTable() {
+    const size_t size = dictionary_->Size();
+
+    // The dictionary may have been cleared through GetDictionary().
+    if (hash_table_.empty() || hashed_keys_ > size) {
+        ResetHashTable();
+        hash_table_.assign(16, HashSlot{0, 0});
+    }
+
+    if (hashed_keys_ == size) {
+        return;
+    }
+
+    if (!string_keys_) {
+        const Buffer bytes = SerializeKeys(*dictionary_->Slice(hashed_keys_, size - hashed_keys_));
+        key_width_ = KeyWidth(bytes.size(), size - hashed_keys_);
+        key_bytes_.append(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    }
+
+    // Keep load factor not greater than 0.5.
+    size_t slots = hash_table_.size();
+    while (slots < size * 2) {
+        slots *= 2;
+    }
+    if (slots != hash_table_.size()) {
+        RehashTable(slots);
+    }
+
+    const size_t mask = hash_table_.size() - 1;
+    for (size_t key = hashed_keys_; key < size; ++key) {
+        if (nullable_ && key == 0) {
+            continue;
+        }
+
+        const std::string_view value = KeyAt(key);
+        const uint64_t hash = HashKey(value);
+
+        for (size_t i = hash & mask; ; i = (i + 1) & mask) {
+            HashSlot& slot = hash_table_[i];
+            if (slot.key == 0) {
+                slot = HashSlot{hash, key + 1};
+                break;
+            }
+            // Keys appended from other columns may repeat, keep the first one.
+            if (slot.hash == hash && KeyAt(slot.key - 1) == value) {
+                break;
+            }
+        }
+    }
+    hashed_keys_ = size;
+}
+
+std::string_view ColumnLowCardinality::KeyAt(size_t key) const {
+    if (string_keys_) {
+        return static_cast<const ColumnString&>(*dictionary_)[key];
+    }
+    return std::string_view(key_bytes_.data() + key * key_width_, key_width_);
+}
+
+size_t ColumnLowCardinality::FindOrInsertKey(std::string_view bytes, bool* inserted) {
+    const uint64_t hash = HashKey(bytes);
+    const size_t mask = hash_table_.size() - 1;
+
+    for (size_t i = hash & mask; ; i = (i + 1) & mask) {
+        HashSlot& slot = hash_table_[i];
+
+        if (slot.key == 0) {
+            const size_t key = hashed_keys_;
+            slot = HashSlot{hash, key + 1};
+            if (++hashed_keys_ * 2 > hash_table_.size()) {
+                RehashTable(hash_table_.size() * 2);
+            }
+            *inserted = true;
+            return key;
+        }
+        if (slot.hash == hash && KeyAt(slot.key - 1) == bytes) {
+            *inserted = false;
+            return slot.key - 1;
+        }
+    }
+}
+
+void ColumnLowCardinality::RehashTable(size_t slots) {
+    std::vector<HashSlot> table(slots, HashSlot{0, 0});
+    const size_t mask = slots - 1;
+
+    for (const HashSlot& slot : hash_table_) {
+        if (slot.key == 0) {
+            continue;
+        }
+        size_t i = slot.hash & mask;
+        while (table[i].key != 0) {
+            i = (i + 1) & mask;
+        }
+        table[i] = slot;
+    }
+
+    hash_table_.swap(table);
+}
+
+void ColumnLowCardinality::EnsureIndexWidth(size_t dictionary_size) {
+    const size_t width = IndexWidthForSize(dictionary_size);
+
+    if (width <= index_width_) {
+        return;
+    }
+
+    ColumnRef index = CreateIndexColumn(width, resource_);
+    const size_t rows = index_->Size();
+    std::swap(index, index_);
+    const size_t old_width = index_width_;
+    index_width_ = width;
+    // Keep capacity reserved for the narrower index.
+    index_->Reserve(index->MemoryUsage() / old_width);
+
+    for (size_t i = 0; i < rows; ++i) {
+        AppendIndex(IndexAt(*index, old_width, i));
+    }
+}
+
+void ColumnLowCardinality::AppendEncoded(const Column& keys, const Column& indices, size_t width) {
+    const size_t rows = indices.Size();
+    if (rows == 0) {
+        return;
+    }
+
+    // Keys of other column may be shared with it, so do not take the object.
+    if (dictionary_.use_count() != 1) {
+        auto dictionary = CloneEmpty(dictionary_);
+        dictionary->Append(dictionary_);
+        dictionary_ = dictionary;
+        ResetHashTable();
+    }
+
+    if (nullable_ && dictionary_->Size() == 0) {
+        // Placeholder for NULL.
+        const uint32_t null_key = 0;
+        dictionary_->Append(keys.Take(&null_key, 1));
+    }
+
+    std::vector<uint8_t> used(keys.Size());
+    for (size_t i = 0; i < rows; ++i) {
+        used[IndexAt(indices, width, i)] = 1;
+    }
+
+    // Positions of the used keys in this dictionary.  Missing keys are
+    // added in order of the other dictionary, keys of other types than
+    // String all at once.
+    const KeyBytes bytes(keys);
+    std::vector<uint64_t> positions(keys.Size());
+    std::vector<uint8_t> added(keys.Size());
+    bool any_added = false;
+
+    UpdateHashTable();
+    for (size_t key = 0; key < keys.Size(); ++key) {
+        // Position 0 is NULL in both columns.
+        if (!used[key] || (nullable_ && key == 0)) {
+            continue;
+        }
+
+        bool inserted;
+        positions[key] = FindOrInsertKey(bytes[key], &inserted);
+        if (!inserted) {
+            continue;
+        }
+        if (string_keys_) {
+            static_cast<ColumnString&>(*dictionary_).Append(std::string(bytes[key]));
+        } else {
+            key_width_ = bytes[key].size();
+            key_bytes_.append(bytes[key].data(), bytes[key].size());
+            added[key] = 1;
+            any_added = true;
+        }
+    }
+    if (any_added) {
+        dictionary_->Append(keys.Filter(added.data()));
+    }
+
+    EnsureIndexWidth(dictionary_->Size());
+    index_->Reserve(index_->Size() + rows);
+    for (size_t i = 0; i < rows; ++i) {
+        AppendIndex(positions[IndexAt(indices, width, i)]);
+    }
+}
+
+void ColumnLowCardinality::AppendIndex(uint64_t index) {
+    switch (index_width_) {
+        case 1:
+            static_cast<ColumnUInt8&>(*index_).Append(static_cast<uint8_t>(index));
+            break;
+        case 2:
+            static_cast<ColumnUInt16&>(*index_).Append(static_cast<uint16_t>(index));
+            break;
+        case 4:
+            static_cast<ColumnUInt32&>(*index_).Append(static_cast<uint32_t>(index));
+            break;
+        default:
+            static_cast<ColumnUInt64&>(*index_).Append(index);
+            break;
+    }
+}
+
+std::shared_ptr<ColumnLowCardinality> ToLowCardinality(const ColumnString& column, double* compression_ratio) {
+    auto result = MakeColumn<ColumnLowCardinality>(column.GetMemoryResource(), MakeColumn<ColumnString>(column.GetMemoryResource()));
+
+    for (size_t i = 0; i < column.Size(); ++i) {
+        result->Append(std::string_view(column[i]));
+    }
+
+    if (compression_ratio) {
+        const auto& dictionary = static_cast<const ColumnString&>(*result->GetDictionary());
+        // Version, index type, count of keys and count of rows.
+        const size_t header = 4 * sizeof(uint64_t);
+        const size_t index = result->Size() * IndexWidthForSize(dictionary.Size());
+
+        *compression_ratio = double(SerializedSize(column)) /
+            double(header + SerializedSize(dictionary) + index);
+    }
+
+    return result;
+}
+
+}
@@ -0,0 +1,165 @@
+#pragma once
+
+#include "column.h"
+#include "numeric.h"
+#include "string.h"
+
+#include <string_view>
+#include <vector>
+
+namespace clickhouse {
+
+/**
+ * Represents column of LowCardinality(T).
+ *
+ * Values are stored once in a dictionary, rows keep positions of their
+ * values in the dictionary.  Width of the positions grows with the size of
+ * the dictionary (UInt8, UInt16, UInt32 or UInt64).
+ *
+ * For LowCardinality(Nullable(T)) the dictionary is a column of T and
+ * the key at position 0 stands for NULL.
+ */
+class ColumnLowCardinality : public Column {
+public:
+    /// @param nested empty column of the value type T or Nullable(T).
+    explicit ColumnLowCardinality(ColumnRef nested);
+
+    /// Appends one value to a column with String dictionary.
+    /// Equal values share the same key of the dictionary.
+    void Append(std::string_view value);
+
+    /// Appends NULL to a column of nullable values.
+    void AppendNull();
+
+    /// Returns position of the row's value in the dictionary.
+    size_t GetIndex(size_t n) const;
+
+    /// Returns dictionary of values.  Slices of the column and columns
+    /// appended from them share the same dictionary object.
+    ColumnRef GetDictionary() const;
+
+    /// Returns positions of rows' values in the dictionary as one of
+    /// ColumnUInt8, ColumnUInt16, ColumnUInt32 or ColumnUInt64.
+    ColumnRef GetIndexColumn() const;
+
+    /// Returns true if values of the column are nullable.
+    bool IsNullable() const;
+
+    /// Returns null flag at given row number.
+    bool IsNull(size_t n) const;
+
+public:
+    /// Appends content of given column to the end of current one.
+    void Append(ColumnRef column) override;
+
+    /// Loads serialization version from input stream.
+    bool LoadPrefix(CodedInputStream* input, size_t rows) override;
+
+    /// Loads column data from input stream.
+    bool Load(CodedInputStream* input, size_t rows) override;
+
+    /// Saves serialization version to output stream.
+    void SavePrefix(CodedOutputStream* output) override;
+
+    /// Saves column data to output stream.
+    void Save(CodedOutputStream* output) override;
+
+    /// Clear column data .
+    void Clear() override;
+
+    /// Returns count of rows in the column.
+    size_t Size() const override;
+
+    /// Makes slice of the current column.
+    ColumnRef Slice(size_t begin, size_t len) override;
+
+    /// Makes column of the rows selected by the mask.
+    ColumnRef Filter(const uint8_t* mask) const override;
+
+    /// Makes column of the rows at given positions.
+    ColumnRef Take(const uint32_t* indices, size_t count) const override;
+
+    /// Returns count of bytes of memory held by the column data.
+    size_t MemoryUsage() const override;
+
+    /// Preallocates memory for given total count of rows.
+    void Reserve(size_t rows) override;
+
+    /// Releases memory reserved beyond the current content.
+    void ShrinkToFit() override;
+
+    /// Returns true if nested columns are not referenced from outside.
+    bool IsExclusivelyOwned() const override;
+
+private:
+    ColumnLowCardinality(TypeRef type, ColumnRef dictionary, ColumnRef index, size_t index_width, bool nullable); // for `Slice(…)`
+
+    /// Returns dictionary as a column of strings or throws.
+    ColumnString* StringDictionary() const;
+
+    /// Drops the hash table, it is rebuilt for the current dictionary on
+    /// the next lookup.  Called whenever the dictionary is replaced.
+    void ResetHashTable();
+
+    /// Adds keys appended to the dictionary since last call to the hash table.
+    void UpdateHashTable();
+
+    /// Returns bytes of the key at given position of the dictionary, by
+    /// which equal keys are found.
+    std::string_view KeyAt(size_t key) const;
+
+    /// Returns position of the key with given bytes in the hash table.  If
+    /// there is none, the next position is inserted and inserted is set,
+    /// the caller must append the key to the dictionary (or its bytes to
+    /// key_bytes_) before the next lookup.
+    size_t FindOrInsertKey(std::string_view bytes, bool* inserted);
+
+    /// Rebuilds the hash table with given count of slots.
+    void RehashTable(size_t slots);
+
+    /// Widens index column to fit positions of a dictionary of given size.
+    void EnsureIndexWidth(size_t dictionary_size);
+
+    /// Appends rows referencing keys of another dictionary.  Keys used by
+    /// the rows are mapped through the hash table, so unused and repeated
+    /// keys are not copied.
+    /// @param width byte width of the positions in indices.
+    void AppendEncoded(const Column& keys, const Column& indices, size_t width);
+
+    /// Appends one position to the index column.
+    void AppendIndex(uint64_t index);
+
+private:
+    /// Keys of the column.
+    ColumnRef dictionary_;
+    /// Positions of keys in the dictionary for each row.
+    ColumnRef index_;
+    /// Byte width of the positions.
+    size_t index_width_;
+    const bool nullable_;
+    /// Keys are strings, other keys are compared by their serialization.
+    bool string_keys_;
+
+    struct HashSlot {
+        uint64_t hash;
+        /// Position of the key in the dictionary plus one, zero for empty slot.
+        size_t key;
+    };
+
+    /// Open-addressing table of keys of the dictionary used for
+    /// deduplication of appended values.  It is built lazily and reset
+    /// when the dictionary is replaced.
+    std::vector<HashSlot> hash_table_;
+    size_t hashed_keys_ = 0;
+    /// Serialized keys of the hashed part of a dictionary of other types
+    /// than String, which have fixed size.
+    std::string key_bytes_;
+    size_t key_width_ = 0;
+};
+
+/// Converts column of strings to LowCardinality(String).
+/// @param compression_ratio if not null, receives ratio of the serialized
+///        size of the source column to the size of the result.
+std::shared_ptr<ColumnLowCardinality> ToLowCardinality(const ColumnString& column, double* compression_ratio = nullptr);
+
+}
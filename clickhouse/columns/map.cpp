@@ -0,0 +1,111 @@
+#include "map.h"
+
+#include <stdexcept>
+
+namespace clickhouse {
+
+ColumnMap::ColumnMap(ColumnRef keys, ColumnRef values)
+    : ColumnMap(MakeColumn<ColumnArray>(keys->GetMemoryResource(),
+        MakeColumn<ColumnTuple>(keys->GetMemoryResource(), std::vector<ColumnRef>{keys, values})))
+{
+}
+
+ColumnMap::ColumnMap(std::shared_ptr<ColumnArray> data)
+    : Column(Type::CreateMap(
+        data->data_->Type()->GetTupleType().at(0),
+        data->data_->Type()->GetTupleType().at(1)), data->GetMemoryResource())
+    , data_(std::move(data))
+    , tuple_(data_->data_->As<ColumnTuple>())
+{
+}
+
+ColumnRef ColumnMap::GetKeys() const {
+    return (*tuple_)[0];
+}
+
+ColumnRef ColumnMap::GetValues() const {
+    return (*tuple_)[1];
+}
+
+void ColumnMap::AppendAsColumn(ColumnRef keys, ColumnRef values) {
+    if (keys->Size() != values->Size()) {
+        throw std::runtime_error("can't append map with different count of keys and values");
+    }
+    if (!keys->Type()->IsEqual(type_->GetKeyType()) || !values->Type()->IsEqual(type_->GetValueType())) {
+        throw std::runtime_error(
+            "can't append map of types " + keys->Type()->GetName() + ", " + values->Type()->GetName() + " "
+            "to column type " + type_->GetName());
+    }
+
+    (*tuple_)[0]->Append(keys);
+    (*tuple_)[1]->Append(values);
+    data_->OffsetsIncrease(GetOffset(Size()) + keys->Size());
+}
+
+void ColumnMap::Append(ColumnRef column) {
+    if (auto col = column->As<ColumnMap>()) {
+        if (col->Type()->IsEqual(type_)) {
+            data_->Append(col->data_);
+        }
+    }
+}
+
+bool ColumnMap::LoadPrefix(CodedInputStream* input, size_t rows) {
+    return data_->LoadPrefix(input, rows);
+}
+
+bool ColumnMap::Load(CodedInputStream* input, size_t rows) {
+    return data_->Load(input, rows);
+}
+
+void ColumnMap::SavePrefix(CodedOutputStream* output) {
+    data_->SavePrefix(output);
+}
+
+void ColumnMap::Save(CodedOutputStream* output) {
+    data_->Save(output);
+}
+
+void ColumnMap::Clear() {
+    data_->Clear();
+}
+
+size_t ColumnMap::Size() const {
+    return data_->Size();
+}
+
+ColumnRef ColumnMap::Slice(size_t begin, size_t len) {
+    return MakeColumn<ColumnMap>(resource_, std::static_pointer_cast<ColumnArray>(data_->Slice(begin, len)));
+}
+
+ColumnRef ColumnMap::Filter(const uint8_t* mask) const {
+    return MakeColumn<ColumnMap>(resource_, std::static_pointer_cast<ColumnArray>(data_->Filter(mask)));
+}
+
+ColumnRef ColumnMap::Take(const uint32_t* indices, size_t count) const {
+    return MakeColumn<ColumnMap>(resource_, std::static_pointer_cast<ColumnArray>(data_->Take(indices, count)));
+}
+
+size_t ColumnMap::MemoryUsage() const {
+    return data_->MemoryUsage();
+}
+
+void ColumnMap::Reserve(size_t rows) {
+    data_->Reserve(rows);
+}
+
+void ColumnMap::ShrinkToFit() {
+    data_->ShrinkToFit();
+}
+
+bool ColumnMap::IsExclusivelyOwned() const {
+    return OwnsNested(1);
+}
+
+bool ColumnMap::OwnsNested(long element_references) const {
+    // The tuple is referenced by the array of tuples as well.
+    return data_.use_count() <= 1 && IsNestedOwned(data_->offsets_) &&
+        tuple_.use_count() <= 2 && tuple_->OwnsNested(element_references);
+}
+
+}
@@ -0,0 +1,300 @@
+#pragma once
+
+#include "array.h"
+#include "tuple.h"
+
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace clickhouse {
+
+/**
+ * Represents column of Map(K, V).
+ *
+ * In the native format a map is an array of (key, value) tuples, so
+ * the column is stored as Array(Tuple(K, V)).
+ */
+class ColumnMap : public Column {
+public:
+    /// @param keys   empty column of the key type.
+    /// @param values empty column of the value type.
+    ColumnMap(ColumnRef keys, ColumnRef values);
+
+    /// Makes map of an Array(Tuple(K, V)) column.
+    explicit ColumnMap(std::shared_ptr<ColumnArray> data);
+
+    /// Returns keys of all maps of the column.
+    ColumnRef GetKeys() const;
+
+    /// Returns values of all maps of the column.
+    ColumnRef GetValues() const;
+
+    /// Appends map of keys and values of equal size as one row.
+    void AppendAsColumn(ColumnRef keys, ColumnRef values);
+
+public:
+    /// Appends content of given column to the end of current one.
+    void Append(ColumnRef column) override;
+
+    /// Loads column prefix from input stream.
+    bool LoadPrefix(CodedInputStream* input, size_t rows) override;
+
+    /// Loads column data from input stream.
+    bool Load(CodedInputStream* input, size_t rows) override;
+
+    /// Saves column prefix to output stream.
+    void SavePrefix(CodedOutputStream* output) override;
+
+    /// Saves column data to output stream.
+    void Save(CodedOutputStream* output) override;
+
+    /// Clear column data .
+    void Clear() override;
+
+    /// Returns count of rows in the column.
+    size_t Size() const override;
+
+    /// Makes slice of the current column.
+    ColumnRef Slice(size_t begin, size_t len) override;
+
+    /// Makes column of the rows selected by the mask.
+    ColumnRef Filter(const uint8_t* mask) const override;
+
+    /// Makes column of the rows at given positions.
+    ColumnRef Take(const uint32_t* indices, size_t count) const override;
+
+    /// Returns count of bytes of memory held by the column data.
+    size_t MemoryUsage() const override;
+
+    /// Preallocates memory for given total count of rows.
+    void Reserve(size_t rows) override;
+
+    /// Releases memory reserved beyond the current content.
+    void ShrinkToFit() override;
+
+    /// Returns true if nested columns are not referenced from outside.
+    bool IsExclusivelyOwned() const override;
+
+protected:
+    template <typename, typename> friend class ColumnMapT;
+
+    /// Returns true if keys and values columns have at most given count
+    /// of references and the nested columns are exclusively owned.
+    bool OwnsNested(long element_references) const;
+
+    inline size_t GetOffset(size_t n) const {
+        return data_->GetOffset(n);
+    }
+
+    inline size_t GetSize(size_t n) const {
+        return data_->GetSize(n);
+    }
+
+protected:
+    std::shared_ptr<ColumnArray> data_;
+    std::shared_ptr<ColumnTuple> tuple_;
+};
+
+/**
+ * Represents column of Map(K, V) with key and value columns of known types.
+ *
+ * Rows are accessed through views into the key and value columns, without
+ * allocation of intermediate containers.  Views are invalidated by
+ * modification of the column.
+ */
+template <typename KeyColumnType, typename ValueColumnType>
+class ColumnMapT : public ColumnMap {
+public:
+    /// View of one row of the column.
+    class MapValueView {
+    public:
+        using KeyType = std::decay_t<decltype(std::declval<const KeyColumnType&>()[0])>;
+        using ValueType = std::decay_t<decltype(std::declval<const ValueColumnType&>()[0])>;
+
+        class Iterator {
+        public:
+            inline Iterator(const KeyColumnType* keys, const ValueColumnType* values, size_t pos) noexcept
+                : keys_(keys)
+                , values_(values)
+                , pos_(pos)
+            { }
+
+            /// Returns pair of the key and the value.
+            inline auto operator * () const {
+                return std::pair<decltype(Key()), decltype(Value())>(Key(), Value());
+            }
+
+            inline decltype(auto) Key() const {
+                return (*keys_)[pos_];
+            }
+
+            inline decltype(auto) Value() const {
+                return (*values_)[pos_];
+            }
+
+            inline Iterator& operator ++ () noexcept {
+                ++pos_;
+                return *this;
+            }
+
+            inline bool operator == (const Iterator& other) const noexcept {
+                return pos_ == other.pos_ && keys_ == other.keys_;
+            }
+
+            inline bool operator != (const Iterator& other) const noexcept {
+                return !(*this == other);
+            }
+
+        private:
+            const KeyColumnType* keys_;
+            const ValueColumnType* values_;
+            size_t pos_;
+        };
+
+        inline MapValueView(const KeyColumnType* keys, const ValueColumnType* values, size_t offset, size_t size) noexcept
+            : keys_(keys)
+            , values_(values)
+            , offset_(offset)
+            , size_(size)
+        { }
+
+        /// Returns key of the entry at given position.
+        inline decltype(auto) Key(size_t n) const {
+            return (*keys_)[offset_ + n];
+        }
+
+        /// Returns value of the entry at given position.
+        inline decltype(auto) Value(size_t n) const {
+            return (*values_)[offset_ + n];
+        }
+
+        /// Returns iterator to the first entry with given key or end().
+        /// Lookup is a linear scan, as maps usually have few entries.
+        template <typename K>
+        inline Iterator Find(const K& key) const {
+            for (size_t i = 0; i < size_; ++i) {
+                if (Key(i) == key) {
+                    return Iterator(keys_, values_, offset_ + i);
+                }
+            }
+            return end();
+        }
+
+        /// Returns true if the map contains given key.
+        template <typename K>
+        inline bool Has(const K& key) const {
+            return Find(key) != end();
+        }
+
+        /// Returns value of given key or throws std::out_of_range.
+        template <typename K>
+        inline decltype(auto) At(const K& key) const {
+            const Iterator it = Find(key);
+            if (it == end()) {
+                throw std::out_of_range("key not found in map");
+            }
+            return it.Value();
+        }
+
+        inline size_t Size() const noexcept {
+            return size_;
+        }
+
+        inline bool Empty() const noexcept {
+            return size_ == 0;
+        }
+
+        inline Iterator begin() const noexcept {
+            return Iterator(keys_, values_, offset_);
+        }
+
+        inline Iterator end() const noexcept {
+            return Iterator(keys_, values_, offset_ + size_);
+        }
+
+    private:
+        const KeyColumnType* keys_;
+        const ValueColumnType* values_;
+        size_t offset_;
+        size_t size_;
+    };
+
+    ColumnMapT(std::shared_ptr<KeyColumnType> keys, std::shared_ptr<ValueColumnType> values)
+        : ColumnMap(keys, values)
+        , typed_keys_(std::move(keys))
+        , typed_values_(std::move(values))
+    {
+    }
+
+    /// Makes typed column sharing data with the given map column.
+    /// Throws if keys or values are not of the requested column types.
+    static std::shared_ptr<ColumnMapT> Wrap(ColumnRef column) {
+        if (auto typed = std::dynamic_pointer_cast<ColumnMapT>(column)) {
+            return typed;
+        }
+
+        auto map = column->As<ColumnMap>();
+        if (!map) {
+            throw std::runtime_error("can't wrap column of type " + column->Type()->GetName() + " as map");
+        }
+
+        auto keys = map->GetKeys()->template As<KeyColumnType>();
+        auto values = map->GetValues()->template As<ValueColumnType>();
+        if (!keys || !values) {
+            throw std::runtime_error("can't wrap map of type " + column->Type()->GetName());
+        }
+
+        return std::shared_ptr<ColumnMapT>(new ColumnMapT(map->data_, std::move(keys), std::move(values)));
+    }
+
+    /// Returns view of the map at given row number.
+    inline MapValueView At(size_t n) const {
+        if (n >= Size()) {
+            throw std::out_of_range("row index is out of range: " + std::to_string(n));
+        }
+        return (*this)[n];
+    }
+
+    /// Returns view of the map at given row number.
+    inline MapValueView operator [] (size_t n) const {
+        return MapValueView(typed_keys_.get(), typed_values_.get(), GetOffset(n), GetSize(n));
+    }
+
+public:
+    /// Makes slice of the current column.
+    ColumnRef Slice(size_t begin, size_t len) override {
+        return Wrap(ColumnMap::Slice(begin, len));
+    }
+
+    /// Makes column of the rows selected by the mask.
+    ColumnRef Filter(const uint8_t* mask) const override {
+        return Wrap(ColumnMap::Filter(mask));
+    }
+
+    /// Makes column of the rows at given positions.
+    ColumnRef Take(const uint32_t* indices, size_t count) const override {
+        return Wrap(ColumnMap::Take(indices, count));
+    }
+
+    /// Returns true if nested columns are not referenced from outside.
+    bool IsExclusivelyOwned() const override {
+        // Keys and values are referenced by typed_keys_ and typed_values_.
+        return OwnsNested(2);
+    }
+
+private:
+    ColumnMapT(std::shared_ptr<ColumnArray> data, std::shared_ptr<KeyColumnType> keys, std::shared_ptr<ValueColumnType> values)
+        : ColumnMap(std::move(data))
+        , typed_keys_(std::move(keys))
+        , typed_values_(std::move(values))
+    {
+    }
+
+private:
+    std::shared_ptr<KeyColumnType> typed_keys_;
+    std::shared_ptr<ValueColumnType> typed_values_;
+};
+
+}
@@ -2,8 +2,10 @@
 #pragma once
 
 #include "column.h"
+#include "utils.h"
 
 #include <stdexcept>
+#include <string>
 
 namespace clickhouse {
 
@@ -38,6 +40,21 @@ public:
 		return std::make_shared<ColumnNothing>(len);
 	}
 
+    /// Makes column of the rows selected by the mask.
+    ColumnRef Filter(const uint8_t* mask) const override {
+		return std::make_shared<ColumnNothing>(CountNonZero(mask, size_));
+	}
+
+    /// Makes column of the rows at given positions.
+    ColumnRef Take(const uint32_t* indices, size_t count) const override {
+		for (size_t i = 0; i < count; ++i) {
+			if (indices[i] >= size_) {
+				throw std::out_of_range("row index is out of range: " + std::to_string(indices[i]));
+			}
+		}
+		return std::make_shared<ColumnNothing>(count);
+	}
+
 public:
     /// Appends content of given column to the end of current one.
     void Append(ColumnRef column) override {
@@ -64,6 +81,15 @@ public:
     /// Returns count of rows in the column.
     size_t Size() const override { return size_; }
 
+    /// Returns count of bytes of memory held by the column data.
+    size_t MemoryUsage() const override { return 0; }
+
+    /// Preallocates memory for given total count of rows.
+    void Reserve(size_t) override { }
+
+    /// Releases memory reserved beyond the current content.
+    void ShrinkToFit() override { }
+
 private:
 	size_t size_;
 };
@@ -1,12 +1,63 @@
 #include "nullable.h"
+#include "utils.h"
 
 #include <assert.h>
 #include <stdexcept>
 
 namespace clickhouse {
+namespace {
+
+/// Returns position of the first byte which is zero (nonzero == false)
+/// or not zero (nonzero == true) at or after from, or size.
+size_t FindByte(const uint8_t* data, size_t from, size_t size, bool nonzero) {
+    size_t i = from;
+
+#if defined(CLICKHOUSE_COLUMNS_SSE2)
+    for (; i + 16 <= size; i += 16) {
+        const uint32_t mask = nonzero ? (~ZeroMask16(data + i) & 0xFFFF) : ZeroMask16(data + i);
+        if (mask) {
+            return i + CountTrailingZeros(mask);
+        }
+    }
+#endif
+    for (; i < size; ++i) {
+        if ((data[i] != 0) == nonzero) {
+            return i;
+        }
+    }
+
+    return size;
+}
+
+void PackBits(const uint8_t* data, size_t size, uint8_t* bitmap, bool invert) {
+    size_t i = 0;
+
+#if defined(CLICKHOUSE_COLUMNS_SSE2)
+    for (; i + 16 <= size; i += 16) {
+        // Bits of zero bytes, i.e. inverted flags.
+        uint32_t mask = ZeroMask16(data + i);
+        if (!invert) {
+            mask = ~mask;
+        }
+        bitmap[i / 8] = static_cast<uint8_t>(mask);
+        bitmap[i / 8 + 1] = static_cast<uint8_t>(mask >> 8);
+    }
+#endif
+    for (; i < size; i += 8) {
+        uint8_t byte = 0;
+        for (size_t j = 0; j < 8 && i + j < size; ++j) {
+            if ((data[i + j] != 0) != invert) {
+                byte |= uint8_t(1) << j;
+            }
+        }
+        bitmap[i / 8] = byte;
+    }
+}
+
+}
 
 ColumnNullable::ColumnNullable(ColumnRef nested, ColumnRef nulls)
-    : Column(Type::CreateNullable(nested->Type()))
+    : Column(Type::CreateNullable(nested->Type()), nested->GetMemoryResource())
     , nested_(nested)
     , nulls_(nulls->As<ColumnUInt8>())
 {
@@ -19,6 +70,38 @@ bool ColumnNullable::IsNull(size_t n) const {
     return nulls_->At(n) != 0;
 }
 
+size_t ColumnNullable::NullCount() const {
+    return CountNonZero(nulls_->GetData().data(), nulls_->Size());
+}
+
+bool ColumnNullable::HasNull() const {
+    return FindNextNull(0) != nulls_->Size();
+}
+
+bool ColumnNullable::AllNull() const {
+    return FindNextNonNull(0) == nulls_->Size();
+}
+
+size_t ColumnNullable::FindNextNull(size_t from) const {
+    const size_t size = nulls_->Size();
+    if (from >= size) {
+        return size;
+    }
+    return FindByte(nulls_->GetData().data(), from, size, true);
+}
+
+size_t ColumnNullable::FindNextNonNull(size_t from) const {
+    const size_t size = nulls_->Size();
+    if (from >= size) {
+        return size;
+    }
+    return FindByte(nulls_->GetData().data(), from, size, false);
+}
+
+void ColumnNullable::GetNullBitmap(uint8_t* bitmap, bool valid_bits) const {
+    PackBits(nulls_->GetData().data(), nulls_->Size(), bitmap, valid_bits);
+}
+
 ColumnRef ColumnNullable::Nested() const {
     return nested_;
 }
@@ -43,16 +126,25 @@ void ColumnNullable::Clear() {
     nulls_->Clear();
 }
 
+bool ColumnNullable::LoadPrefix(CodedInputStream* input, size_t rows) {
+    return nested_->LoadPrefix(input, rows);
+}
+
 bool ColumnNullable::Load(CodedInputStream* input, size_t rows) {
     if (!nulls_->Load(input, rows)) {
         return false;
     }
+
     if (!nested_->Load(input, rows)) {
         return false;
     }
     return true;
 }
 
+void ColumnNullable::SavePrefix(CodedOutputStream* output) {
+    nested_->SavePrefix(output);
+}
+
 void ColumnNullable::Save(CodedOutputStream* output) {
     nulls_->Save(output);
     nested_->Save(output);
@@ -64,7 +156,33 @@ size_t ColumnNullable::Size() const {
 }
 
 ColumnRef ColumnNullable::Slice(size_t begin, size_t len) {
-    return std::make_shared<ColumnNullable>(nested_->Slice(begin, len), nulls_->Slice(begin, len));
+    return MakeColumn<ColumnNullable>(resource_, nested_->Slice(begin, len), nulls_->Slice(begin, len));
+}
+
+ColumnRef ColumnNullable::Filter(const uint8_t* mask) const {
+    return MakeColumn<ColumnNullable>(resource_, nested_->Filter(mask), nulls_->Filter(mask));
+}
+
+ColumnRef ColumnNullable::Take(const uint32_t* indices, size_t count) const {
+    return MakeColumn<ColumnNullable>(resource_, nested_->Take(indices, count), nulls_->Take(indices, count));
+}
+
+size_t ColumnNullable::MemoryUsage() const {
+    return nested_->MemoryUsage() + nulls_->MemoryUsage();
+}
+
+void ColumnNullable::Reserve(size_t rows) {
+    nested_->Reserve(rows);
+    nulls_->Reserve(rows);
+}
+
+void ColumnNullable::ShrinkToFit() {
+    nested_->ShrinkToFit();
+    nulls_->ShrinkToFit();
+}
+
+bool ColumnNullable::IsExclusivelyOwned() const {
+    return IsNestedOwned(nested_) && IsNestedOwned(nulls_);
 }
 
 }
@@ -15,6 +15,40 @@ public:
     /// Returns null flag at given row number.
     bool IsNull(size_t n) const;
 
+    /// Returns count of NULL rows.
+    /// Null flags may be changed through Nulls(), so the count is not
+    /// cached, each call scans them.
+    size_t NullCount() const;
+
+    /// Returns true if at least one row is NULL, stops at the first one.
+    /// When false, values of the nested column can be read without checks.
+    bool HasNull() const;
+
+    /// Returns true if all rows are NULL.
+    bool AllNull() const;
+
+    /// Returns position of the first NULL row at or after given one,
+    /// or Size() if there is no such row.
+    size_t FindNextNull(size_t from) const;
+
+    /// Returns position of the first non-NULL row at or after given one,
+    /// or Size() if there is no such row.
+    size_t FindNextNonNull(size_t from) const;
+
+    /// Packs null flags into a bitmap, row n maps to bit (n % 8) of byte n / 8.
+    /// A bit is set for NULL row, or for non-NULL row if valid_bits is true.
+    /// @param bitmap buffer of at least (Size() + 7) / 8 bytes.
+    void GetNullBitmap(uint8_t* bitmap, bool valid_bits = false) const;
+
+    /// Calls func(n) for each NULL row in ascending order.
+    template <typename Func>
+    void ForEachNull(Func&& func) const {
+        const size_t size = Size();
+        for (size_t n = FindNextNull(0); n < size; n = FindNextNull(n + 1)) {
+            func(n);
+        }
+    }
+
     /// Returns nested column.
     ColumnRef Nested() const;
 
@@ -25,9 +59,15 @@ public:
     /// Appends content of given column to the end of current one.
     void Append(ColumnRef column) override;
 
+    /// Loads column prefix from input stream.
+    bool LoadPrefix(CodedInputStream* input, size_t rows) override;
+
     /// Loads column data from input stream.
     bool Load(CodedInputStream* input, size_t rows) override;
 
+    /// Saves column prefix to output stream.
+    void SavePrefix(CodedOutputStream* output) override;
+
     /// Saves column data to output stream.
     void Save(CodedOutputStream* output) override;
 
@@ -40,6 +80,24 @@ public:
     /// Makes slice of the current column.
     ColumnRef Slice(size_t begin, size_t len) override;
 
+    /// Makes column of the rows selected by the mask.
+    ColumnRef Filter(const uint8_t* mask) const override;
+
+    /// Makes column of the rows at given positions.
+    ColumnRef Take(const uint32_t* indices, size_t count) const override;
+
+    /// Returns count of bytes of memory held by the column data.
+    size_t MemoryUsage() const override;
+
+    /// Preallocates memory for given total count of rows.
+    void Reserve(size_t rows) override;
+
+    /// Releases memory reserved beyond the current content.
+    void ShrinkToFit() override;
+
+    /// Returns true if nested columns are not referenced from outside.
+    bool IsExclusivelyOwned() const override;
+
 private:
     ColumnRef nested_;
     std::shared_ptr<ColumnUInt8> nulls_;
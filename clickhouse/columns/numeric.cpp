@@ -4,18 +4,27 @@
 namespace clickhouse {
 
 template <typename T>
-ColumnVector<T>::ColumnVector()
-    : Column(Type::CreateSimple<T>())
+ColumnVector<T>::ColumnVector(std::pmr::memory_resource* resource)
+    : Column(Type::CreateSimple<T>(), resource)
+    , data_(resource)
 {
 }
 
 template <typename T>
-ColumnVector<T>::ColumnVector(const std::vector<T>& data)
-    : Column(Type::CreateSimple<T>())
-    , data_(data)
+ColumnVector<T>::ColumnVector(const std::vector<T>& data, std::pmr::memory_resource* resource)
+    : Column(Type::CreateSimple<T>(), resource)
+    , data_(data.begin(), data.end(), resource)
 {
 }
 
+template <typename T>
+ColumnVector<T>::ColumnVector(std::vector<T>&& data, std::pmr::memory_resource* resource)
+    : Column(Type::CreateSimple<T>(), resource)
+    , data_(std::make_move_iterator(data.begin()), std::make_move_iterator(data.end()), resource)
+{
+    data.clear();
+}
+
 template <typename T>
 void ColumnVector<T>::Append(const T& value) {
     data_.push_back(value);
@@ -31,11 +40,6 @@ const T& ColumnVector<T>::At(size_t n) const {
     return data_.at(n);
 }
 
-template <typename T>
-const T& ColumnVector<T>::operator [] (size_t n) const {
-    return data_[n];
-}
-
 template <typename T>
 void ColumnVector<T>::Append(ColumnRef column) {
     if (auto col = column->As<ColumnVector<T>>()) {
@@ -62,7 +66,38 @@ size_t ColumnVector<T>::Size() const {
 
 template <typename T>
 ColumnRef ColumnVector<T>::Slice(size_t begin, size_t len) {
-    return std::make_shared<ColumnVector<T>>(SliceVector(data_, begin, len));
+    auto result = MakeColumn<ColumnVector<T>>(resource_);
+    result->data_ = SliceVector(data_, begin, len);
+    return result;
+}
+
+template <typename T>
+ColumnRef ColumnVector<T>::Filter(const uint8_t* mask) const {
+    auto result = MakeColumn<ColumnVector<T>>(resource_);
+    result->data_ = FilterVector(data_, mask);
+    return result;
+}
+
+template <typename T>
+ColumnRef ColumnVector<T>::Take(const uint32_t* indices, size_t count) const {
+    auto result = MakeColumn<ColumnVector<T>>(resource_);
+    result->data_ = TakeVector(data_, indices, count);
+    return result;
+}
+
+template <typename T>
+size_t ColumnVector<T>::MemoryUsage() const {
+    return data_.capacity() * sizeof(T);
+}
+
+template <typename T>
+void ColumnVector<T>::Reserve(size_t rows) {
+    data_.reserve(rows);
+}
+
+template <typename T>
+void ColumnVector<T>::ShrinkToFit() {
+    data_.shrink_to_fit();
 }
 
 template class ColumnVector<int8_t>;
@@ -75,6 +110,9 @@ template class ColumnVector<uint16_t>;
 template class ColumnVector<uint32_t>;
 template class ColumnVector<uint64_t>;
 template class ColumnVector<Int128>;
+template class ColumnVector<Int256>;
+template class ColumnVector<absl::uint128>;
+template class ColumnVector<UInt256>;
 
 template class ColumnVector<float>;
 template class ColumnVector<double>;
@@ -1,7 +1,7 @@
 #pragma once
 
 #include "column.h"
-#include "absl/numeric/int128.h"
+#include "../base/wide_integer.h"
 
 namespace clickhouse {
 
@@ -13,18 +13,35 @@ class ColumnVector : public Column {
 public:
     using DataType = T;
 
-    ColumnVector();
+    explicit ColumnVector(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 
-    explicit ColumnVector(const std::vector<T>& data);
+    explicit ColumnVector(const std::vector<T>& data, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    /// Kept for compatibility, the elements are copied into storage
+    /// allocated from the resource.
+    explicit ColumnVector(std::vector<T>&& data, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 
     /// Appends one element to the end of column.
     void Append(const T& value);
 
+    /// Appends elements of the range to the end of column.
+    template <typename Iterator>
+    inline void Append(Iterator begin, Iterator end) {
+        data_.insert(data_.end(), begin, end);
+    }
+
     /// Returns element at given row number.
     const T& At(size_t n) const;
 
     /// Returns element at given row number.
-    const T& operator [] (size_t n) const;
+    inline const T& operator [] (size_t n) const {
+        return data_[n];
+    }
+
+    /// Returns contiguous storage of the elements.
+    inline const std::pmr::vector<T>& GetData() const noexcept {
+        return data_;
+    }
 
 public:
     /// Appends content of given column to the end of current one.
@@ -45,8 +62,23 @@ public:
     /// Makes slice of the current column.
     ColumnRef Slice(size_t begin, size_t len) override;
 
+    /// Makes column of the rows selected by the mask.
+    ColumnRef Filter(const uint8_t* mask) const override;
+
+    /// Makes column of the rows at given positions.
+    ColumnRef Take(const uint32_t* indices, size_t count) const override;
+
+    /// Returns count of bytes of memory held by the column data.
+    size_t MemoryUsage() const override;
+
+    /// Preallocates memory for given total count of rows.
+    void Reserve(size_t rows) override;
+
+    /// Releases memory reserved beyond the current content.
+    void ShrinkToFit() override;
+
 private:
-    std::vector<T> data_;
+    std::pmr::vector<T> data_;
 };
 
 using Int128 = absl::int128;
@@ -55,12 +87,15 @@ using ColumnUInt8   = ColumnVector<uint8_t>;
 using ColumnUInt16  = ColumnVector<uint16_t>;
 using ColumnUInt32  = ColumnVector<uint32_t>;
 using ColumnUInt64  = ColumnVector<uint64_t>;
+using ColumnUInt128 = ColumnVector<absl::uint128>;
+using ColumnUInt256 = ColumnVector<UInt256>;
 
 using ColumnInt8    = ColumnVector<int8_t>;
 using ColumnInt16   = ColumnVector<int16_t>;
 using ColumnInt32   = ColumnVector<int32_t>;
 using ColumnInt64   = ColumnVector<int64_t>;
 using ColumnInt128  = ColumnVector<Int128>;
+using ColumnInt256  = ColumnVector<Int256>;
 
 using ColumnFloat32 = ColumnVector<float>;
 using ColumnFloat64 = ColumnVector<double>;
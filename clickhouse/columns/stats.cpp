@@ -0,0 +1,337 @@
+#include "stats.h"
+#include "date.h"
+#include "decimal.h"
+#include "enum.h"
+#include "hash.h"
+#include "lowcardinality.h"
+#include "nullable.h"
+#include "string.h"
+#include "utils.h"
+
+#include <cityhash/city.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+namespace clickhouse {
+
+void HyperLogLog::Add(uint64_t hash) {
+    const size_t index = static_cast<size_t>(hash >> (64 - kBits));
+    // Position of the first set bit among the rest of the bits, the
+    // sentinel bit bounds it.
+    const uint64_t rest = (hash << kBits) | (uint64_t(1) << (kBits - 1));
+    const uint8_t rank = static_cast<uint8_t>(CountLeadingZeros64(rest) + 1);
+    registers_[index] = std::max(registers_[index], rank);
+}
+
+void HyperLogLog::Merge(const HyperLogLog& other) {
+    for (size_t i = 0; i < registers_.size(); ++i) {
+        registers_[i] = std::max(registers_[i], other.registers_[i]);
+    }
+}
+
+uint64_t HyperLogLog::Estimate() const {
+    const double m = static_cast<double>(registers_.size());
+    double sum = 0;
+    size_t zeros = 0;
+
+    for (uint8_t rank : registers_) {
+        sum += std::ldexp(1.0, -rank);
+        zeros += rank == 0;
+    }
+
+    const double estimate = 0.7213 / (1 + 1.079 / m) * m * m / sum;
+    // Small counts are estimated better by count of empty registers.
+    if (estimate <= 2.5 * m && zeros) {
+        return static_cast<uint64_t>(std::llround(m * std::log(m / zeros)));
+    }
+    return static_cast<uint64_t>(std::llround(estimate));
+}
+
+namespace {
+
+/// Values which are read by copying are processed by chunks.
+constexpr size_t kChunkSize = 1024;
+
+template <typename T>
+inline uint64_t HashOf(T value) {
+    return HashValue(value);
+}
+
+inline uint64_t HashOf(const Int128& value) {
+    return IntHash64(absl::Int128Low64(value) ^ IntHash64(static_cast<uint64_t>(absl::Int128High64(value))));
+}
+
+/// Min, max, sum and distinct count of values of type T.  Loops over
+/// values are kept free of branches, so compilers vectorize them.
+template <typename T>
+class Accumulator {
+    static constexpr bool kFloat = std::is_floating_point<T>::value;
+    /// Sum of Int128 values may overflow, it is not computed.
+    static constexpr bool kSum = !std::is_same<T, Int128>::value;
+
+    using Sum = std::conditional_t<kFloat, double, Int128>;
+
+public:
+    /// Adds values, except those with nonzero null flags if nulls is set.
+    void Add(const T* values, const uint8_t* nulls, size_t size) {
+        if (nulls) {
+            AddValues<true>(values, nulls, size);
+        } else {
+            AddValues<false>(values, nulls, size);
+        }
+    }
+
+    /// Stores min and max as values of type V.
+    template <typename V>
+    void Store(ColumnStats* stats, bool with_sum) const {
+        // NaNs only leave the range empty.
+        if (count_ && !(max_ < min_)) {
+            stats->min = static_cast<V>(min_);
+            stats->max = static_cast<V>(max_);
+        }
+        if constexpr (kSum) {
+            if (with_sum && count_) {
+                stats->sum = sum_;
+            }
+        }
+        stats->distinct = distinct_.Estimate();
+    }
+
+private:
+    template <bool kNulls>
+    void AddValues(const T* values, const uint8_t* nulls, size_t size) {
+        T min = min_;
+        T max = max_;
+
+        for (size_t i = 0; i < size; ++i) {
+            const T value = values[i];
+            const bool valid = !kNulls || !nulls[i];
+            min = (valid && value < min) ? value : min;
+            max = (valid && max < value) ? value : max;
+        }
+        min_ = min;
+        max_ = max;
+
+        if constexpr (kSum) {
+            sum_ += SumValues<kNulls>(values, nulls, size);
+        }
+
+        for (size_t i = 0; i < size; ++i) {
+            if (!kNulls || !nulls[i]) {
+                distinct_.Add(HashOf(values[i]));
+            }
+        }
+        count_ += kNulls ? size - CountNonZero(nulls, size) : size;
+    }
+
+    template <bool kNulls>
+    static Sum SumValues(const T* values, const uint8_t* nulls, size_t size) {
+        // Values up to 32 bits are summed in 64 bits, which don't
+        // overflow for any practical count of rows.
+        using Partial = std::conditional_t<std::is_integral<T>::value && sizeof(T) <= 4,
+            std::conditional_t<std::is_signed<T>::value, int64_t, uint64_t>, Sum>;
+
+        Partial sum = 0;
+        for (size_t i = 0; i < size; ++i) {
+            sum += (!kNulls || !nulls[i]) ? static_cast<Partial>(values[i]) : Partial(0);
+        }
+        return static_cast<Sum>(sum);
+    }
+
+    T min_ = kFloat ? std::numeric_limits<T>::infinity() : std::numeric_limits<T>::max();
+    T max_ = kFloat ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::lowest();
+    Sum sum_ = 0;
+    size_t count_ = 0;
+    HyperLogLog distinct_;
+};
+
+template <typename T, typename V>
+void CollectVector(const ColumnRef& column, const uint8_t* nulls, ColumnStats* stats) {
+    const auto& data = column->As<ColumnVector<T>>()->GetData();
+    Accumulator<T> acc;
+    acc.Add(data.data(), nulls, data.size());
+    acc.template Store<V>(stats, true);
+}
+
+/// Collects values of type T copied by get(begin, count, out).
+template <typename T, typename V, typename Get>
+void CollectChunks(size_t size, const uint8_t* nulls, bool with_sum, ColumnStats* stats, Get&& get) {
+    Accumulator<T> acc;
+    std::vector<T> chunk(std::min(size, kChunkSize));
+
+    for (size_t begin = 0; begin < size; begin += kChunkSize) {
+        const size_t count = std::min(kChunkSize, size - begin);
+        get(begin, count, chunk.data());
+        acc.Add(chunk.data(), nulls ? nulls + begin : nullptr, count);
+    }
+    acc.template Store<V>(stats, with_sum);
+}
+
+/// Collects dates in their native units, which cover the whole range of
+/// values unlike nanoseconds.
+template <typename C>
+void CollectDates(const ColumnRef& column, const uint8_t* nulls, ColumnStats* stats) {
+    const auto col = column->As<C>();
+    CollectChunks<int64_t, int64_t>(col->Size(), nulls, false, stats, [&col] (size_t begin, size_t count, int64_t* out) {
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = static_cast<int64_t>(col->At(begin + i));
+        }
+    });
+}
+
+template <typename T>
+void CollectEnum(const ColumnRef& column, const uint8_t* nulls, ColumnStats* stats) {
+    const auto col = column->As<ColumnEnum<T>>();
+    CollectChunks<T, int64_t>(col->Size(), nulls, false, stats, [&col] (size_t begin, size_t count, T* out) {
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = col->At(begin + i);
+        }
+    });
+}
+
+template <typename T>
+void CollectDecimal(const ColumnDecimal& col, const uint8_t* nulls, ColumnStats* stats) {
+    CollectChunks<T, Int128>(col.Size(), nulls, true, stats, [&col] (size_t begin, size_t count, T* out) {
+        col.GetMany(begin, count, out);
+    });
+}
+
+template <typename C>
+void CollectStrings(const ColumnRef& column, const uint8_t* nulls, ColumnStats* stats) {
+    const auto col = column->As<C>();
+    const size_t size = col->Size();
+    const std::string* min = nullptr;
+    const std::string* max = nullptr;
+    size_t min_length = std::numeric_limits<size_t>::max();
+    size_t max_length = 0;
+    size_t total_length = 0;
+    HyperLogLog distinct;
+
+    for (size_t i = 0; i < size; ++i) {
+        if (nulls && nulls[i]) {
+            continue;
+        }
+        const std::string& value = (*col)[i];
+        min_length = std::min(min_length, value.size());
+        max_length = std::max(max_length, value.size());
+        total_length += value.size();
+        if (!min || value < *min) {
+            min = &value;
+        }
+        if (!max || *max < value) {
+            max = &value;
+        }
+        distinct.Add(CityHash64(value.data(), value.size()));
+    }
+
+    if (min) {
+        stats->min = *min;
+        stats->max = *max;
+        stats->min_length = min_length;
+        stats->max_length = max_length;
+        stats->total_length = total_length;
+    }
+    stats->distinct = distinct.Estimate();
+}
+
+/// Collects statistics of values of the column, skipping rows flagged
+/// in nulls if it is set.
+void Collect(const ColumnRef& column, const uint8_t* nulls, ColumnStats* stats) {
+    switch (column->Type()->GetCode()) {
+        case Type::Int8:    return CollectVector<int8_t, int64_t>(column, nulls, stats);
+        case Type::Int16:   return CollectVector<int16_t, int64_t>(column, nulls, stats);
+        case Type::Int32:   return CollectVector<int32_t, int64_t>(column, nulls, stats);
+        case Type::Int64:   return CollectVector<int64_t, int64_t>(column, nulls, stats);
+        case Type::Int128:  return CollectVector<Int128, Int128>(column, nulls, stats);
+        case Type::UInt8:   return CollectVector<uint8_t, uint64_t>(column, nulls, stats);
+        case Type::UInt16:  return CollectVector<uint16_t, uint64_t>(column, nulls, stats);
+        case Type::UInt32:  return CollectVector<uint32_t, uint64_t>(column, nulls, stats);
+        case Type::UInt64:  return CollectVector<uint64_t, uint64_t>(column, nulls, stats);
+        case Type::Float32: return CollectVector<float, double>(column, nulls, stats);
+        case Type::Float64: return CollectVector<double, double>(column, nulls, stats);
+
+        case Type::Date:       return CollectDates<ColumnDate>(column, nulls, stats);
+        case Type::Date32:     return CollectDates<ColumnDate32>(column, nulls, stats);
+        case Type::DateTime:   return CollectDates<ColumnDateTime>(column, nulls, stats);
+        case Type::DateTime64: return CollectDates<ColumnDateTime64>(column, nulls, stats);
+
+        case Type::Enum8:  return CollectEnum<int8_t>(column, nulls, stats);
+        case Type::Enum16: return CollectEnum<int16_t>(column, nulls, stats);
+
+        case Type::Decimal:
+        case Type::Decimal32:
+        case Type::Decimal64:
+        case Type::Decimal128: {
+            // Values are read as the narrowest type which holds them.
+            const auto col = column->As<ColumnDecimal>();
+            if (col->GetPrecision() <= 9) {
+                return CollectDecimal<int32_t>(*col, nulls, stats);
+            } else if (col->GetPrecision() <= 18) {
+                return CollectDecimal<int64_t>(*col, nulls, stats);
+            } else if (col->GetPrecision() <= 38) {
+                return CollectDecimal<Int128>(*col, nulls, stats);
+            }
+            return;
+        }
+
+        case Type::String:      return CollectStrings<ColumnString>(column, nulls, stats);
+        case Type::FixedString: return CollectStrings<ColumnFixedString>(column, nulls, stats);
+
+        default:
+            return;
+    }
+}
+
+void CollectLowCardinality(const ColumnLowCardinality& col, ColumnStats* stats) {
+    const auto dictionary = col.GetDictionary();
+    const size_t size = col.Size();
+    std::vector<size_t> uses(dictionary->Size());
+
+    for (size_t i = 0; i < size; ++i) {
+        ++uses[col.GetIndex(i)];
+    }
+    if (col.IsNullable() && !uses.empty()) {
+        stats->null_count = uses[0];
+        uses[0] = 0;
+    }
+
+    // Range and distinct count are those of the used dictionary values.
+    std::vector<uint8_t> used(uses.size());
+    for (size_t i = 0; i < uses.size(); ++i) {
+        used[i] = uses[i] != 0;
+    }
+    Collect(dictionary->Filter(used.data()), nullptr, stats);
+    stats->sum = std::monostate();
+
+    if (auto strings = dictionary->As<ColumnString>()) {
+        stats->total_length = 0;
+        for (size_t i = 0; i < uses.size(); ++i) {
+            stats->total_length += uses[i] * (*strings)[i].size();
+        }
+    }
+}
+
+}
+
+ColumnStats ComputeStats(const ColumnRef& column) {
+    ColumnStats stats;
+    stats.rows = column->Size();
+
+    if (auto nullable = column->As<ColumnNullable>()) {
+        stats.null_count = nullable->NullCount();
+        const uint8_t* nulls = stats.null_count ? nullable->Nulls()->As<ColumnUInt8>()->GetData().data() : nullptr;
+        Collect(nullable->Nested(), nulls, &stats);
+    } else if (auto lc = column->As<ColumnLowCardinality>()) {
+        CollectLowCardinality(*lc, &stats);
+    } else {
+        Collect(column, nullptr, &stats);
+    }
+
+    return stats;
+}
+
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "column.h"
+#include "numeric.h"
+
+#include <array>
+#include <string>
+#include <variant>
+
+namespace clickhouse {
+
+/**
+ * HyperLogLog sketch of 64-bit hashes with 4096 registers.  Estimates
+ * count of distinct hashes with standard error of about 1.6%.
+ */
+class HyperLogLog {
+public:
+    /// Adds hash of a value.  Hashes must be uniformly distributed.
+    void Add(uint64_t hash);
+
+    /// Adds hashes added to other sketch.
+    void Merge(const HyperLogLog& other);
+
+    /// Returns estimate of count of distinct hashes.
+    uint64_t Estimate() const;
+
+private:
+    static constexpr size_t kBits = 12;
+
+    std::array<uint8_t, size_t(1) << kBits> registers_{};
+};
+
+/**
+ * Statistics of values of a column.  NULLs are counted by null_count and
+ * don't take part in other statistics.
+ */
+struct ColumnStats {
+    /// Value of min, max or sum: int64_t for signed integers and enums,
+    /// uint64_t for unsigned integers, double for floats, Int128 for
+    /// Int128 and for unscaled values of decimals, std::string for
+    /// strings.  Date, Date32 and DateTime columns have int64_t seconds
+    /// since epoch, DateTime64 columns have int64_t ticks of their
+    /// precision.  std::monostate stands for no value.
+    using Value = std::variant<std::monostate, int64_t, uint64_t, double, Int128, std::string>;
+
+    size_t rows = 0;
+    size_t null_count = 0;
+
+    /// Least and greatest values.  Strings are compared lexicographically,
+    /// NaNs are skipped.
+    Value min;
+    Value max;
+    /// Sum of values of numeric columns and decimals up to 18 digits,
+    /// Int128 for integers and decimals and double for floats.  It is not
+    /// computed for Int128, wider decimals and LowCardinality columns.
+    Value sum;
+
+    /// Lengths of strings of String and FixedString columns.
+    size_t min_length = 0;
+    size_t max_length = 0;
+    size_t total_length = 0;
+
+    /// Estimate of count of distinct values, computed with HyperLogLog.
+    uint64_t distinct = 0;
+};
+
+/// Computes statistics of the column in a pass over its values.  Columns
+/// of numeric, date and time, Enum, Decimal up to 38 digits, String and
+/// FixedString types are supported, as well as Nullable and LowCardinality
+/// of them.  Only counts of rows and NULLs are computed for other columns.
+ColumnStats ComputeStats(const ColumnRef& column);
+
+}
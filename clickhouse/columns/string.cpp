@@ -4,26 +4,50 @@
 #include "../base/wire_format.h"
 
 namespace clickhouse {
+namespace {
 
-ColumnFixedString::ColumnFixedString(size_t n)
-    : Column(Type::CreateString(n))
+/// Bytes of heap memory held by a string, zero for strings stored inline.
+inline size_t HeapSize(const std::string& str) {
+    static const size_t kInlineCapacity = std::string().capacity();
+    return str.capacity() > kInlineCapacity ? str.capacity() + 1 : 0;
+}
+
+size_t HeapSize(std::pmr::vector<std::string>::const_iterator begin, std::pmr::vector<std::string>::const_iterator end) {
+    size_t size = 0;
+    for (; begin != end; ++begin) {
+        size += HeapSize(*begin);
+    }
+    return size;
+}
+
+}
+
+ColumnFixedString::ColumnFixedString(size_t n, std::pmr::memory_resource* resource)
+    : Column(Type::CreateString(n), resource)
     , string_size_(n)
+    , data_(resource)
 {
 }
 
 void ColumnFixedString::Append(const std::string& str) {
     data_.push_back(str);
     data_.back().resize(string_size_);
+    heap_size_ += HeapSize(data_.back());
 }
 
 void ColumnFixedString::Clear() {
     data_.clear();
+    heap_size_ = 0;
 }
 
 const std::string& ColumnFixedString::At(size_t n) const {
     return data_.at(n);
 }
 
+size_t ColumnFixedString::FixedSize() const {
+    return string_size_;
+}
+
 const std::string& ColumnFixedString::operator [] (size_t n) const {
     return data_[n];
 }
@@ -31,7 +55,9 @@ const std::string& ColumnFixedString::operator [] (size_t n) const {
 void ColumnFixedString::Append(ColumnRef column) {
     if (auto col = column->As<ColumnFixedString>()) {
         if (string_size_ == col->string_size_) {
+            const size_t size = data_.size();
             data_.insert(data_.end(), col->data_.begin(), col->data_.end());
+            heap_size_ += HeapSize(data_.begin() + size, data_.end());
         }
     }
 }
@@ -45,6 +71,7 @@ bool ColumnFixedString::Load(CodedInputStream* input, size_t rows) {
             return false;
         }
 
+        heap_size_ += HeapSize(s);
         data_.push_back(std::move(s));
     }
 
@@ -62,33 +89,64 @@ size_t ColumnFixedString::Size() const {
 }
 
 ColumnRef ColumnFixedString::Slice(size_t begin, size_t len) {
-    auto result = std::make_shared<ColumnFixedString>(string_size_);
+    auto result = MakeColumn<ColumnFixedString>(resource_, string_size_);
 
     if (begin < data_.size()) {
         result->data_ = SliceVector(data_, begin, len);
+        result->heap_size_ = HeapSize(result->data_.begin(), result->data_.end());
     }
 
     return result;
 }
 
+ColumnRef ColumnFixedString::Filter(const uint8_t* mask) const {
+    auto result = MakeColumn<ColumnFixedString>(resource_, string_size_);
+    result->data_ = FilterVector(data_, mask);
+    result->heap_size_ = HeapSize(result->data_.begin(), result->data_.end());
+    return result;
+}
+
+ColumnRef ColumnFixedString::Take(const uint32_t* indices, size_t count) const {
+    auto result = MakeColumn<ColumnFixedString>(resource_, string_size_);
+    result->data_ = TakeVector(data_, indices, count);
+    result->heap_size_ = HeapSize(result->data_.begin(), result->data_.end());
+    return result;
+}
+
+size_t ColumnFixedString::MemoryUsage() const {
+    return data_.capacity() * sizeof(std::string) + heap_size_;
+}
+
+void ColumnFixedString::Reserve(size_t rows) {
+    data_.reserve(rows);
+}
 
-ColumnString::ColumnString()
-    : Column(Type::CreateString())
+void ColumnFixedString::ShrinkToFit() {
+    data_.shrink_to_fit();
+}
+
+
+ColumnString::ColumnString(std::pmr::memory_resource* resource)
+    : Column(Type::CreateString(), resource)
+    , data_(resource)
 {
 }
 
-ColumnString::ColumnString(const std::vector<std::string>& data)
-    : Column(Type::CreateString())
-    , data_(data)
+ColumnString::ColumnString(const std::vector<std::string>& data, std::pmr::memory_resource* resource)
+    : Column(Type::CreateString(), resource)
+    , data_(data.begin(), data.end(), resource)
+    , heap_size_(HeapSize(data_.begin(), data_.end()))
 {
 }
 
 void ColumnString::Append(const std::string& str) {
     data_.push_back(str);
+    heap_size_ += HeapSize(data_.back());
 }
 
 void ColumnString::Clear() {
     data_.clear();
+    heap_size_ = 0;
 }
 
 const std::string& ColumnString::At(size_t n) const {
@@ -101,7 +159,9 @@ const std::string& ColumnString::operator [] (size_t n) const {
 
 void ColumnString::Append(ColumnRef column) {
     if (auto col = column->As<ColumnString>()) {
+        const size_t size = data_.size();
         data_.insert(data_.end(), col->data_.begin(), col->data_.end());
+        heap_size_ += HeapSize(data_.begin() + size, data_.end());
     }
 }
 
@@ -113,6 +173,7 @@ bool ColumnString::Load(CodedInputStream* input, size_t rows) {
             return false;
         }
 
+        heap_size_ += HeapSize(s);
         data_.push_back(std::move(s));
     }
 
@@ -130,7 +191,40 @@ size_t ColumnString::Size() const {
 }
 
 ColumnRef ColumnString::Slice(size_t begin, size_t len) {
-    return std::make_shared<ColumnString>(SliceVector(data_, begin, len));
+    auto result = MakeColumn<ColumnString>(resource_);
+    result->data_ = SliceVector(data_, begin, len);
+    result->heap_size_ = HeapSize(result->data_.begin(), result->data_.end());
+    return result;
+}
+
+ColumnRef ColumnString::Filter(const uint8_t* mask) const {
+    auto result = MakeColumn<ColumnString>(resource_);
+    result->data_ = FilterVector(data_, mask);
+    result->heap_size_ = HeapSize(result->data_.begin(), result->data_.end());
+    return result;
+}
+
+ColumnRef ColumnString::Take(const uint32_t* indices, size_t count) const {
+    auto result = MakeColumn<ColumnString>(resource_);
+    result->data_ = TakeVector(data_, indices, count);
+    result->heap_size_ = HeapSize(result->data_.begin(), result->data_.end());
+    return result;
+}
+
+size_t ColumnString::MemoryUsage() const {
+    return data_.capacity() * sizeof(std::string) + heap_size_;
+}
+
+void ColumnString::Reserve(size_t rows) {
+    data_.reserve(rows);
+}
+
+void ColumnString::ShrinkToFit() {
+    data_.shrink_to_fit();
+    for (auto& str : data_) {
+        str.shrink_to_fit();
+    }
+    heap_size_ = HeapSize(data_.begin(), data_.end());
 }
 
 }
@@ -9,7 +9,7 @@ namespace clickhouse {
  */
 class ColumnFixedString : public Column {
 public:
-    explicit ColumnFixedString(size_t n);
+    explicit ColumnFixedString(size_t n, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 
     /// Appends one element to the column.
     void Append(const std::string& str);
@@ -20,6 +20,9 @@ public:
     /// Returns element at given row number.
     const std::string& operator [] (size_t n) const;
 
+    /// Returns length of the strings.
+    size_t FixedSize() const;
+
 public:
     /// Appends content of given column to the end of current one.
     void Append(ColumnRef column) override;
@@ -39,9 +42,26 @@ public:
     /// Makes slice of the current column.
     ColumnRef Slice(size_t begin, size_t len) override;
 
+    /// Makes column of the rows selected by the mask.
+    ColumnRef Filter(const uint8_t* mask) const override;
+
+    /// Makes column of the rows at given positions.
+    ColumnRef Take(const uint32_t* indices, size_t count) const override;
+
+    /// Returns count of bytes of memory held by the column data.
+    size_t MemoryUsage() const override;
+
+    /// Preallocates memory for given total count of rows.
+    void Reserve(size_t rows) override;
+
+    /// Releases memory reserved beyond the current content.
+    void ShrinkToFit() override;
+
 private:
     const size_t string_size_;
-    std::vector<std::string> data_;
+    std::pmr::vector<std::string> data_;
+    /// Heap memory held by the strings.
+    size_t heap_size_ = 0;
 };
 
 /**
@@ -49,8 +69,8 @@ private:
  */
 class ColumnString : public Column {
 public:
-    ColumnString();
-    explicit ColumnString(const std::vector<std::string>& data);
+    explicit ColumnString(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+    explicit ColumnString(const std::vector<std::string>& data, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 
     /// Appends one element to the column.
     void Append(const std::string& str);
@@ -80,8 +100,25 @@ public:
     /// Makes slice of the current column.
     ColumnRef Slice(size_t begin, size_t len) override;
 
+    /// Makes column of the rows selected by the mask.
+    ColumnRef Filter(const uint8_t* mask) const override;
+
+    /// Makes column of the rows at given positions.
+    ColumnRef Take(const uint32_t* indices, size_t count) const override;
+
+    /// Returns count of bytes of memory held by the column data.
+    size_t MemoryUsage() const override;
+
+    /// Preallocates memory for given total count of rows.
+    void Reserve(size_t rows) override;
+
+    /// Releases memory reserved beyond the current content.
+    void ShrinkToFit() override;
+
 private:
-    std::vector<std::string> data_;
+    std::pmr::vector<std::string> data_;
+    /// Heap memory held by the strings.
+    size_t heap_size_ = 0;
 };
 
 }
@@ -11,7 +11,8 @@ static std::vector<TypeRef> CollectTypes(const std::vector<ColumnRef>& columns)
 }
 
 ColumnTuple::ColumnTuple(const std::vector<ColumnRef>& columns)
-    : Column(Type::CreateTuple(CollectTypes(columns)))
+    : Column(Type::CreateTuple(CollectTypes(columns)),
+             columns.empty() ? std::pmr::get_default_resource() : columns.front()->GetMemoryResource())
     , columns_(columns)
 {
 }
@@ -24,6 +25,30 @@ size_t ColumnTuple::Size() const {
     return columns_.empty() ? 0 : columns_[0]->Size();
 }
 
+void ColumnTuple::Append(ColumnRef column) {
+    auto col = column->As<ColumnTuple>();
+    if (!col || !col->Type()->IsEqual(type_)) {
+        return;
+    }
+    if (col.get() == this) {
+        col = Slice(0, Size())->As<ColumnTuple>();
+    }
+
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        columns_[i]->Append(col->columns_[i]);
+    }
+}
+
+bool ColumnTuple::LoadPrefix(CodedInputStream* input, size_t rows) {
+    for (auto ci = columns_.begin(); ci != columns_.end(); ++ci) {
+        if (!(*ci)->LoadPrefix(input, rows)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 bool ColumnTuple::Load(CodedInputStream* input, size_t rows) {
     for (auto ci = columns_.begin(); ci != columns_.end(); ++ci) {
         if (!(*ci)->Load(input, rows)) {
@@ -34,14 +59,88 @@ bool ColumnTuple::Load(CodedInputStream* input, size_t rows) {
     return true;
 }
 
+void ColumnTuple::SavePrefix(CodedOutputStream* output) {
+    for (auto ci = columns_.begin(); ci != columns_.end(); ++ci) {
+        (*ci)->SavePrefix(output);
+    }
+}
+
 void ColumnTuple::Save(CodedOutputStream* output) {
     for (auto ci = columns_.begin(); ci != columns_.end(); ++ci) {
         (*ci)->Save(output);
     }
 }
 
+ColumnRef ColumnTuple::Slice(size_t begin, size_t len) {
+    std::vector<ColumnRef> columns;
+
+    columns.reserve(columns_.size());
+    for (const auto& col : columns_) {
+        columns.push_back(col->Slice(begin, len));
+    }
+
+    return MakeColumn<ColumnTuple>(resource_, columns);
+}
+
+ColumnRef ColumnTuple::Filter(const uint8_t* mask) const {
+    std::vector<ColumnRef> columns;
+
+    columns.reserve(columns_.size());
+    for (const auto& col : columns_) {
+        columns.push_back(col->Filter(mask));
+    }
+
+    return MakeColumn<ColumnTuple>(resource_, columns);
+}
+
+ColumnRef ColumnTuple::Take(const uint32_t* indices, size_t count) const {
+    std::vector<ColumnRef> columns;
+
+    columns.reserve(columns_.size());
+    for (const auto& col : columns_) {
+        columns.push_back(col->Take(indices, count));
+    }
+
+    return MakeColumn<ColumnTuple>(resource_, columns);
+}
+
+size_t ColumnTuple::MemoryUsage() const {
+    size_t result = 0;
+    for (const auto& col : columns_) {
+        result += col->MemoryUsage();
+    }
+    return result;
+}
+
+void ColumnTuple::Reserve(size_t rows) {
+    for (auto& col : columns_) {
+        col->Reserve(rows);
+    }
+}
+
+void ColumnTuple::ShrinkToFit() {
+    for (auto& col : columns_) {
+        col->ShrinkToFit();
+    }
+}
+
+bool ColumnTuple::IsExclusivelyOwned() const {
+    return OwnsNested(1);
+}
+
+bool ColumnTuple::OwnsNested(long references) const {
+    for (const auto& col : columns_) {
+        if (!IsNestedOwned(col, references)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 void ColumnTuple::Clear() {
-    columns_.clear();
+    for (auto& col : columns_) {
+        col->Clear();
+    }
 }
 
 }
@@ -22,11 +22,17 @@ public:
 
 public:
     /// Appends content of given column to the end of current one.
-    void Append(ColumnRef) override { }
+    void Append(ColumnRef column) override;
+
+    /// Loads column prefix from input stream.
+    bool LoadPrefix(CodedInputStream* input, size_t rows) override;
 
     /// Loads column data from input stream.
     bool Load(CodedInputStream* input, size_t rows) override;
 
+    /// Saves column prefix to output stream.
+    void SavePrefix(CodedOutputStream* output) override;
+
     /// Saves column data to output stream.
     void Save(CodedOutputStream* output) override;
 
@@ -37,7 +43,32 @@ public:
     size_t Size() const override;
 
     /// Makes slice of the current column.
-    ColumnRef Slice(size_t, size_t) override { return ColumnRef(); }
+    ColumnRef Slice(size_t begin, size_t len) override;
+
+    /// Makes column of the rows selected by the mask.
+    ColumnRef Filter(const uint8_t* mask) const override;
+
+    /// Makes column of the rows at given positions.
+    ColumnRef Take(const uint32_t* indices, size_t count) const override;
+
+    /// Returns count of bytes of memory held by the column data.
+    size_t MemoryUsage() const override;
+
+    /// Preallocates memory for given total count of rows.
+    void Reserve(size_t rows) override;
+
+    /// Releases memory reserved beyond the current content.
+    void ShrinkToFit() override;
+
+    /// Returns true if nested columns are not referenced from outside.
+    bool IsExclusivelyOwned() const override;
+
+private:
+    friend class ColumnMap;
+
+    /// Returns true if every element column has at most given count of
+    /// references and is exclusively owned.
+    bool OwnsNested(long references) const;
 
 private:
     std::vector<ColumnRef> columns_;
@@ -1,13 +1,26 @@
 #pragma once
 
 #include <algorithm>
+#include <bitset>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   include <emmintrin.h>
+#   define CLICKHOUSE_COLUMNS_SSE2
+#endif
+
+#if defined(_MSC_VER)
+#   include <intrin.h>
+#endif
+
 namespace clickhouse {
 
-template <typename T>
-std::vector<T> SliceVector(const std::vector<T>& vec, size_t begin, size_t len) {
-    std::vector<T> result;
+template <typename T, typename Allocator>
+std::vector<T, Allocator> SliceVector(const std::vector<T, Allocator>& vec, size_t begin, size_t len) {
+    std::vector<T, Allocator> result(vec.get_allocator());
 
     if (begin < vec.size()) {
         len = std::min(len, vec.size() - begin);
@@ -17,4 +30,99 @@ std::vector<T> SliceVector(const std::vector<T>& vec, size_t begin, size_t len)
     return result;
 }
 
+inline size_t CountTrailingZeros(uint32_t x) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, x);
+    return index;
+#else
+    return __builtin_ctz(x);
+#endif
+}
+
+/// Returns count of leading zero bits of x, which must not be zero.
+inline size_t CountLeadingZeros64(uint64_t x) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, x);
+    return 63 - index;
+#else
+    return __builtin_clzll(x);
+#endif
+}
+
+#if defined(CLICKHOUSE_COLUMNS_SSE2)
+/// Returns mask with bit set for each zero byte of 16 bytes at data.
+inline uint32_t ZeroMask16(const uint8_t* data) {
+    const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_setzero_si128())));
+}
+#endif
+
+/// Returns count of bytes which are not zero.
+inline size_t CountNonZero(const uint8_t* data, size_t size) {
+    size_t count = 0;
+    size_t i = 0;
+
+#if defined(CLICKHOUSE_COLUMNS_SSE2)
+    for (; i + 16 <= size; i += 16) {
+        count += 16 - std::bitset<16>(ZeroMask16(data + i)).count();
+    }
+#endif
+    for (; i < size; ++i) {
+        count += data[i] != 0;
+    }
+
+    return count;
+}
+
+/// Returns elements of the vector for which mask has nonzero bytes.
+/// The mask holds one byte per element.
+template <typename T, typename Allocator>
+std::vector<T, Allocator> FilterVector(const std::vector<T, Allocator>& vec, const uint8_t* mask) {
+    const size_t size = vec.size();
+    std::vector<T, Allocator> result(CountNonZero(mask, size), vec.get_allocator());
+    auto out = result.begin();
+    size_t i = 0;
+
+#if defined(CLICKHOUSE_COLUMNS_SSE2)
+    // Runs of 16 kept or dropped elements are handled at once, other
+    // elements are picked by the bits of the mask.
+    for (; i + 16 <= size; i += 16) {
+        uint32_t keep = ~ZeroMask16(mask + i) & 0xFFFF;
+        if (keep == 0xFFFF) {
+            out = std::copy(vec.begin() + i, vec.begin() + (i + 16), out);
+            continue;
+        }
+        for (; keep; keep &= keep - 1) {
+            *out++ = vec[i + CountTrailingZeros(keep)];
+        }
+    }
+#endif
+    for (; i < size; ++i) {
+        if (mask[i]) {
+            *out++ = vec[i];
+        }
+    }
+
+    return result;
+}
+
+/// Returns elements of the vector at given positions.  Throws
+/// std::out_of_range if a position is beyond the vector.
+template <typename T, typename Allocator>
+std::vector<T, Allocator> TakeVector(const std::vector<T, Allocator>& vec, const uint32_t* indices, size_t count) {
+    const size_t size = vec.size();
+    std::vector<T, Allocator> result(count, vec.get_allocator());
+
+    for (size_t i = 0; i < count; ++i) {
+        if (indices[i] >= size) {
+            throw std::out_of_range("row index is out of range: " + std::to_string(indices[i]));
+        }
+        result[i] = vec[indices[i]];
+    }
+
+    return result;
+}
+
 }
@@ -2,17 +2,19 @@
 #include "utils.h"
 
 #include <stdexcept>
+#include <string>
+#include <vector>
 
 namespace clickhouse {
 
-ColumnUUID::ColumnUUID()
-    : Column(Type::CreateUUID())
-    , data_(std::make_shared<ColumnUInt64>())
+ColumnUUID::ColumnUUID(std::pmr::memory_resource* resource)
+    : Column(Type::CreateUUID(), resource)
+    , data_(MakeColumn<ColumnUInt64>(resource))
 {
 }
 
 ColumnUUID::ColumnUUID(ColumnRef data)
-    : Column(Type::CreateUUID())
+    : Column(Type::CreateUUID(), data->GetMemoryResource())
     , data_(data->As<ColumnUInt64>())
 {
     if (data_->Size() % 2 != 0) {
@@ -56,7 +58,52 @@ size_t ColumnUUID::Size() const {
 }
 
 ColumnRef ColumnUUID::Slice(size_t begin, size_t len) {
-    return std::make_shared<ColumnUUID>(data_->Slice(begin * 2, len * 2));
+    auto result = MakeColumn<ColumnUUID>(resource_);
+    result->data_ = data_->Slice(begin * 2, len * 2)->As<ColumnUInt64>();
+    return result;
+}
+
+ColumnRef ColumnUUID::Filter(const uint8_t* mask) const {
+    // Each row is stored as two halves.
+    std::vector<uint8_t> halves(data_->Size());
+    for (size_t i = 0; i < halves.size(); ++i) {
+        halves[i] = mask[i / 2];
+    }
+    auto result = MakeColumn<ColumnUUID>(resource_);
+    result->data_ = data_->Filter(halves.data())->As<ColumnUInt64>();
+    return result;
+}
+
+ColumnRef ColumnUUID::Take(const uint32_t* indices, size_t count) const {
+    const size_t size = Size();
+    std::vector<uint32_t> halves(count * 2);
+    for (size_t i = 0; i < count; ++i) {
+        if (indices[i] >= size) {
+            throw std::out_of_range("row index is out of range: " + std::to_string(indices[i]));
+        }
+        halves[i * 2] = indices[i] * 2;
+        halves[i * 2 + 1] = indices[i] * 2 + 1;
+    }
+    auto result = MakeColumn<ColumnUUID>(resource_);
+    result->data_ = data_->Take(halves.data(), halves.size())->As<ColumnUInt64>();
+    return result;
+}
+
+size_t ColumnUUID::MemoryUsage() const {
+    return data_->MemoryUsage();
+}
+
+void ColumnUUID::Reserve(size_t rows) {
+    // Each row is stored as two halves.
+    data_->Reserve(rows * 2);
+}
+
+void ColumnUUID::ShrinkToFit() {
+    data_->ShrinkToFit();
+}
+
+bool ColumnUUID::IsExclusivelyOwned() const {
+    return IsNestedOwned(data_);
 }
 
 }
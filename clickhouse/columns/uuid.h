@@ -12,7 +12,7 @@ using UInt128 = std::pair<uint64_t, uint64_t>;
  */
 class ColumnUUID : public Column {
 public:
-    ColumnUUID();
+    explicit ColumnUUID(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 
     explicit ColumnUUID(ColumnRef data);
 
@@ -44,6 +44,24 @@ public:
     /// Makes slice of the current column.
     ColumnRef Slice(size_t begin, size_t len) override;
 
+    /// Makes column of the rows selected by the mask.
+    ColumnRef Filter(const uint8_t* mask) const override;
+
+    /// Makes column of the rows at given positions.
+    ColumnRef Take(const uint32_t* indices, size_t count) const override;
+
+    /// Returns count of bytes of memory held by the column data.
+    size_t MemoryUsage() const override;
+
+    /// Preallocates memory for given total count of rows.
+    void Reserve(size_t rows) override;
+
+    /// Releases memory reserved beyond the current content.
+    void ShrinkToFit() override;
+
+    /// Returns true if nested columns are not referenced from outside.
+    bool IsExclusivelyOwned() const override;
+
 private:
     std::shared_ptr<ColumnUInt64> data_;
 };
@@ -0,0 +1,291 @@
+#pragma once
+
+#include "block.h"
+#include "columns/array.h"
+#include "columns/date.h"
+#include "columns/enum.h"
+#include "columns/lowcardinality.h"
+#include "columns/nullable.h"
+#include "columns/numeric.h"
+#include "columns/string.h"
+
+#include <limits>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace clickhouse {
+
+/**
+ * Reads values of a column as values of type T.  For each row of the
+ * column Visit() calls func(row, value) with the value converted to T.
+ *
+ * Supported types of values are:
+ *  - arithmetic types, read from numeric, Date, DateTime, DateTime64
+ *    (ticks) and Enum columns with static_cast;
+ *  - std::string, read from String, FixedString and Enum (names) columns;
+ *  - std::optional<U>, read from Nullable(U) or from columns of U;
+ *  - std::vector<U>, read from Array(U) columns.
+ * LowCardinality columns are read as their dictionary values.
+ */
+template <typename T, typename = void>
+struct ColumnValueReader;
+
+namespace RowMapping {
+
+[[noreturn]] inline void ThrowMismatch(const ColumnRef& column) {
+    throw std::runtime_error("can't read column of type " + column->Type()->GetName() + " into the field");
+}
+
+template <typename T, typename U, typename Func>
+inline void VisitVector(const ColumnRef& column, Func&& func) {
+    const auto& data = column->As<ColumnVector<U>>()->GetData();
+    for (size_t i = 0; i < data.size(); ++i) {
+        func(i, static_cast<T>(data[i]));
+    }
+}
+
+template <typename T, typename C, typename Func>
+inline void VisitAt(const ColumnRef& column, Func&& func) {
+    const auto col = column->As<C>();
+    const size_t size = col->Size();
+    for (size_t i = 0; i < size; ++i) {
+        func(i, static_cast<T>(col->At(i)));
+    }
+}
+
+/// Reads all values of the column.  Depends on T only, which bounds
+/// instantiations of the readers recursing into dictionaries.
+template <typename T>
+inline std::vector<T> ReadValues(const ColumnRef& column) {
+    std::vector<T> values(column->Size());
+    ColumnValueReader<T>::Visit(column, [&values] (size_t i, const T& value) {
+        values[i] = value;
+    });
+    return values;
+}
+
+/// Reads dictionary values once and then maps rows to them.
+template <typename T, typename Func>
+inline void VisitLowCardinality(const ColumnRef& column, Func&& func) {
+    const auto col = column->As<ColumnLowCardinality>();
+    const std::vector<T> values = ReadValues<T>(col->GetDictionary());
+    const size_t size = col->Size();
+    for (size_t i = 0; i < size; ++i) {
+        func(i, values[col->GetIndex(i)]);
+    }
+}
+
+}
+
+template <typename T>
+struct ColumnValueReader<T, std::enable_if_t<std::is_arithmetic<T>::value>> {
+    template <typename Func>
+    static void Visit(const ColumnRef& column, Func&& func) {
+        using namespace RowMapping;
+
+        switch (column->Type()->GetCode()) {
+            case Type::Int8:       return VisitVector<T, int8_t>(column, func);
+            case Type::Int16:      return VisitVector<T, int16_t>(column, func);
+            case Type::Int32:      return VisitVector<T, int32_t>(column, func);
+            case Type::Int64:      return VisitVector<T, int64_t>(column, func);
+            case Type::UInt8:      return VisitVector<T, uint8_t>(column, func);
+            case Type::UInt16:     return VisitVector<T, uint16_t>(column, func);
+            case Type::UInt32:     return VisitVector<T, uint32_t>(column, func);
+            case Type::UInt64:     return VisitVector<T, uint64_t>(column, func);
+            case Type::Float32:    return VisitVector<T, float>(column, func);
+            case Type::Float64:    return VisitVector<T, double>(column, func);
+            case Type::Date:       return VisitAt<T, ColumnDate>(column, func);
+            case Type::Date32:     return VisitAt<T, ColumnDate32>(column, func);
+            case Type::DateTime:   return VisitAt<T, ColumnDateTime>(column, func);
+            case Type::DateTime64: return VisitAt<T, ColumnDateTime64>(column, func);
+            case Type::Enum8:      return VisitAt<T, ColumnEnum8>(column, func);
+            case Type::Enum16:     return VisitAt<T, ColumnEnum16>(column, func);
+            case Type::LowCardinality: return VisitLowCardinality<T>(column, func);
+            default:
+                ThrowMismatch(column);
+        }
+    }
+};
+
+template <>
+struct ColumnValueReader<std::string> {
+    template <typename Func>
+    static void Visit(const ColumnRef& column, Func&& func) {
+        using namespace RowMapping;
+
+        switch (column->Type()->GetCode()) {
+            case Type::String:      return VisitAt<const std::string&, ColumnString>(column, func);
+            case Type::FixedString: return VisitAt<const std::string&, ColumnFixedString>(column, func);
+            case Type::LowCardinality: return VisitLowCardinality<std::string>(column, func);
+            case Type::Enum8: {
+                auto col = column->As<ColumnEnum8>();
+                for (size_t i = 0; i < col->Size(); ++i) {
+                    func(i, col->NameAt(i));
+                }
+                return;
+            }
+            case Type::Enum16: {
+                auto col = column->As<ColumnEnum16>();
+                for (size_t i = 0; i < col->Size(); ++i) {
+                    func(i, col->NameAt(i));
+                }
+                return;
+            }
+            default:
+                ThrowMismatch(column);
+        }
+    }
+};
+
+template <typename U>
+struct ColumnValueReader<std::optional<U>> {
+    template <typename Func>
+    static void Visit(const ColumnRef& column, Func&& func) {
+        if (auto nullable = column->As<ColumnNullable>()) {
+            const uint8_t* nulls = nullable->Nulls()->As<ColumnUInt8>()->GetData().data();
+            ColumnValueReader<U>::Visit(nullable->Nested(), [&] (size_t i, const U& value) {
+                func(i, nulls[i] ? std::optional<U>() : std::optional<U>(value));
+            });
+        } else if (auto lc = column->As<ColumnLowCardinality>(); lc && lc->IsNullable()) {
+            ColumnValueReader<U>::Visit(column, [&] (size_t i, const U& value) {
+                func(i, lc->IsNull(i) ? std::optional<U>() : std::optional<U>(value));
+            });
+        } else {
+            ColumnValueReader<U>::Visit(column, [&] (size_t i, const U& value) {
+                func(i, std::optional<U>(value));
+            });
+        }
+    }
+};
+
+template <typename U>
+struct ColumnValueReader<std::vector<U>> {
+    template <typename Func>
+    static void Visit(const ColumnRef& column, Func&& func) {
+        auto array = column->As<ColumnArray>();
+        if (!array) {
+            RowMapping::ThrowMismatch(column);
+        }
+
+        // Elements of all arrays are read in one pass over the nested column.
+        const size_t size = array->Size();
+        std::vector<U> current;
+        size_t row = 0;
+
+        auto flush = [&] (size_t end) {
+            for (; row < size && array->GetOffset(row) + array->GetSize(row) <= end; ++row) {
+                func(row, current);
+                current.clear();
+            }
+        };
+
+        flush(0);
+        ColumnValueReader<U>::Visit(array->GetData(), [&] (size_t i, const U& value) {
+            current.push_back(value);
+            flush(i + 1);
+        });
+        // Empty arrays at the end.
+        flush(std::numeric_limits<size_t>::max());
+    }
+};
+
+
+/**
+ * Decodes blocks into structures, with fields mapped to columns by name:
+ *
+ *   struct Row { uint64_t id; std::string name; std::optional<double> score; };
+ *
+ *   RowMapper<Row> mapper;
+ *   mapper.Map("id", &Row::id).Map("name", &Row::name).Map("score", &Row::score);
+ *
+ *   std::vector<Row> rows;
+ *   client.Select("SELECT id, name, score FROM test.scores", [&] (const Block& block) {
+ *       mapper.Read(block, &rows);
+ *   });
+ *
+ * Columns are looked up and cast to their concrete types once per block,
+ * and each field is filled by a loop over the whole column.
+ */
+template <typename Row>
+class RowMapper {
+public:
+    /// Maps column of given name to the field.
+    template <typename Field>
+    RowMapper& Map(std::string column, Field Row::* member) {
+        fields_.emplace_back(new MappedField<Field>(std::move(column), member));
+        return *this;
+    }
+
+    /// Appends rows of the block to the vector.  Throws std::runtime_error
+    /// if a mapped column is missing or can't be read into its field, the
+    /// vector is left unchanged then.
+    void Read(const Block& block, std::vector<Row>* rows) const {
+        std::vector<ColumnRef> columns;
+        columns.reserve(fields_.size());
+        for (const auto& field : fields_) {
+            columns.push_back(FindColumn(block, field->column));
+        }
+
+        const size_t base = rows->size();
+        rows->resize(base + block.GetRowCount());
+
+        try {
+            for (size_t i = 0; i < fields_.size(); ++i) {
+                fields_[i]->Read(columns[i], rows->data() + base);
+            }
+        } catch (...) {
+            // Drop partially filled rows.
+            rows->resize(base);
+            throw;
+        }
+    }
+
+private:
+    static ColumnRef FindColumn(const Block& block, const std::string& name) {
+        for (Block::Iterator bi(block); bi.IsValid(); bi.Next()) {
+            if (bi.Name() == name) {
+                return bi.Column();
+            }
+        }
+        throw std::runtime_error("no column " + name + " in the block");
+    }
+
+    struct FieldBase {
+        explicit FieldBase(std::string name)
+            : column(std::move(name))
+        {
+        }
+
+        virtual ~FieldBase() = default;
+
+        /// Fills the field of the rows from values of the column.
+        virtual void Read(const ColumnRef& values, Row* rows) const = 0;
+
+        const std::string column;
+    };
+
+    template <typename Field>
+    struct MappedField : FieldBase {
+        MappedField(std::string name, Field Row::* field)
+            : FieldBase(std::move(name))
+            , member(field)
+        {
+        }
+
+        void Read(const ColumnRef& values, Row* rows) const override {
+            ColumnValueReader<Field>::Visit(values, [rows, this] (size_t i, const auto& value) {
+                rows[i].*member = value;
+            });
+        }
+
+        Field Row::* const member;
+    };
+
+    std::vector<std::unique_ptr<FieldBase>> fields_;
+};
+
+}
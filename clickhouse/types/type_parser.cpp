@@ -12,10 +12,14 @@ static const std::unordered_map<std::string, Type::Code> kTypeCode = {
     { "Int16",       Type::Int16 },
     { "Int32",       Type::Int32 },
     { "Int64",       Type::Int64 },
+    { "Int128",      Type::Int128 },
+    { "Int256",      Type::Int256 },
     { "UInt8",       Type::UInt8 },
     { "UInt16",      Type::UInt16 },
     { "UInt32",      Type::UInt32 },
     { "UInt64",      Type::UInt64 },
+    { "UInt128",     Type::UInt128 },
+    { "UInt256",     Type::UInt256 },
     { "Float32",     Type::Float32 },
     { "Float64",     Type::Float64 },
     { "String",      Type::String },
@@ -23,6 +27,7 @@ static const std::unordered_map<std::string, Type::Code> kTypeCode = {
     { "DateTime",    Type::DateTime },
     { "DateTime64",  Type::DateTime64 },
     { "Date",        Type::Date },
+    { "Date32",      Type::Date32 },
     { "Array",       Type::Array },
     { "Nullable",    Type::Nullable },
     { "Tuple",       Type::Tuple },
@@ -35,6 +40,9 @@ static const std::unordered_map<std::string, Type::Code> kTypeCode = {
     { "Decimal32",   Type::Decimal32 },
     { "Decimal64",   Type::Decimal64 },
     { "Decimal128",  Type::Decimal128 },
+    { "Decimal256",  Type::Decimal256 },
+    { "LowCardinality", Type::LowCardinality },
+    { "Map",         Type::Map },
 };
 
 static Type::Code GetTypeCode(const std::string& name) {
@@ -66,6 +74,14 @@ static TypeAst::Meta GetTypeMeta(const std::string_view name) {
         return TypeAst::Enum;
     }
 
+    if (name == "LowCardinality") {
+        return TypeAst::LowCardinality;
+    }
+
+    if (name == "Map") {
+        return TypeAst::Map;
+    }
+
     return TypeAst::Terminal;
 }
 
@@ -189,25 +205,36 @@ TypeParser::Token TypeParser::NextToken() {
 }
 
 
-const TypeAst* ParseTypeName(const std::string& type_name) {
-    // Cache for type_name.
+const TypeAst* ParseTypeName(const std::string_view type_name) {
     // Usually we won't have too many type names in the cache, so do not try to
     // limit cache size.
-    static std::map<std::string, TypeAst> ast_cache;
+    //
+    // Lookups go to a thread-local front cache first, so concurrent readers
+    // never take a lock once a type has been seen by the thread.  Keys of
+    // the front cache point to keys of the global cache, which are never
+    // removed, and map nodes keep their addresses.
+    static thread_local std::unordered_map<std::string_view, const TypeAst*> local_cache;
+
+    auto it = local_cache.find(type_name);
+    if (it != local_cache.end()) {
+        return it->second;
+    }
+
+    static std::map<std::string, TypeAst, std::less<>> ast_cache;
     static std::mutex lock;
 
     std::lock_guard<std::mutex> guard(lock);
-    auto it = ast_cache.find(type_name);
-    if (it != ast_cache.end()) {
-        return &it->second;
+    auto gi = ast_cache.find(type_name);
+    if (gi == ast_cache.end()) {
+        TypeAst ast;
+        if (!TypeParser(type_name).Parse(&ast)) {
+            return nullptr;
+        }
+        gi = ast_cache.emplace(std::string(type_name), std::move(ast)).first;
     }
 
-    auto& ast = ast_cache[type_name];
-    if (TypeParser(type_name).Parse(&ast)) {
-        return &ast;
-    }
-    ast_cache.erase(type_name);
-    return nullptr;
+    local_cache.emplace(gi->first, &gi->second);
+    return &gi->second;
 }
 
 }
@@ -20,6 +20,8 @@ struct TypeAst {
         Terminal,
         Tuple,
         Enum,
+        LowCardinality,
+        Map,
     };
 
     /// Type's category.
@@ -75,6 +77,8 @@ private:
 };
 
 
-const TypeAst* ParseTypeName(const std::string& type_name);
+/// Returns cached AST of the type, or nullptr if the name cannot be parsed.
+/// Lookups of already parsed names do not take locks.
+const TypeAst* ParseTypeName(const std::string_view type_name);
 
 }
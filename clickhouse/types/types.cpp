@@ -10,14 +10,18 @@ Type::Type(const Code code)
     if (code_ == Array) {
         array_ = new ArrayImpl;
     } else if (code_ == DateTime || code_ == DateTime64) {
-        date_time_ = new DateTimeImpl;
+        date_time_ = new DateTimeImpl();
     } else if (code_ == Tuple) {
         tuple_ = new TupleImpl;
     } else if (code_ == Nullable) {
         nullable_ = new NullableImpl;
+    } else if (code_ == LowCardinality) {
+        low_cardinality_ = new LowCardinalityImpl;
+    } else if (code_ == Map) {
+        map_ = new MapImpl;
     } else if (code_ == Enum8 || code_ == Enum16) {
         enum_ = new EnumImpl;
-    } else if (code_== Decimal || code_== Decimal32 || code_ == Decimal64 || code_ == Decimal128) {
+    } else if (code_== Decimal || code_== Decimal32 || code_ == Decimal64 || code_ == Decimal128 || code_ == Decimal256) {
         decimal_ = new DecimalImpl;
     }
 }
@@ -31,9 +35,13 @@ Type::~Type() {
         delete tuple_;
     } else if (code_ == Nullable) {
         delete nullable_;
+    } else if (code_ == LowCardinality) {
+        delete low_cardinality_;
+    } else if (code_ == Map) {
+        delete map_;
     } else if (code_ == Enum8 || code_ == Enum16) {
         delete enum_;
-    } else if (code_== Decimal || code_== Decimal32 || code_ == Decimal64 || code_ == Decimal128) {
+    } else if (code_== Decimal || code_== Decimal32 || code_ == Decimal64 || code_ == Decimal128 || code_ == Decimal256) {
         delete decimal_;
     }
 }
@@ -53,6 +61,9 @@ TypeRef Type::GetNestedType() const {
     if (code_ == Nullable) {
         return nullable_->nested_type;
     }
+    if (code_ == LowCardinality) {
+        return low_cardinality_->nested_type;
+    }
     return TypeRef();
 }
 
@@ -63,6 +74,20 @@ std::vector<TypeRef> Type::GetTupleType() const {
     return std::vector<TypeRef>();
 }
 
+TypeRef Type::GetKeyType() const {
+    if (code_ == Map) {
+        return map_->key_type;
+    }
+    return TypeRef();
+}
+
+TypeRef Type::GetValueType() const {
+    if (code_ == Map) {
+        return map_->value_type;
+    }
+    return TypeRef();
+}
+
 std::string Type::GetName() const {
     switch (code_) {
         case Void:
@@ -77,6 +102,8 @@ std::string Type::GetName() const {
             return "Int64";
         case Int128:
             return "Int128";
+        case Int256:
+            return "Int256";
         case UInt8:
             return "UInt8";
         case UInt16:
@@ -85,6 +112,10 @@ std::string Type::GetName() const {
             return "UInt32";
         case UInt64:
             return "UInt64";
+        case UInt128:
+            return "UInt128";
+        case UInt256:
+            return "UInt256";
         case UUID:
             return "UUID";
         case Float32:
@@ -114,10 +145,16 @@ std::string Type::GetName() const {
             }
         case Date:
             return "Date";
+        case Date32:
+            return "Date32";
         case Array:
             return std::string("Array(") + array_->item_type->GetName() +")";
         case Nullable:
             return std::string("Nullable(") + nullable_->nested_type->GetName() + ")";
+        case LowCardinality:
+            return std::string("LowCardinality(") + low_cardinality_->nested_type->GetName() + ")";
+        case Map:
+            return std::string("Map(") + map_->key_type->GetName() + ", " + map_->value_type->GetName() + ")";
         case Tuple: {
             std::string result("Tuple(");
             for (size_t i = 0; i < tuple_->item_types.size(); ++i) {
@@ -158,6 +195,8 @@ std::string Type::GetName() const {
             return "Decimal64(" + std::to_string(decimal_->scale) + ")";
         case Decimal128:
             return "Decimal128(" + std::to_string(decimal_->scale) + ")";
+        case Decimal256:
+            return "Decimal256(" + std::to_string(decimal_->scale) + ")";
     }
 
     return std::string();
@@ -177,6 +216,10 @@ TypeRef Type::CreateDate() {
     return TypeRef(new Type(Type::Date));
 }
 
+TypeRef Type::CreateDate32() {
+    return TypeRef(new Type(Type::Date32));
+}
+
 TypeRef Type::CreateDateTime(std::string timezone) {
     TypeRef type(new Type(Type::DateTime));
     type->date_time_->timezone = std::move(timezone);
@@ -205,6 +248,19 @@ TypeRef Type::CreateIPv6() {
     return TypeRef(new Type(Type::IPv6));
 }
 
+TypeRef Type::CreateLowCardinality(TypeRef nested_type) {
+    TypeRef type(new Type(Type::LowCardinality));
+    type->low_cardinality_->nested_type = nested_type;
+    return type;
+}
+
+TypeRef Type::CreateMap(TypeRef key_type, TypeRef value_type) {
+    TypeRef type(new Type(Type::Map));
+    type->map_->key_type = key_type;
+    type->map_->value_type = value_type;
+    return type;
+}
+
 TypeRef Type::CreateNothing() {
     return TypeRef(new Type(Type::Void));
 }
@@ -296,4 +352,8 @@ std::string DateTimeType::Timezone() const {
     return type_->date_time_->timezone;
 }
 
+size_t DateTimeType::Precision() const {
+    return type_->date_time_->precision;
+}
+
 }
@@ -1,6 +1,6 @@
 #pragma once
 
-#include "absl/numeric/int128.h"
+#include "../base/wide_integer.h"
 
 #include <map>
 #include <memory>
@@ -43,6 +43,13 @@ public:
         Decimal32,
         Decimal64,
         Decimal128,
+        LowCardinality,
+        Map,
+        UInt128,
+        Int256,
+        UInt256,
+        Decimal256,
+        Date32,
     };
 
     struct EnumItem {
@@ -59,12 +66,18 @@ public:
     /// Type of array's elements.
     TypeRef GetItemType() const;
 
-    /// Type of nested nullable element.
+    /// Type of nested nullable or low cardinality element.
     TypeRef GetNestedType() const;
 
     /// Type of nested Tuple element type.
     std::vector<TypeRef> GetTupleType() const;
 
+    /// Type of Map's keys.
+    TypeRef GetKeyType() const;
+
+    /// Type of Map's values.
+    TypeRef GetValueType() const;
+
     /// String representation of the type.
     std::string GetName() const;
 
@@ -76,6 +89,8 @@ public:
 
     static TypeRef CreateDate();
 
+    static TypeRef CreateDate32();
+
     static TypeRef CreateDateTime(std::string timezone = std::string());
 
     static TypeRef CreateDateTime64(size_t precision, std::string timezone = std::string());
@@ -86,6 +101,10 @@ public:
 
     static TypeRef CreateIPv6();
 
+    static TypeRef CreateLowCardinality(TypeRef nested_type);
+
+    static TypeRef CreateMap(TypeRef key_type, TypeRef value_type);
+
     static TypeRef CreateNothing();
 
     static TypeRef CreateNullable(TypeRef nested_type);
@@ -126,6 +145,15 @@ private:
         TypeRef nested_type;
     };
 
+    struct LowCardinalityImpl {
+        TypeRef nested_type;
+    };
+
+    struct MapImpl {
+        TypeRef key_type;
+        TypeRef value_type;
+    };
+
     struct TupleImpl {
         std::vector<TypeRef> item_types;
     };
@@ -147,6 +175,8 @@ private:
         DateTimeImpl* date_time_;
         DecimalImpl* decimal_;
         NullableImpl* nullable_;
+        LowCardinalityImpl* low_cardinality_;
+        MapImpl* map_;
         TupleImpl* tuple_;
         EnumImpl* enum_;
         int string_size_;
@@ -182,6 +212,9 @@ public:
     /// Timezone associated with a data column.
     std::string Timezone() const;
 
+    /// Count of fractional second digits, zero for DateTime.
+    size_t Precision() const;
+
 private:
     TypeRef type_;
 };
@@ -211,6 +244,11 @@ inline TypeRef Type::CreateSimple<absl::int128>() {
     return TypeRef(new Type(Int128));
 }
 
+template <>
+inline TypeRef Type::CreateSimple<Int256>() {
+    return TypeRef(new Type(Int256));
+}
+
 template <>
 inline TypeRef Type::CreateSimple<uint8_t>() {
     return TypeRef(new Type(UInt8));
@@ -231,6 +269,16 @@ inline TypeRef Type::CreateSimple<uint64_t>() {
     return TypeRef(new Type(UInt64));
 }
 
+template <>
+inline TypeRef Type::CreateSimple<absl::uint128>() {
+    return TypeRef(new Type(UInt128));
+}
+
+template <>
+inline TypeRef Type::CreateSimple<UInt256>() {
+    return TypeRef(new Type(UInt256));
+}
+
 template <>
 inline TypeRef Type::CreateSimple<float>() {
     return TypeRef(new Type(Float32));
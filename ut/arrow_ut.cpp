@@ -0,0 +1,163 @@
+#include <clickhouse/arrow.h>
+#include <clickhouse/columns/array.h>
+#include <clickhouse/columns/date.h>
+#include <clickhouse/columns/decimal.h>
+#include <clickhouse/columns/nullable.h>
+#include <clickhouse/columns/numeric.h>
+#include <clickhouse/columns/string.h>
+#include <clickhouse/columns/tuple.h>
+
+#include <contrib/gtest/gtest.h>
+
+#include <string>
+
+using namespace clickhouse;
+
+static Block MakeBlock() {
+    auto numbers = std::make_shared<ColumnUInt64>(std::vector<uint64_t>{1, 2, 3});
+
+    auto names = std::make_shared<ColumnNullable>(
+        std::make_shared<ColumnString>(std::vector<std::string>{"a", "", "a long string value"}),
+        std::make_shared<ColumnUInt8>(std::vector<uint8_t>{0, 1, 0}));
+
+    auto arrays = std::make_shared<ColumnArray>(std::make_shared<ColumnInt32>());
+    arrays->AppendAsColumn(std::make_shared<ColumnInt32>(std::vector<int32_t>{1, 2}));
+    arrays->AppendAsColumn(std::make_shared<ColumnInt32>());
+    arrays->AppendAsColumn(std::make_shared<ColumnInt32>(std::vector<int32_t>{3}));
+
+    auto codes = std::make_shared<ColumnFixedString>(2);
+    codes->Append("ab");
+    codes->Append("cd");
+    codes->Append("ef");
+    auto tuples = std::make_shared<ColumnTuple>(std::vector<ColumnRef>{
+        std::make_shared<ColumnFloat64>(std::vector<double>{0.5, 1.5, 2.5}), codes});
+
+    auto times = std::make_shared<ColumnDateTime64>(3, "UTC");
+    times->Append(1000);
+    times->Append(2000);
+    times->Append(3000);
+
+    auto prices = std::make_shared<ColumnDecimal>(10, 2);
+    prices->Append("-1.25");
+    prices->Append("0.01");
+    prices->Append("12345678.90");
+
+    auto dates = std::make_shared<ColumnDate32>();
+    dates->Append(-86400);
+    dates->Append(0);
+    dates->Append(86400 * 20000);
+
+    Block block;
+    block.AppendColumn("number", numbers);
+    block.AppendColumn("name", names);
+    block.AppendColumn("values", arrays);
+    block.AppendColumn("pair", tuples);
+    block.AppendColumn("time", times);
+    block.AppendColumn("price", prices);
+    block.AppendColumn("date", dates);
+    return block;
+}
+
+TEST(ArrowCase, ExportBlock) {
+    const Block block = MakeBlock();
+    ArrowArray array;
+    ArrowSchema schema;
+    ExportBlock(block, &array, &schema);
+
+    ASSERT_STREQ("+s", schema.format);
+    ASSERT_EQ(7, schema.n_children);
+    ASSERT_EQ(3, array.length);
+    ASSERT_EQ(7, array.n_children);
+
+    // Numbers are not copied.
+    EXPECT_STREQ("number", schema.children[0]->name);
+    EXPECT_STREQ("L", schema.children[0]->format);
+    EXPECT_EQ(block[0]->As<ColumnUInt64>()->GetData().data(), array.children[0]->buffers[1]);
+
+    // NULL is a cleared bit of the validity bitmap.
+    const ArrowArray* names = array.children[1];
+    EXPECT_STREQ("U", schema.children[1]->format);
+    EXPECT_TRUE(schema.children[1]->flags & ARROW_FLAG_NULLABLE);
+    EXPECT_EQ(1, names->null_count);
+    EXPECT_EQ(0x05, static_cast<const uint8_t*>(names->buffers[0])[0] & 0x07);
+    const int64_t* offsets = static_cast<const int64_t*>(names->buffers[1]);
+    EXPECT_EQ(0, offsets[0]);
+    EXPECT_EQ(1, offsets[1]);
+    EXPECT_EQ(1, offsets[2]);
+    EXPECT_EQ(20, offsets[3]);
+
+    EXPECT_STREQ("+L", schema.children[2]->format);
+    EXPECT_STREQ("i", schema.children[2]->children[0]->format);
+    EXPECT_EQ(3, static_cast<const int64_t*>(array.children[2]->buffers[1])[3]);
+
+    EXPECT_STREQ("+s", schema.children[3]->format);
+    EXPECT_STREQ("w:2", schema.children[3]->children[1]->format);
+    EXPECT_STREQ("tsm:UTC", schema.children[4]->format);
+    EXPECT_STREQ("d:10,2", schema.children[5]->format);
+    EXPECT_STREQ("tdD", schema.children[6]->format);
+    EXPECT_EQ(-1, static_cast<const int32_t*>(array.children[6]->buffers[1])[0]);
+
+    // The exported array keeps the columns alive.
+    schema.release(&schema);
+    array.release(&array);
+    EXPECT_EQ(nullptr, array.release);
+    EXPECT_EQ(nullptr, schema.release);
+}
+
+TEST(ArrowCase, RoundTrip) {
+    const Block block = MakeBlock();
+    ArrowArray array;
+    ArrowSchema schema;
+    ExportBlock(block, &array, &schema);
+
+    const Block result = ImportBlock(&array, &schema);
+    EXPECT_EQ(nullptr, array.release);
+    EXPECT_EQ(nullptr, schema.release);
+
+    ASSERT_EQ(block.GetColumnCount(), result.GetColumnCount());
+    ASSERT_EQ(block.GetRowCount(), result.GetRowCount());
+    for (size_t i = 0; i < block.GetColumnCount(); ++i) {
+        EXPECT_EQ(block.GetColumnName(i), result.GetColumnName(i));
+        EXPECT_EQ(block[i]->Type()->GetName(), result[i]->Type()->GetName());
+    }
+
+    auto names = result[1]->As<ColumnNullable>();
+    EXPECT_FALSE(names->IsNull(0));
+    EXPECT_TRUE(names->IsNull(1));
+    EXPECT_EQ("a long string value", names->Nested()->As<ColumnString>()->At(2));
+
+    auto arrays = result[2]->As<ColumnArray>();
+    EXPECT_EQ(2u, arrays->GetAsColumn(0)->Size());
+    EXPECT_EQ(0u, arrays->GetAsColumn(1)->Size());
+    EXPECT_EQ(3, arrays->GetAsColumn(2)->As<ColumnInt32>()->At(0));
+
+    auto tuples = result[3]->As<ColumnTuple>();
+    EXPECT_EQ(2.5, (*tuples)[0]->As<ColumnFloat64>()->At(2));
+    EXPECT_EQ("cd", (*tuples)[1]->As<ColumnFixedString>()->At(1));
+
+    EXPECT_EQ(3000u, result[4]->As<ColumnDateTime64>()->At(2));
+    EXPECT_EQ("12345678.90", result[5]->As<ColumnDecimal>()->AsString(2));
+    EXPECT_EQ(-86400, result[6]->As<ColumnDate32>()->At(0));
+}
+
+TEST(ArrowCase, ImportSlice) {
+    auto numbers = std::make_shared<ColumnInt64>(std::vector<int64_t>{1, 2, 3, 4, 5});
+    ArrowArray array;
+    ArrowSchema schema;
+    ExportColumn(numbers, &array, &schema);
+
+    // Arrays produced by Arrow may view a part of their buffers.
+    array.offset = 1;
+    array.length = 3;
+    auto result = ImportColumn(&array, &schema)->As<ColumnInt64>();
+    ASSERT_EQ(3u, result->Size());
+    EXPECT_EQ(2, result->At(0));
+    EXPECT_EQ(4, result->At(2));
+}
+
+TEST(ArrowCase, Unsupported) {
+    auto ids = std::make_shared<ColumnUInt128>();
+    ArrowArray array;
+    ArrowSchema schema;
+    EXPECT_THROW(ExportColumn(ids, &array, &schema), std::runtime_error);
+}
@@ -0,0 +1,279 @@
+#include <clickhouse/block_builder.h>
+#include <clickhouse/columns/factory.h>
+#include <clickhouse/columns/hash.h>
+#include <clickhouse/row_mapper.h>
+
+#include <contrib/gtest/gtest.h>
+
+using namespace clickhouse;
+
+TEST(BlockCase, TypedBuilder) {
+    using Builder = TypedBlockBuilder<
+        Schema::Int64,
+        Schema::String,
+        Schema::Nullable<Schema::Float64>,
+        Schema::Array<Schema::Nullable<Schema::UInt8>>,
+        Schema::FixedString<2>,
+        Schema::Decimal<10, 2>>;
+
+    const auto types = Builder::GetTypes();
+    ASSERT_EQ(6u, types.size());
+    EXPECT_EQ("Nullable(Float64)", types[2]->GetName());
+    EXPECT_EQ("Array(Nullable(UInt8))", types[3]->GetName());
+    EXPECT_EQ("FixedString(2)", types[4]->GetName());
+
+    Builder builder({"id", "name", "score", "flags", "code", "price"}, 16);
+    builder.AddRow(1, "one", 0.5, {1, std::nullopt}, "ab", 12345);
+    builder.AddRow(2, "two", std::nullopt, {}, "cd", -1);
+    ASSERT_EQ(2u, builder.GetRowCount());
+
+    const Block block = builder.Build();
+    EXPECT_EQ(0u, builder.GetRowCount());
+    ASSERT_EQ(6u, block.GetColumnCount());
+    ASSERT_EQ(2u, block.GetRowCount());
+
+    for (size_t i = 0; i < types.size(); ++i) {
+        EXPECT_EQ(types[i]->GetName(), block[i]->Type()->GetName());
+    }
+    EXPECT_EQ("score", block.GetColumnName(2));
+    EXPECT_EQ(2, block[0]->As<ColumnInt64>()->At(1));
+    EXPECT_EQ("two", block[1]->As<ColumnString>()->At(1));
+
+    auto score = block[2]->As<ColumnNullable>();
+    EXPECT_FALSE(score->IsNull(0));
+    EXPECT_TRUE(score->IsNull(1));
+    EXPECT_EQ(0.5, score->Nested()->As<ColumnFloat64>()->At(0));
+
+    auto flags = block[3]->As<ColumnArray>();
+    auto first = flags->GetAsColumn(0)->As<ColumnNullable>();
+    ASSERT_EQ(2u, first->Size());
+    EXPECT_TRUE(first->IsNull(1));
+    EXPECT_EQ(0u, flags->GetAsColumn(1)->Size());
+
+    EXPECT_EQ("cd", block[4]->As<ColumnFixedString>()->At(1));
+    EXPECT_EQ("123.45", block[5]->As<ColumnDecimal>()->AsString(0));
+
+    // The builder starts a new block with new columns.
+    builder.AddRow(3, "three", 1.5, {}, "ef", 0);
+    const Block next = builder.Build();
+    ASSERT_EQ(1u, next.GetRowCount());
+    EXPECT_EQ(2u, block.GetRowCount());
+    EXPECT_EQ(3, next[0]->As<ColumnInt64>()->At(0));
+}
+
+TEST(BlockCase, RowMapper) {
+    struct Row {
+        uint64_t id = 0;
+        std::string name;
+        std::optional<double> score;
+        std::vector<int32_t> values;
+        int64_t time = 0;
+        std::string kind;
+    };
+
+    auto kinds = std::make_shared<ColumnLowCardinality>(std::make_shared<ColumnString>());
+    kinds->Append("a");
+    kinds->Append("b");
+    kinds->Append("a");
+
+    auto values = std::make_shared<ColumnArray>(std::make_shared<ColumnInt32>());
+    values->AppendAsColumn(std::make_shared<ColumnInt32>(std::vector<int32_t>{1, 2}));
+    values->AppendAsColumn(std::make_shared<ColumnInt32>());
+    values->AppendAsColumn(std::make_shared<ColumnInt32>());
+
+    auto times = std::make_shared<ColumnDateTime>();
+    times->Append(100);
+    times->Append(200);
+    times->Append(300);
+
+    Block block;
+    block.AppendColumn("id", std::make_shared<ColumnUInt32>(std::vector<uint32_t>{7, 8, 9}));
+    block.AppendColumn("name", std::make_shared<ColumnString>(std::vector<std::string>{"x", "y", "z"}));
+    block.AppendColumn("score", std::make_shared<ColumnNullable>(
+        std::make_shared<ColumnFloat64>(std::vector<double>{0.5, 0, 2.5}),
+        std::make_shared<ColumnUInt8>(std::vector<uint8_t>{0, 1, 0})));
+    block.AppendColumn("values", values);
+    block.AppendColumn("time", times);
+    block.AppendColumn("kind", kinds);
+
+    RowMapper<Row> mapper;
+    mapper.Map("id", &Row::id)
+          .Map("name", &Row::name)
+          .Map("score", &Row::score)
+          .Map("values", &Row::values)
+          .Map("time", &Row::time)
+          .Map("kind", &Row::kind);
+
+    std::vector<Row> rows(1);
+    mapper.Read(block, &rows);
+    ASSERT_EQ(4u, rows.size());
+
+    EXPECT_EQ(7u, rows[1].id);
+    EXPECT_EQ("z", rows[3].name);
+    EXPECT_EQ(0.5, rows[1].score.value());
+    EXPECT_FALSE(rows[2].score.has_value());
+    EXPECT_EQ((std::vector<int32_t>{1, 2}), rows[1].values);
+    EXPECT_TRUE(rows[2].values.empty());
+    EXPECT_TRUE(rows[3].values.empty());
+    EXPECT_EQ(300, rows[3].time);
+    EXPECT_EQ("b", rows[2].kind);
+
+    // Failed reads leave the rows unchanged.
+    RowMapper<Row> missing;
+    missing.Map("id", &Row::id).Map("other", &Row::id);
+    EXPECT_THROW(missing.Read(block, &rows), std::runtime_error);
+    EXPECT_EQ(4u, rows.size());
+
+    RowMapper<Row> mismatch;
+    mismatch.Map("id", &Row::id).Map("name", &Row::id);
+    EXPECT_THROW(mismatch.Read(block, &rows), std::runtime_error);
+    EXPECT_EQ(4u, rows.size());
+}
+
+static Block MakeNumbers(uint64_t begin, uint64_t end) {
+    auto numbers = std::make_shared<ColumnUInt64>();
+    auto names = std::make_shared<ColumnString>();
+    for (uint64_t i = begin; i < end; ++i) {
+        numbers->Append(i);
+        names->Append(std::to_string(i));
+    }
+    Block block;
+    block.AppendColumn("n", numbers);
+    block.AppendColumn("s", names);
+    return block;
+}
+
+TEST(BlockCase, AppendAndSlice) {
+    Block block;
+    block.Append(MakeNumbers(0, 3));
+    block.Append(MakeNumbers(3, 5));
+    ASSERT_EQ(2u, block.GetColumnCount());
+    ASSERT_EQ(5u, block.GetRowCount());
+    EXPECT_EQ(4u, block[0]->As<ColumnUInt64>()->At(4));
+    EXPECT_EQ("3", block[1]->As<ColumnString>()->At(3));
+
+    // Copies of the block share its columns and keep their rows.
+    const Block shared = block;
+    const ColumnRef held = block[0];
+    block.Append(block);
+    ASSERT_EQ(10u, block.GetRowCount());
+    EXPECT_EQ("4", block[1]->As<ColumnString>()->At(9));
+    EXPECT_EQ(5u, shared.GetRowCount());
+    EXPECT_EQ(5u, shared[0]->Size());
+    EXPECT_EQ(5u, shared[1]->Size());
+    EXPECT_EQ(5u, held->Size());
+
+    const Block slice = block.Slice(3, 4);
+    ASSERT_EQ(4u, slice.GetRowCount());
+    EXPECT_EQ("s", slice.GetColumnName(1));
+    EXPECT_EQ(3u, slice[0]->As<ColumnUInt64>()->At(0));
+    EXPECT_EQ(1u, slice[0]->As<ColumnUInt64>()->At(3));
+    EXPECT_THROW(block.Slice(8, 3), std::out_of_range);
+
+    Block other;
+    other.AppendColumn("n", std::make_shared<ColumnUInt32>());
+    other.AppendColumn("s", std::make_shared<ColumnString>());
+    EXPECT_THROW(block.Append(other), std::runtime_error);
+    EXPECT_EQ(10u, block.GetRowCount());
+
+    // Copies and slices keep the time zone of DateTime columns.
+    Block times;
+    auto utc = CreateColumnByType("DateTime('UTC')")->As<ColumnDateTime>();
+    utc->Append(std::time_t(1000));
+    utc->Append(std::time_t(2000));
+    times.AppendColumn("t", utc);
+
+    Block copy;
+    copy.Append(times);
+    ASSERT_NO_THROW(copy.Append(times));
+    EXPECT_EQ(4u, copy.GetRowCount());
+    EXPECT_EQ("DateTime('UTC')", copy[0]->Type()->GetName());
+    EXPECT_EQ("DateTime('UTC')", times.Slice(1, 1)[0]->Type()->GetName());
+    EXPECT_EQ("DateTime('UTC')", Block::Concat({times, times})[0]->Type()->GetName());
+    EXPECT_EQ("DateTime('UTC')", times.SplitByRows(1)[1][0]->Type()->GetName());
+    EXPECT_EQ(2000, times.SplitByRows(1)[1][0]->As<ColumnDateTime>()->At(0));
+}
+
+TEST(BlockCase, Split) {
+    const Block block = MakeNumbers(0, 10);
+
+    const auto chunks = block.SplitByRows(4);
+    ASSERT_EQ(3u, chunks.size());
+    EXPECT_EQ(4u, chunks[0].GetRowCount());
+    EXPECT_EQ(2u, chunks[2].GetRowCount());
+    EXPECT_EQ(8u, chunks[2][0]->As<ColumnUInt64>()->At(0));
+
+    const Block whole = Block::Concat(chunks);
+    ASSERT_EQ(10u, whole.GetRowCount());
+    for (size_t i = 0; i < 10; ++i) {
+        EXPECT_EQ(i, whole[0]->As<ColumnUInt64>()->At(i));
+        EXPECT_EQ(std::to_string(i), whole[1]->As<ColumnString>()->At(i));
+    }
+
+    // Half of the memory takes half of the rows.
+    const auto by_bytes = block.SplitByBytes((block.MemoryUsage() + 1) / 2);
+    ASSERT_EQ(2u, by_bytes.size());
+    EXPECT_EQ(5u, by_bytes[1].GetRowCount());
+    EXPECT_EQ(10u, block.SplitByBytes(1).size());
+}
+
+TEST(BlockCase, FilterTake) {
+    const Block block = MakeNumbers(0, 5);
+
+    const std::vector<uint8_t> mask = {1, 0, 0, 1, 1};
+    const Block filtered = block.Filter(mask.data());
+    ASSERT_EQ(3u, filtered.GetRowCount());
+    EXPECT_EQ("s", filtered.GetColumnName(1));
+    EXPECT_EQ(3u, filtered[0]->As<ColumnUInt64>()->At(1));
+    EXPECT_EQ("4", filtered[1]->As<ColumnString>()->At(2));
+
+    const std::vector<uint32_t> indices = {4, 4, 1};
+    const Block taken = block.Take(indices.data(), indices.size());
+    ASSERT_EQ(3u, taken.GetRowCount());
+    EXPECT_EQ(4u, taken[0]->As<ColumnUInt64>()->At(1));
+    EXPECT_EQ("1", taken[1]->As<ColumnString>()->At(2));
+}
+
+TEST(BlockCase, PartitionByHash) {
+    const Block block = MakeNumbers(0, 10);
+
+    const auto parts = block.PartitionByHash(0, 3);
+    ASSERT_EQ(3u, parts.size());
+    ASSERT_EQ(3u, parts[0].GetRowCount());
+    ASSERT_EQ(2u, parts[1].GetRowCount());
+    ASSERT_EQ(5u, parts[2].GetRowCount());
+    EXPECT_EQ(6u, parts[0][0]->As<ColumnUInt64>()->At(2));
+    EXPECT_EQ(7u, parts[1][0]->As<ColumnUInt64>()->At(1));
+    EXPECT_EQ("4", parts[2][1]->As<ColumnString>()->At(2));
+
+    EXPECT_THROW(block.PartitionByHash(0, 0), std::invalid_argument);
+    EXPECT_THROW(block.PartitionByHash(2, 3), std::out_of_range);
+}
+
+TEST(BlockCase, HashColumn) {
+    // Integers are hashed by their bits, as cityHash64 of ClickHouse does.
+    uint64_t hashes[3];
+    HashColumn(std::make_shared<ColumnInt32>(std::vector<int32_t>{0, 1, -1}), hashes);
+    EXPECT_EQ(0u, hashes[0]);
+    EXPECT_EQ(12994781566227106604u, hashes[1]);
+    EXPECT_EQ(14731816277868330182u, hashes[2]);
+
+    // Values of LowCardinality are hashed as the values themselves.
+    auto names = std::make_shared<ColumnString>(std::vector<std::string>{"a", "bc", "a"});
+    auto kinds = std::make_shared<ColumnLowCardinality>(std::make_shared<ColumnString>());
+    for (size_t i = 0; i < names->Size(); ++i) {
+        kinds->Append((*names)[i]);
+    }
+    uint64_t expected[3];
+    HashColumn(names, expected);
+    HashColumn(kinds, hashes);
+    EXPECT_EQ(expected[0], hashes[0]);
+    EXPECT_EQ(expected[1], hashes[1]);
+    EXPECT_EQ(expected[0], expected[2]);
+    EXPECT_NE(expected[0], expected[1]);
+
+    auto scores = std::make_shared<ColumnNullable>(
+        std::make_shared<ColumnFloat64>(std::vector<double>{1}),
+        std::make_shared<ColumnUInt8>(std::vector<uint8_t>{0}));
+    EXPECT_THROW(HashColumn(scores, hashes), std::runtime_error);
+}
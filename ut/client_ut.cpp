@@ -1,6 +1,12 @@
+#include "tcp_server.h"
+
 #include <clickhouse/client.h>
 #include <contrib/gtest/gtest.h>
 
+#include <set>
+#include <thread>
+#include <vector>
+
 using namespace clickhouse;
 
 // Use value-parameterized tests to run same tests with different client
@@ -248,6 +254,81 @@ TEST_P(ClientCase, Numbers) {
     EXPECT_EQ(100000U, num);
 }
 
+TEST_P(ClientCase, BlockPool) {
+    Client client(ClientOptions(GetParam()).SetBlockPoolSize(2));
+    std::set<const Column*> columns;
+    Block kept;
+    size_t num = 0;
+
+    client.Select("SELECT number FROM system.numbers LIMIT 10000 SETTINGS max_block_size = 1000",
+        [&](const Block& block)
+        {
+            if (block.GetRowCount() == 0) {
+                return;
+            }
+            // A held block must not be overwritten by the next ones.
+            if (num == 0) {
+                kept = block;
+            }
+            columns.insert(block[0].get());
+
+            auto col = block[0]->As<ColumnUInt64>();
+            for (size_t i = 0; i < col->Size(); ++i, ++num) {
+                EXPECT_EQ(num, col->At(i));
+            }
+        }
+    );
+    EXPECT_EQ(10000U, num);
+    // The first block is held, all other ones reuse the same column.
+    EXPECT_EQ(2U, columns.size());
+    ASSERT_EQ(1000U, kept.GetRowCount());
+    EXPECT_EQ(999U, kept[0]->As<ColumnUInt64>()->At(999));
+}
+
+TEST_P(ClientCase, BlockPoolNested) {
+    Client client(ClientOptions(GetParam()).SetBlockPoolSize(1));
+    ColumnRef kept;
+    size_t num = 0;
+
+    client.Select("SELECT toNullable(number) FROM system.numbers LIMIT 10000 SETTINGS max_block_size = 1000",
+        [&](const Block& block)
+        {
+            if (block.GetRowCount() == 0) {
+                return;
+            }
+            // Holding a nested column keeps it from being overwritten.
+            if (num == 0) {
+                kept = block[0]->As<ColumnNullable>()->Nested();
+            }
+            num += block.GetRowCount();
+        }
+    );
+    EXPECT_EQ(10000U, num);
+    ASSERT_EQ(1000U, kept->Size());
+    EXPECT_EQ(999U, kept->As<ColumnUInt64>()->At(999));
+}
+
+TEST_P(ClientCase, ColumnStats) {
+    Client client(ClientOptions(GetParam()).SetColumnStats(true).SetBlockPoolSize(1));
+    size_t num = 0;
+
+    client.Select("SELECT number FROM system.numbers LIMIT 10000 SETTINGS max_block_size = 1000",
+        [&](const Block& block)
+        {
+            if (block.GetRowCount() == 0) {
+                return;
+            }
+            auto stats = block.GetColumnStats(0);
+            ASSERT_NE(nullptr, stats);
+            EXPECT_EQ(block.GetRowCount(), stats->rows);
+            EXPECT_EQ(num, std::get<uint64_t>(stats->min));
+            num += block.GetRowCount();
+            EXPECT_EQ(num - 1, std::get<uint64_t>(stats->max));
+        }
+    );
+    EXPECT_EQ(10000U, num);
+}
+
 TEST_P(ClientCase, Cancelable) {
     /// Create a table.
     client_->Execute(
@@ -371,3 +452,160 @@ INSTANTIATE_TEST_CASE_P(
             .SetCompressionMethod(CompressionMethod::LZ4)
     ));
 
+namespace {
+
+/// Waits up to a few seconds for the condition to become true.
+template <typename Condition>
+bool WaitFor(Condition&& condition) {
+    for (int i = 0; i < 500; ++i) {
+        if (condition()) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return condition();
+}
+
+/// Data packet of a block with a single Nullable(UInt64) column.
+std::string NullableDataPacket(const std::vector<uint8_t>& values) {
+    // Code, table name and block info: is_overflows and bucket_num.
+    std::string packet("\x01" "\x00" "\x01\x00" "\x02\xff\xff\xff\xff" "\x00", 10);
+    packet += '\x01';
+    packet += static_cast<char>(values.size());
+    packet += "\x01" "x" "\x10" "Nullable(UInt64)";
+    packet.append(values.size(), '\x00');
+    for (uint8_t value : values) {
+        packet += static_cast<char>(value);
+        packet.append(7, '\x00');
+    }
+    return packet;
+}
+
+}
+
+TEST(RetryCase, Backoff) {
+    const auto options = ClientOptions()
+        .SetRetryTimeout(std::chrono::seconds(1))
+        .SetRetryTimeoutMax(std::chrono::seconds(5));
+
+    for (unsigned int attempt = 0; attempt < 8; ++attempt) {
+        // 1s, 2s, 4s, then capped by retry_timeout_max.
+        const std::chrono::milliseconds expected = std::min(
+            std::chrono::milliseconds(1000 << std::min(attempt, 3u)), std::chrono::milliseconds(5000));
+
+        for (int i = 0; i < 20; ++i) {
+            const auto delay = GetRetryDelay(options, attempt);
+            ASSERT_GE(delay, expected / 2);
+            ASSERT_LE(delay, expected);
+        }
+    }
+
+    // Delays of many clients are spread.
+    std::set<int64_t> delays;
+    for (int i = 0; i < 100; ++i) {
+        delays.insert(GetRetryDelay(options, 10).count());
+    }
+    ASSERT_GT(delays.size(), 1u);
+
+    // Without a greater retry_timeout_max the delay is fixed.
+    const auto fixed = ClientOptions().SetRetryTimeout(std::chrono::seconds(3));
+    for (unsigned int attempt = 0; attempt < 4; ++attempt) {
+        ASSERT_EQ(std::chrono::milliseconds(3000), GetRetryDelay(fixed, attempt));
+    }
+}
+
+TEST(RetryCase, SpareConnection) {
+    LocalHandshakeServer server(9976);
+    server.start();
+
+    Client client(ClientOptions()
+        .SetHost("127.0.0.1")
+        .SetPort(9976)
+        .SetPingBeforeQuery(true)
+        .SetRetryTimeout(std::chrono::seconds(10))
+        .SpareConnection(true));
+
+    ASSERT_TRUE(WaitFor([&server] { return server.connections() == 2; }));
+
+    // The query goes over the spare connection without waiting for
+    // the retry timeout.
+    server.drop(0);
+    const auto start = std::chrono::steady_clock::now();
+    client.Execute("SELECT 1");
+    ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+
+    // A new spare connection replaces the used one.
+    ASSERT_TRUE(WaitFor([&server] { return server.connections() == 3; }));
+}
+
+TEST(RetryCase, SpareConnectionWithoutPing) {
+    LocalHandshakeServer server(9974);
+    server.start();
+
+    Client client(ClientOptions()
+        .SetHost("127.0.0.1")
+        .SetPort(9974)
+        .SetRetryTimeout(std::chrono::seconds(10))
+        .SpareConnection(true));
+
+    ASSERT_TRUE(WaitFor([&server] { return server.connections() == 2; }));
+
+    // Sending the query fails on the reset connection and it is sent
+    // again over the spare one.
+    server.drop(0, true);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    client.Execute("SELECT 1");
+
+    ASSERT_TRUE(WaitFor([&server] { return server.connections() == 3; }));
+    client.Execute("SELECT 1");
+}
+
+TEST(RetryCase, SpareHandshakeIsCancelled) {
+    // The spare connection is accepted but never handshaked.
+    LocalHandshakeServer server(9975, 1);
+    server.start();
+
+    const auto start = std::chrono::steady_clock::now();
+    {
+        Client client(ClientOptions()
+            .SetHost("127.0.0.1")
+            .SetPort(9975)
+            .SpareConnection(true));
+
+        ASSERT_TRUE(WaitFor([&server] { return server.connections() == 2; }));
+    }
+    ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(3));
+}
+
+TEST(BlockPoolCase, HeldNestedColumn) {
+    LocalHandshakeServer server(9973);
+    server.setQueryReply(NullableDataPacket({1, 2, 3}) + NullableDataPacket({4, 5}));
+    server.start();
+
+    Client client(ClientOptions()
+        .SetHost("127.0.0.1")
+        .SetPort(9973)
+        .SetBlockPoolSize(1));
+
+    ColumnRef kept;
+    std::vector<uint64_t> values;
+
+    client.Select("SELECT x", [&](const Block& block) {
+        if (block.GetRowCount() == 0) {
+            return;
+        }
+        auto col = block[0]->As<ColumnNullable>();
+        // The second block must not be read into the held nested column.
+        if (!kept) {
+            kept = col->Nested();
+        }
+        for (size_t i = 0; i < col->Size(); ++i) {
+            values.push_back(col->Nested()->As<ColumnUInt64>()->At(i));
+        }
+    });
+
+    EXPECT_EQ(std::vector<uint64_t>({1, 2, 3, 4, 5}), values);
+    ASSERT_EQ(3U, kept->Size());
+    EXPECT_EQ(1U, kept->As<ColumnUInt64>()->At(0));
+    EXPECT_EQ(3U, kept->As<ColumnUInt64>()->At(2));
+}
@@ -1,14 +1,27 @@
+#include <clickhouse/block.h>
 #include <clickhouse/columns/array.h>
 #include <clickhouse/columns/date.h>
+#include <clickhouse/columns/decimal.h>
 #include <clickhouse/columns/enum.h>
 #include <clickhouse/columns/factory.h>
+#include <clickhouse/columns/ip4.h>
+#include <clickhouse/columns/lowcardinality.h>
+#include <clickhouse/columns/map.h>
 #include <clickhouse/columns/nullable.h>
 #include <clickhouse/columns/numeric.h>
+#include <clickhouse/columns/stats.h>
 #include <clickhouse/columns/string.h>
+#include <clickhouse/columns/tuple.h>
 #include <clickhouse/columns/uuid.h>
 
+#include <clickhouse/base/coded.h>
+
 #include <contrib/gtest/gtest.h>
 
+#include <cmath>
+#include <limits>
+#include <map>
+
 using namespace clickhouse;
 
 static std::vector<uint32_t> MakeNumbers() {
@@ -98,6 +111,72 @@ TEST(ColumnsCase, ArrayAppend) {
     //ASSERT_EQ(col->As<ColumnUInt64>()->At(1), 3u);
 }
 
+TEST(ColumnsCase, ArraySlice) {
+    auto arr = std::make_shared<ColumnArray>(std::make_shared<ColumnUInt64>());
+
+    for (uint64_t i = 0; i < 5; ++i) {
+        auto id = std::make_shared<ColumnUInt64>();
+        for (uint64_t j = 0; j < i; ++j) {
+            id->Append(i * 10 + j);
+        }
+        arr->AppendAsColumn(id);
+    }
+
+    auto sub = arr->Slice(2, 2)->As<ColumnArray>();
+    ASSERT_EQ(sub->Size(), 2u);
+    ASSERT_EQ(sub->GetAsColumn(0)->Size(), 2u);
+    ASSERT_EQ(sub->GetAsColumn(1)->As<ColumnUInt64>()->At(2), 32u);
+
+    // Bounds are clamped to the size of the column.
+    ASSERT_EQ(arr->Slice(3, 100)->Size(), 2u);
+    ASSERT_EQ(arr->Slice(10, 1)->Size(), 0u);
+    ASSERT_EQ(arr->Slice(0, 0)->Size(), 0u);
+
+    sub->Append(arr->Slice(0, 2));
+    sub->Append(sub);
+    ASSERT_EQ(sub->Size(), 8u);
+    ASSERT_EQ(sub->GetAsColumn(2)->Size(), 0u);
+    ASSERT_EQ(sub->GetAsColumn(3)->As<ColumnUInt64>()->At(0), 10u);
+    ASSERT_EQ(sub->GetAsColumn(5)->As<ColumnUInt64>()->At(2), 32u);
+    ASSERT_EQ(sub->GetAsColumn(7)->As<ColumnUInt64>()->At(0), 10u);
+}
+
+TEST(ColumnsCase, ArrayTWrap) {
+    auto arr = std::make_shared<ColumnArray>(std::make_shared<ColumnUInt64>());
+    for (uint64_t i = 0; i < 4; ++i) {
+        auto id = std::make_shared<ColumnUInt64>();
+        for (uint64_t j = 0; j < i; ++j) {
+            id->Append(i * 10 + j);
+        }
+        arr->AppendAsColumn(id);
+    }
+
+    auto typed = ColumnArrayT<ColumnUInt64>::Wrap(arr);
+    ASSERT_EQ(typed->Size(), 4u);
+    ASSERT_TRUE(typed->At(0).Empty());
+    ASSERT_EQ(typed->At(3).Size(), 3u);
+    ASSERT_EQ(typed->At(3)[1], 31u);
+    ASSERT_EQ(typed->At(2).Data()[1], 21u);
+    ASSERT_THROW(typed->At(2).At(2), std::out_of_range);
+    ASSERT_THROW(typed->At(4), std::out_of_range);
+
+    uint64_t sum = 0;
+    for (const auto& value : typed->At(3)) {
+        sum += value;
+    }
+    ASSERT_EQ(sum, 30u + 31u + 32u);
+
+    auto sub = typed->Slice(2, 2)->As<ColumnArrayT<ColumnUInt64>>();
+    ASSERT_NE(nullptr, sub);
+    ASSERT_EQ(sub->At(1)[2], 32u);
+
+    ASSERT_THROW(ColumnArrayT<ColumnString>::Wrap(arr), std::runtime_error);
+
+    auto strings = std::make_shared<ColumnArrayT<ColumnString>>(std::make_shared<ColumnString>());
+    strings->AppendAsColumn(std::make_shared<ColumnString>(MakeStrings()));
+    ASSERT_EQ(strings->At(0)[1], "ab");
+}
+
 TEST(ColumnsCase, DateAppend) {
     auto col1 = std::make_shared<ColumnDate>();
     auto col2 = std::make_shared<ColumnDate>();
@@ -127,6 +206,134 @@ TEST(ColumnsCase, DateTime) {
     ASSERT_EQ(CreateColumnByType("DateTime64(3, 'UTC')")->As<ColumnDateTime64>()->Timezone(), "UTC");
 }
 
+TEST(ColumnsCase, Date32) {
+    auto col = CreateColumnByType("Date32")->As<ColumnDate32>();
+    ASSERT_NE(nullptr, col);
+    col->Append(std::time_t(-86400 * 100 - 1));
+    col->Append(std::time_t(86400 * 3 + 5));
+    ASSERT_EQ(col->At(0), -86400 * 101);
+    ASSERT_EQ(col->At(1), 86400 * 3);
+    ASSERT_EQ(col->Slice(1, 1)->As<ColumnDate32>()->At(0), 86400 * 3);
+}
+
+TEST(ColumnsCase, DateUnixNanos) {
+    constexpr int64_t kDay = 86400ll * 1000000000ll;
+
+    // Sizes which are not multiple of the vector width exercise tails.
+    auto date = std::make_shared<ColumnDate>();
+    auto date32 = std::make_shared<ColumnDate32>();
+    auto datetime = std::make_shared<ColumnDateTime>();
+    for (int64_t i = 0; i < 19; ++i) {
+        date->Append(std::time_t(65535 - i) * 86400);
+        date32->Append(std::time_t(i * 10000 - 100000) * 86400);
+        datetime->Append(std::time_t(4294967295ll - i * 100000000));
+    }
+
+    std::vector<int64_t> nanos(19);
+    date->GetUnixNanos(0, 19, nanos.data());
+    for (int64_t i = 0; i < 19; ++i) {
+        ASSERT_EQ(nanos[i], (65535 - i) * kDay);
+    }
+    date32->GetUnixNanos(0, 19, nanos.data());
+    for (int64_t i = 0; i < 19; ++i) {
+        ASSERT_EQ(nanos[i], (i * 10000 - 100000) * kDay);
+    }
+    datetime->GetUnixNanos(0, 19, nanos.data());
+    for (int64_t i = 0; i < 19; ++i) {
+        ASSERT_EQ(nanos[i], (4294967295ll - i * 100000000) * 1000000000ll);
+    }
+    datetime->GetUnixNanos(18, 1, nanos.data());
+    ASSERT_EQ(nanos[0], datetime->At(18) * 1000000000ll);
+    ASSERT_THROW(datetime->GetUnixNanos(10, 10, nanos.data()), std::out_of_range);
+
+    std::vector<TimePoint> points(3);
+    date->GetTimePoints(1, 3, points.data());
+    ASSERT_EQ(points[0].time_since_epoch().count(), 65534 * kDay);
+
+    auto ms = std::make_shared<ColumnDateTime64>(3);
+    ms->Append(1500);
+    ms->Append(static_cast<uint64_t>(-2500));
+    ms->GetUnixNanos(0, 2, nanos.data());
+    ASSERT_EQ(nanos[0], 1500000000);
+    ASSERT_EQ(nanos[1], -2500000000);
+    ASSERT_EQ(ms->GetPrecision(), 3u);
+}
+
+TEST(ColumnsCase, DateUnixNanosSaturate) {
+    constexpr int64_t kDay = 86400ll * 1000000000ll;
+    constexpr int64_t kMax = std::numeric_limits<int64_t>::max();
+    constexpr int64_t kMin = std::numeric_limits<int64_t>::min();
+
+    // 2299-12-31 and 1641-06-14 are beyond the range of nanoseconds.
+    auto date32 = std::make_shared<ColumnDate32>();
+    for (int64_t i = 0; i < 9; ++i) {
+        date32->Append(std::time_t(i == 5 ? 120529 : i == 6 ? -120000 : i * 1000) * 86400);
+    }
+    std::vector<int64_t> nanos(9);
+    date32->GetUnixNanos(0, 9, nanos.data());
+    for (int64_t i = 0; i < 9; ++i) {
+        ASSERT_EQ(nanos[i], i == 5 ? kMax : i == 6 ? kMin : i * 1000 * kDay);
+    }
+    date32->GetUnixNanos(5, 2, nanos.data());
+    ASSERT_EQ(nanos[0], kMax);
+    ASSERT_EQ(nanos[1], kMin);
+
+    auto ms = std::make_shared<ColumnDateTime64>(3);
+    ms->Append(uint64_t(10000000000000ll));
+    ms->Append(static_cast<uint64_t>(-10000000000000ll));
+    ms->GetUnixNanos(0, 2, nanos.data());
+    ASSERT_EQ(nanos[0], kMax);
+    ASSERT_EQ(nanos[1], kMin);
+
+    ms->GetLocalUnixNanos(0, 2, nanos.data(), *TimeZone::Fixed("UTC+1", 3600));
+    ASSERT_EQ(nanos[0], kMax);
+    ms->GetLocalUnixNanos(0, 2, nanos.data(), *TimeZone::Fixed("UTC-1", -3600));
+    ASSERT_EQ(nanos[1], kMin);
+}
+
+TEST(ColumnsCase, DateTimeLocalNanos) {
+    auto datetime = std::make_shared<ColumnDateTime>();
+    datetime->Append(std::time_t(1000));
+
+    std::vector<int64_t> nanos(1);
+    datetime->GetLocalUnixNanos(0, 1, nanos.data(), *TimeZone::Fixed("UTC+1", 3600));
+    ASSERT_EQ(nanos[0], 4600ll * 1000000000ll);
+
+    std::shared_ptr<const TimeZone> moscow;
+    std::shared_ptr<const TimeZone> berlin;
+    try {
+        moscow = TimeZone::Load("Europe/Moscow");
+        berlin = TimeZone::Load("Europe/Berlin");
+    } catch (const std::runtime_error&) {
+        // System tz database is not available.
+        return;
+    }
+
+    ASSERT_EQ(moscow, TimeZone::Load("Europe/Moscow"));
+    ASSERT_EQ(moscow->OffsetAt(1277942400), 4 * 3600); // 2010-07-01, summer time
+    ASSERT_EQ(moscow->OffsetAt(1262304000), 3 * 3600); // 2010-01-01
+    ASSERT_EQ(moscow->OffsetAt(1420070400), 3 * 3600); // 2015-01-01
+
+    // Far future offsets come from the expanded POSIX rule.
+    ASSERT_EQ(berlin->OffsetAt(4118083200), 2 * 3600); // 2100-07-01
+    ASSERT_EQ(berlin->OffsetAt(4133808000), 1 * 3600); // 2100-12-30
+    ASSERT_EQ(berlin->OffsetAt(1909008000), 2 * 3600); // 2030-06-30
+    ASSERT_EQ(berlin->OffsetAt(1893456000), 1 * 3600); // 2030-01-01
+
+    auto times = std::make_shared<ColumnDateTime64>(6);
+    times->Append(uint64_t(1909008000) * 1000000);
+    times->Append(uint64_t(1893456000) * 1000000);
+    times->Append(uint64_t(1909008000) * 1000000 + 1);
+    std::vector<int64_t> local(3);
+    times->GetLocalUnixNanos(0, 3, local.data(), *berlin);
+    ASSERT_EQ(local[0], (1909008000ll + 7200) * 1000000000ll);
+    ASSERT_EQ(local[1], (1893456000ll + 3600) * 1000000000ll);
+    ASSERT_EQ(local[2], (1909008000ll + 7200) * 1000000000ll + 1000);
+
+    ASSERT_THROW(TimeZone::Load("../etc/passwd"), std::runtime_error);
+    ASSERT_THROW(TimeZone::FromTZif("bad", "TZif2"), std::runtime_error);
+}
+
 TEST(ColumnsCase, EnumTest) {
     std::vector<Type::EnumItem> enum_items = {{"Hi", 1}, {"Hello", 2}};
 
@@ -164,6 +371,65 @@ TEST(ColumnsCase, NullableSlice) {
     ASSERT_EQ(subData->At(3), 17u);
 }
 
+TEST(ColumnsCase, NullableBulkNulls) {
+    std::vector<uint8_t> flags(75, 0);
+    for (size_t i : {3, 16, 17, 40, 74}) {
+        flags[i] = 1;
+    }
+    auto col = std::make_shared<ColumnNullable>(
+        std::make_shared<ColumnUInt32>(std::vector<uint32_t>(flags.size())),
+        std::make_shared<ColumnUInt8>(flags));
+
+    ASSERT_EQ(col->NullCount(), 5u);
+    ASSERT_TRUE(col->HasNull());
+    ASSERT_FALSE(col->AllNull());
+    ASSERT_EQ(col->FindNextNull(4), 16u);
+    ASSERT_EQ(col->FindNextNull(41), 74u);
+    ASSERT_EQ(col->FindNextNull(75), 75u);
+    ASSERT_EQ(col->FindNextNonNull(16), 18u);
+    ASSERT_EQ(col->FindNextNonNull(74), 75u);
+
+    std::vector<size_t> nulls;
+    col->ForEachNull([&nulls] (size_t n) { nulls.push_back(n); });
+    ASSERT_EQ(nulls, std::vector<size_t>({3, 16, 17, 40, 74}));
+
+    std::vector<uint8_t> bitmap((col->Size() + 7) / 8);
+    col->GetNullBitmap(bitmap.data());
+    for (size_t i = 0; i < flags.size(); ++i) {
+        ASSERT_EQ((bitmap[i / 8] >> (i % 8)) & 1, flags[i]) << i;
+    }
+    col->GetNullBitmap(bitmap.data(), true);
+    for (size_t i = 0; i < flags.size(); ++i) {
+        ASSERT_EQ((bitmap[i / 8] >> (i % 8)) & 1, !flags[i]) << i;
+    }
+
+    col->Append(col->Slice(0, 4));
+    ASSERT_EQ(col->NullCount(), 6u);
+    col->Clear();
+    ASSERT_FALSE(col->HasNull());
+
+    auto all = std::make_shared<ColumnNullable>(
+        std::make_shared<ColumnUInt32>(std::vector<uint32_t>(20)),
+        std::make_shared<ColumnUInt8>(std::vector<uint8_t>(20, 1)));
+    ASSERT_TRUE(all->AllNull());
+    ASSERT_EQ(all->FindNextNonNull(0), 20u);
+
+    // Null flags refilled through Nulls() to the same size are seen.
+    auto refilled = std::make_shared<ColumnNullable>(
+        std::make_shared<ColumnUInt32>(std::vector<uint32_t>(3)),
+        std::make_shared<ColumnUInt8>(std::vector<uint8_t>(3)));
+    ASSERT_EQ(refilled->NullCount(), 0u);
+    auto refilled_nulls = refilled->Nulls()->As<ColumnUInt8>();
+    refilled_nulls->Clear();
+    for (uint8_t flag : {0, 1, 0}) {
+        refilled_nulls->Append(flag);
+    }
+    ASSERT_TRUE(refilled->IsNull(1));
+    ASSERT_EQ(refilled->NullCount(), 1u);
+    ASSERT_TRUE(refilled->HasNull());
+    ASSERT_EQ(refilled->FindNextNull(0), 1u);
+}
+
 TEST(ColumnsCase, UUIDInit) {
     auto col = std::make_shared<ColumnUUID>(std::make_shared<ColumnUInt64>(MakeUUIDs()));
 
@@ -181,6 +447,156 @@ TEST(ColumnsCase, UUIDSlice) {
     ASSERT_EQ(sub->At(1), UInt128(0x3507213c178649f9llu, 0x9faf035d662f60aellu));
 }
 
+TEST(ColumnsCase, MemoryUsage) {
+    auto numbers = std::make_shared<ColumnUInt64>();
+    numbers->Reserve(1000);
+    ASSERT_EQ(numbers->MemoryUsage(), 8000u);
+    numbers->Append(1);
+    numbers->ShrinkToFit();
+    ASSERT_EQ(numbers->MemoryUsage(), 8u);
+
+    auto strings = std::make_shared<ColumnString>();
+    strings->Append(std::string(100, 'a'));
+    strings->Append("b");
+    const size_t string_usage = strings->MemoryUsage();
+    ASSERT_GE(string_usage, 2 * sizeof(std::string) + 101);
+    strings->Append(strings->Slice(0, 1));
+    ASSERT_GE(strings->MemoryUsage(), string_usage + 101);
+    strings->Clear();
+    strings->ShrinkToFit();
+    ASSERT_EQ(strings->MemoryUsage(), 0u);
+    strings->Append("c");
+
+    auto nullable = std::make_shared<ColumnNullable>(std::make_shared<ColumnUInt32>(), std::make_shared<ColumnUInt8>());
+    nullable->Reserve(10);
+    ASSERT_EQ(nullable->MemoryUsage(), 10u * 4 + 10u);
+
+    auto uuids = std::make_shared<ColumnUUID>();
+    uuids->Reserve(100);
+    ASSERT_EQ(uuids->MemoryUsage(), 100u * 16);
+
+    auto tuple = std::make_shared<ColumnTuple>(std::vector<ColumnRef>{
+        std::make_shared<ColumnUInt8>(), std::make_shared<ColumnDate>()});
+    tuple->Reserve(4);
+    ASSERT_EQ(tuple->MemoryUsage(), 4u * 1 + 4u * 2);
+
+    auto array = std::make_shared<ColumnArray>(std::make_shared<ColumnUInt64>());
+    array->Reserve(3);
+    array->AppendAsColumn(std::make_shared<ColumnUInt64>(std::vector<uint64_t>{1, 2}));
+    ASSERT_GE(array->MemoryUsage(), 3u * 8 + 2u * 8);
+
+    auto lc = std::make_shared<ColumnLowCardinality>(std::make_shared<ColumnString>());
+    lc->Reserve(300);
+    for (int i = 0; i < 300; ++i) {
+        lc->Append(std::to_string(i));
+    }
+    // Index became 16-bit and kept the reserved capacity.
+    ASSERT_EQ(lc->GetIndexColumn()->MemoryUsage(), 300u * 2);
+
+    Block block;
+    block.AppendColumn("n", numbers);
+    block.AppendColumn("s", strings);
+    ASSERT_EQ(block.MemoryUsage(), numbers->MemoryUsage() + strings->MemoryUsage());
+}
+
+namespace {
+
+/// Counts bytes currently allocated through it.
+class CountingResource : public std::pmr::memory_resource {
+public:
+    size_t allocated = 0;
+
+    /// Returns true if the object is inside of a block allocated through it.
+    bool Owns(const void* object) const {
+        const auto p = static_cast<const char*>(object);
+        auto it = blocks_.upper_bound(p);
+        return it != blocks_.begin() && p < (--it)->first + it->second;
+    }
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        allocated += bytes;
+        void* p = std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        blocks_[static_cast<const char*>(p)] = bytes;
+        return p;
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        allocated -= bytes;
+        blocks_.erase(static_cast<const char*>(p));
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    std::map<const char*, size_t> blocks_;
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+}
+
+TEST(ColumnsCase, MemoryResource) {
+    CountingResource resource;
+    {
+        auto col = CreateColumnByType("Array(Nullable(UInt64))", &resource);
+        ASSERT_EQ(col->GetMemoryResource(), &resource);
+
+        auto array = col->As<ColumnArray>();
+        auto values = MakeColumn<ColumnUInt64>(&resource);
+        auto nulls = MakeColumn<ColumnUInt8>(&resource);
+        for (uint64_t i = 0; i < 100; ++i) {
+            values->Append(i);
+            nulls->Append(i % 2);
+        }
+        array->AppendAsColumn(std::make_shared<ColumnNullable>(values, nulls));
+        ASSERT_GE(resource.allocated, 100u * 9);
+
+        auto slice = array->Slice(0, 1);
+        ASSERT_EQ(slice->GetMemoryResource(), &resource);
+
+        Block block(&resource);
+        block.AppendColumn("a", slice);
+        ASSERT_EQ(block.GetMemoryResource(), &resource);
+    }
+    // Everything has been returned to the resource.
+    ASSERT_EQ(resource.allocated, 0u);
+
+    auto def = CreateColumnByType("LowCardinality(String)");
+    ASSERT_EQ(def->GetMemoryResource(), std::pmr::get_default_resource());
+}
+
+TEST(ColumnsCase, DerivedColumnsUseResource) {
+    CountingResource resource;
+    const uint8_t mask[] = {1, 0};
+    const uint32_t indices[] = {1, 0};
+
+    for (const char* type : {"Array(UInt8)", "Map(String, UInt64)", "Nullable(UInt64)",
+            "Tuple(UInt8, String)", "IPv4", "IPv6", "UUID", "DateTime64(3, 'UTC')", "Decimal(12, 3)"}) {
+        SCOPED_TRACE(type);
+        auto col = CreateColumnByType(type, &resource);
+        ASSERT_NE(nullptr, col);
+
+        const ColumnRef derived[] = {col->Slice(0, 0), col->Filter(mask), col->Take(indices, 0)};
+        for (const auto& d : derived) {
+            EXPECT_TRUE(resource.Owns(d.get()));
+            EXPECT_TRUE(d->Type()->IsEqual(col->Type()));
+        }
+    }
+
+    auto ip = MakeColumn<ColumnIPv4>(&resource);
+    ip->Append("127.0.0.1");
+    ip->Append("10.0.0.1");
+    EXPECT_EQ("10.0.0.1", ip->Slice(1, 1)->As<ColumnIPv4>()->AsString(0));
+
+    // The array and tuple holding keys and values come from the resource.
+    auto keys = MakeColumn<ColumnString>(&resource);
+    auto values = MakeColumn<ColumnUInt64>(&resource);
+    const size_t allocated = resource.allocated;
+    auto map = MakeColumn<ColumnMap>(&resource, keys, values);
+    EXPECT_GE(resource.allocated - allocated, sizeof(ColumnMap) + sizeof(ColumnArray) + sizeof(ColumnTuple));
+}
+
 TEST(ColumnsCase, UnmatchedBrackets) {
     ASSERT_NE(nullptr, CreateColumnByType("FixedString(10)"));
     // When type string has unmatched brackets, CreateColumnByType must return nullptr.
@@ -188,3 +604,660 @@ TEST(ColumnsCase, UnmatchedBrackets) {
     ASSERT_EQ(nullptr, CreateColumnByType("Nullable(FixedString(10000"));
     ASSERT_EQ(nullptr, CreateColumnByType("Nullable(FixedString(10000)"));
 }
+
+TEST(ColumnsCase, LowCardinalityLoad) {
+    const uint8_t data[] = {
+        // Serialization version.
+        0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        // Index type UInt8 with additional keys.
+        0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        // Keys.
+        0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x01, 'a', 0x01, 'b',
+        // Rows.
+        0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x01, 0x02, 0x01, 0x00,
+    };
+    ArrayInput buffer(data, sizeof(data));
+    CodedInputStream input(&buffer);
+
+    auto col = CreateColumnByType("LowCardinality(Nullable(String))")->As<ColumnLowCardinality>();
+    ASSERT_NE(nullptr, col);
+    ASSERT_TRUE(col->LoadPrefix(&input, 4));
+    ASSERT_TRUE(col->Load(&input, 4));
+
+    auto dict = col->GetDictionary()->As<ColumnString>();
+    ASSERT_EQ(col->Size(), 4u);
+    ASSERT_EQ(dict->Size(), 3u);
+    ASSERT_EQ(dict->At(col->GetIndex(0)), "a");
+    ASSERT_EQ(dict->At(col->GetIndex(1)), "b");
+    ASSERT_EQ(dict->At(col->GetIndex(2)), "a");
+    ASSERT_FALSE(col->IsNull(2));
+    ASSERT_TRUE(col->IsNull(3));
+}
+
+TEST(ColumnsCase, LowCardinalityRoundtrip) {
+    auto keys = std::make_shared<ColumnUInt32>();
+    for (uint32_t i = 0; i < 300; ++i) {
+        keys->Append(i * 7);
+    }
+
+    // Column built from keys of another column needs two-byte positions.
+    const uint8_t indices[] = {0x00, 0x00, 0x2b, 0x01, 0x05, 0x00};
+    Buffer data;
+    {
+        BufferOutput buffer(&data);
+        CodedOutputStream output(&buffer);
+        const uint64_t header[] = {1, 0x201, 300};
+        const uint64_t rows = 3;
+        output.WriteRaw(header, sizeof(header));
+        keys->Save(&output);
+        output.WriteRaw(&rows, sizeof(rows));
+        output.WriteRaw(indices, sizeof(indices));
+        output.Flush();
+    }
+
+    auto col = std::make_shared<ColumnLowCardinality>(std::make_shared<ColumnUInt32>());
+    {
+        ArrayInput buffer(data.data(), data.size());
+        CodedInputStream input(&buffer);
+        ASSERT_TRUE(col->LoadPrefix(&input, 3));
+        ASSERT_TRUE(col->Load(&input, 3));
+    }
+    ASSERT_EQ(col->GetIndexColumn()->Type()->GetCode(), Type::UInt16);
+    ASSERT_EQ(col->GetIndex(1), 299u);
+
+    Buffer saved;
+    {
+        BufferOutput buffer(&saved);
+        CodedOutputStream output(&buffer);
+        col->SavePrefix(&output);
+        col->Save(&output);
+        output.Flush();
+    }
+    ASSERT_EQ(data, saved);
+
+    // Slices share the dictionary, so only positions are appended.
+    col->Append(col->Slice(1, 2));
+    ASSERT_EQ(col->Size(), 5u);
+    ASSERT_EQ(col->GetDictionary()->Size(), 300u);
+    ASSERT_EQ(col->GetIndex(3), 299u);
+
+    // Column with another dictionary gets the keys and rebased positions.
+    auto other = std::make_shared<ColumnLowCardinality>(std::make_shared<ColumnUInt32>());
+    other->Append(col);
+    ASSERT_EQ(other->Size(), 5u);
+    auto dict = other->GetDictionary()->As<ColumnUInt32>();
+    ASSERT_EQ(dict->At(other->GetIndex(1)), 299u * 7);
+    ASSERT_EQ(dict->At(other->GetIndex(4)), 5u * 7);
+}
+
+TEST(ColumnsCase, LowCardinalityAppendString) {
+    auto col = std::make_shared<ColumnLowCardinality>(
+        std::make_shared<ColumnNullable>(std::make_shared<ColumnString>(), std::make_shared<ColumnUInt8>()));
+
+    col->AppendNull();
+    col->Append("");
+    for (size_t i = 0; i < 1000; ++i) {
+        col->Append(std::to_string(i % 300));
+    }
+    col->Append("");
+
+    auto dict = col->GetDictionary()->As<ColumnString>();
+    ASSERT_EQ(col->Size(), 1003u);
+    // NULL placeholder, empty string and 300 numbers.
+    ASSERT_EQ(dict->Size(), 302u);
+    ASSERT_EQ(col->GetIndexColumn()->Type()->GetCode(), Type::UInt16);
+    ASSERT_TRUE(col->IsNull(0));
+    ASSERT_FALSE(col->IsNull(1));
+    ASSERT_EQ(col->GetIndex(1), col->GetIndex(1002));
+    ASSERT_EQ(col->GetIndex(2), col->GetIndex(302));
+    ASSERT_EQ(dict->At(col->GetIndex(301)), "299");
+
+    ASSERT_THROW(ColumnLowCardinality(std::make_shared<ColumnString>()).AppendNull(), std::runtime_error);
+    ASSERT_THROW(ColumnLowCardinality(std::make_shared<ColumnUInt8>()).Append("a"), std::runtime_error);
+}
+
+TEST(ColumnsCase, LowCardinalityAppendDedup) {
+    auto make = [] {
+        return std::make_shared<ColumnLowCardinality>(
+            std::make_shared<ColumnNullable>(std::make_shared<ColumnString>(), std::make_shared<ColumnUInt8>()));
+    };
+
+    auto col = make();
+    col->Append("a");
+    col->Append("b");
+
+    auto other = make();
+    other->Append("b");
+    other->AppendNull();
+    other->Append("c");
+    other->Append("unused");
+
+    // Keys of the other column are mapped into the dictionary, only the
+    // missing used ones are added.
+    col->Append(other->Slice(0, 3));
+    auto dict = col->GetDictionary()->As<ColumnString>();
+    ASSERT_EQ(col->Size(), 5u);
+    ASSERT_EQ(dict->Size(), 4u);
+    ASSERT_EQ(col->GetIndex(2), col->GetIndex(1));
+    ASSERT_TRUE(col->IsNull(3));
+    ASSERT_EQ(dict->At(col->GetIndex(4)), "c");
+
+    // Clearing keeps memory of the index.
+    const size_t memory = col->GetIndexColumn()->MemoryUsage();
+    col->Clear();
+    ASSERT_EQ(col->Size(), 0u);
+    ASSERT_EQ(col->GetIndexColumn()->MemoryUsage(), memory);
+
+    // The hash table follows the dictionary replaced by Load.
+    const uint8_t data[] = {
+        0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x01, 'x', 0x01, 'y',
+        0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x01, 0x02,
+    };
+    ArrayInput buffer(data, sizeof(data));
+    CodedInputStream input(&buffer);
+    ASSERT_TRUE(col->LoadPrefix(&input, 2));
+    ASSERT_TRUE(col->Load(&input, 2));
+    col->Append("y");
+    ASSERT_EQ(col->GetDictionary()->Size(), 3u);
+    ASSERT_EQ(col->GetIndex(2), col->GetIndex(1));
+}
+
+TEST(ColumnsCase, LowCardinalityAppendNumbers) {
+    // Loads LowCardinality(Nullable(UInt32)) of given keys and positions.
+    auto make = [] (const std::vector<uint32_t>& keys, const std::vector<uint8_t>& indices) {
+        Buffer data;
+        {
+            BufferOutput buffer(&data);
+            CodedOutputStream output(&buffer);
+            const uint64_t header[] = {1, 0x200, keys.size()};
+            const uint64_t rows = indices.size();
+            output.WriteRaw(header, sizeof(header));
+            ColumnUInt32(keys).Save(&output);
+            output.WriteRaw(&rows, sizeof(rows));
+            output.WriteRaw(indices.data(), indices.size());
+            output.Flush();
+        }
+
+        auto col = CreateColumnByType("LowCardinality(Nullable(UInt32))")->As<ColumnLowCardinality>();
+        ArrayInput buffer(data.data(), data.size());
+        CodedInputStream input(&buffer);
+        EXPECT_TRUE(col->LoadPrefix(&input, indices.size()));
+        EXPECT_TRUE(col->Load(&input, indices.size()));
+        return col;
+    };
+
+    // NULL placeholder, 7, 8, unused 9 and repeated 7.
+    auto block = make({0, 7, 8, 9, 7}, {1, 0, 2, 4});
+    auto col = make({0, 8}, {1});
+
+    // Repeated appends don't grow the dictionary.
+    for (int i = 0; i < 10; ++i) {
+        col->Append(block);
+    }
+    auto dict = col->GetDictionary()->As<ColumnUInt32>();
+    ASSERT_EQ(col->Size(), 41u);
+    ASSERT_EQ(dict->Size(), 3u);
+    ASSERT_EQ(dict->At(col->GetIndex(1)), 7u);
+    ASSERT_TRUE(col->IsNull(2));
+    ASSERT_EQ(col->GetIndex(3), col->GetIndex(0));
+    ASSERT_EQ(col->GetIndex(4), col->GetIndex(1));
+    ASSERT_EQ(col->GetIndex(40), col->GetIndex(1));
+
+    // The first appended column takes only the used keys.
+    auto empty = CreateColumnByType("LowCardinality(Nullable(UInt32))")->As<ColumnLowCardinality>();
+    empty->Append(block);
+    empty->Append(block);
+    ASSERT_EQ(empty->GetDictionary()->Size(), 3u);
+    ASSERT_EQ(empty->Size(), 8u);
+    ASSERT_TRUE(empty->IsNull(5));
+}
+
+TEST(ColumnsCase, ToLowCardinality) {
+    ColumnString strings;
+    for (size_t i = 0; i < 100; ++i) {
+        strings.Append(i % 2 ? "some long string value" : "other long string value");
+    }
+
+    double ratio = 0;
+    auto col = ToLowCardinality(strings, &ratio);
+    auto dict = col->GetDictionary()->As<ColumnString>();
+
+    ASSERT_EQ(col->Size(), 100u);
+    ASSERT_EQ(dict->Size(), 2u);
+    for (size_t i = 0; i < strings.Size(); ++i) {
+        ASSERT_EQ(dict->At(col->GetIndex(i)), strings[i]);
+    }
+    ASSERT_GT(ratio, 10.0);
+
+    // Dictionary loaded from elsewhere is used for deduplication too.
+    auto other = std::make_shared<ColumnLowCardinality>(std::make_shared<ColumnString>());
+    other->Append(col->Slice(0, 1));
+    other->Append("some long string value");
+    other->Append("other long string value");
+    ASSERT_EQ(other->GetDictionary()->Size(), 2u);
+    ASSERT_EQ(other->GetIndex(0), other->GetIndex(2));
+}
+
+TEST(ColumnsCase, MapLoad) {
+    const uint8_t data[] = {
+        // Offsets.
+        0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        // Keys.
+        0x01, 'a', 0x01, 'b', 0x01, 'b',
+        // Values.
+        0x01, 0x02, 0x03,
+    };
+    ArrayInput buffer(data, sizeof(data));
+    CodedInputStream input(&buffer);
+
+    auto col = CreateColumnByType("Map(String, UInt8)");
+    ASSERT_NE(nullptr, col);
+    ASSERT_EQ(col->Type()->GetName(), "Map(String, UInt8)");
+    ASSERT_TRUE(col->LoadPrefix(&input, 3));
+    ASSERT_TRUE(col->Load(&input, 3));
+
+    auto map = ColumnMapT<ColumnString, ColumnUInt8>::Wrap(col);
+    ASSERT_EQ(map->Size(), 3u);
+    ASSERT_EQ(map->At(0).Size(), 2u);
+    ASSERT_TRUE(map->At(1).Empty());
+    ASSERT_EQ(map->At(0).At("b"), 2u);
+    ASSERT_EQ(map->At(2).At(std::string("b")), 3u);
+    ASSERT_FALSE(map->At(2).Has("a"));
+    ASSERT_THROW(map->At(1).At("a"), std::out_of_range);
+    ASSERT_THROW((ColumnMapT<ColumnUInt8, ColumnUInt8>::Wrap(col)), std::runtime_error);
+
+    std::string keys;
+    for (const auto& [key, value] : (*map)[0]) {
+        keys += key + std::to_string(value);
+    }
+    ASSERT_EQ(keys, "a1b2");
+}
+
+TEST(ColumnsCase, MapAppendAsColumn) {
+    auto map = std::make_shared<ColumnMapT<ColumnUInt64, ColumnString>>(
+        std::make_shared<ColumnUInt64>(), std::make_shared<ColumnString>());
+
+    map->AppendAsColumn(
+        std::make_shared<ColumnUInt64>(std::vector<uint64_t>{1, 2}),
+        std::make_shared<ColumnString>(std::vector<std::string>{"one", "two"}));
+    map->AppendAsColumn(
+        std::make_shared<ColumnUInt64>(std::vector<uint64_t>{3}),
+        std::make_shared<ColumnString>(std::vector<std::string>{"three"}));
+
+    ASSERT_EQ(map->Size(), 2u);
+    ASSERT_EQ(map->At(0).At(2u), "two");
+    ASSERT_EQ(map->At(1).Find(3u).Value(), "three");
+    ASSERT_EQ(map->GetKeys()->Size(), 3u);
+
+    ASSERT_THROW(map->AppendAsColumn(
+        std::make_shared<ColumnUInt64>(std::vector<uint64_t>{1}),
+        std::make_shared<ColumnString>()), std::runtime_error);
+    ASSERT_THROW(map->AppendAsColumn(
+        std::make_shared<ColumnUInt32>(std::vector<uint32_t>{1}),
+        std::make_shared<ColumnString>(std::vector<std::string>{"one"})), std::runtime_error);
+}
+
+TEST(ColumnsCase, TupleAppendSlice) {
+    auto tuple = std::make_shared<ColumnTuple>(std::vector<ColumnRef>{
+        std::make_shared<ColumnUInt32>(MakeNumbers()),
+        std::make_shared<ColumnString>(std::vector<std::string>(MakeNumbers().size(), "x"))});
+
+    auto sub = tuple->Slice(2, 3)->As<ColumnTuple>();
+    ASSERT_EQ(sub->Size(), 3u);
+    ASSERT_EQ(sub->Type()->GetName(), "Tuple(UInt32, String)");
+    ASSERT_EQ((*sub)[0]->As<ColumnUInt32>()->At(0), MakeNumbers()[2]);
+
+    sub->Append(tuple->Slice(0, 1));
+    sub->Append(sub);
+    ASSERT_EQ(sub->Size(), 8u);
+    ASSERT_EQ((*sub)[1]->Size(), 8u);
+    ASSERT_EQ((*sub)[0]->As<ColumnUInt32>()->At(3), MakeNumbers()[0]);
+    ASSERT_EQ((*sub)[0]->As<ColumnUInt32>()->At(4), MakeNumbers()[2]);
+
+    // Columns of other types are ignored.
+    sub->Append(std::make_shared<ColumnTuple>(std::vector<ColumnRef>{
+        std::make_shared<ColumnUInt32>(MakeNumbers())}));
+    ASSERT_EQ(sub->Size(), 8u);
+}
+
+TEST(ColumnsCase, MapAppendSlice) {
+    auto map = std::make_shared<ColumnMapT<ColumnUInt64, ColumnString>>(
+        std::make_shared<ColumnUInt64>(), std::make_shared<ColumnString>());
+
+    for (uint64_t i = 0; i < 4; ++i) {
+        map->AppendAsColumn(
+            std::make_shared<ColumnUInt64>(std::vector<uint64_t>(i, i)),
+            std::make_shared<ColumnString>(std::vector<std::string>(i, std::to_string(i))));
+    }
+
+    auto sub = ColumnMapT<ColumnUInt64, ColumnString>::Wrap(map->Slice(2, 2));
+    ASSERT_EQ(sub->Size(), 2u);
+    ASSERT_EQ(sub->At(1).Size(), 3u);
+    ASSERT_EQ(sub->At(1).At(3u), "3");
+
+    sub->Append(map->Slice(1, 1));
+    ASSERT_EQ(sub->Size(), 3u);
+    ASSERT_EQ(sub->At(2).At(1u), "1");
+    ASSERT_EQ(sub->GetValues()->Size(), 6u);
+}
+
+TEST(ColumnsCase, WideIntegers) {
+    const Int256 a(int64_t(-5));
+    const Int256 b = Int256(absl::MakeUint128(1, 0)) * Int256(absl::MakeUint128(1, 0));
+
+    ASSERT_TRUE(a.IsNegative());
+    ASSERT_EQ(a.ToString(), "-5");
+    ASSERT_EQ(b.Limb(2), 1u);
+    ASSERT_EQ(b.ToString(), "340282366920938463463374607431768211456");
+    ASSERT_EQ((b - Int256(1)).ToString(), "340282366920938463463374607431768211455");
+    ASSERT_EQ((-b + b), Int256());
+    ASSERT_TRUE(a < Int256(0));
+    ASSERT_TRUE(-b < a);
+    ASSERT_EQ(UInt256(~UInt256()).ToString(),
+        "115792089237316195423570985008687907853269984665640564039457584007913129639935");
+
+    auto col = CreateColumnByType("Int256")->As<ColumnInt256>();
+    ASSERT_NE(nullptr, col);
+    col->Append(b);
+    ASSERT_EQ(col->At(0), b);
+    ASSERT_NE(nullptr, CreateColumnByType("UInt128")->As<ColumnUInt128>());
+    ASSERT_NE(nullptr, CreateColumnByType("UInt256")->As<ColumnUInt256>());
+    ASSERT_NE(nullptr, CreateColumnByType("Int128")->As<ColumnInt128>());
+}
+
+TEST(ColumnsCase, DecimalString) {
+    auto d32 = std::make_shared<ColumnDecimal>(9, 3);
+    d32->Append("1.5");
+    d32->Append("-123456.789123");
+    d32->Append(".25");
+    d32->Append("0");
+    ASSERT_EQ(d32->At(0), 1500);
+    ASSERT_EQ(d32->At(1), -123456789);
+    ASSERT_EQ(d32->AsString(0), "1.500");
+    ASSERT_EQ(d32->AsString(1), "-123456.789");
+    ASSERT_EQ(d32->AsString(2), "0.250");
+    ASSERT_EQ(d32->AsString(3), "0.000");
+    ASSERT_THROW(d32->Append("1234567.0"), std::runtime_error);
+    ASSERT_THROW(d32->Append("1.2.3"), std::runtime_error);
+    ASSERT_THROW(d32->Append("-"), std::runtime_error);
+    ASSERT_THROW(d32->Append("1e5"), std::runtime_error);
+
+    auto d128 = CreateColumnByType("Decimal(38, 18)")->As<ColumnDecimal>();
+    d128->Append("-12345678901234567890.123456789012345678");
+    d128->Append("00000000000000000000000000099999999999999999999.9999999999999999999");
+    ASSERT_EQ(d128->AsString(0), "-12345678901234567890.123456789012345678");
+    ASSERT_EQ(d128->AsString(1), "99999999999999999999.999999999999999999");
+    ASSERT_EQ(d128->At(0), -(Int128(1234567890123456789) * Int128(10000000000000000000ull) + 123456789012345678));
+
+    auto d256 = CreateColumnByType("Decimal256(20)")->As<ColumnDecimal>();
+    const std::string big = "-12345678901234567890123456789012345678901234567890123456.12345678901234567890";
+    d256->Append(big);
+    d256->Append(Int128(7));
+    ASSERT_EQ(d256->AsString(0), big);
+    ASSERT_EQ(d256->AsString(1), "0.00000000000000000007");
+    ASSERT_THROW(d256->At(0), std::overflow_error);
+    ASSERT_EQ(d256->At(1), 7);
+    ASSERT_EQ(d256->Slice(0, 1)->As<ColumnDecimal>()->AsString(0), big);
+}
+
+TEST(ColumnsCase, DecimalBulk) {
+    const std::vector<int64_t> values = {1, -2, 300000000, -400000000};
+
+    auto d32 = std::make_shared<ColumnDecimal>(9, 2);
+    d32->AppendMany(values.data(), values.size());
+    ASSERT_EQ(d32->Size(), 4u);
+    ASSERT_EQ(d32->AsString(3), "-4000000.00");
+
+    std::vector<Int128> wide(3);
+    d32->GetMany(1, 3, wide.data());
+    ASSERT_EQ(wide[0], -2);
+    ASSERT_EQ(wide[2], -400000000);
+    ASSERT_THROW(d32->GetMany(2, 3, wide.data()), std::out_of_range);
+
+    auto d256 = std::make_shared<ColumnDecimal>(76, 0);
+    d256->AppendMany(wide.data(), wide.size());
+    d256->Append(d256->Slice(0, 1));
+    std::vector<Int256> result(4);
+    d256->GetMany(0, 4, result.data());
+    ASSERT_EQ(result[0], Int256(-2));
+    ASSERT_EQ(result[3], Int256(-2));
+
+    std::vector<int32_t> narrow(2);
+    d32->Slice(2, 2)->As<ColumnDecimal>()->GetMany(0, 2, narrow.data());
+    ASSERT_EQ(narrow[0], 300000000);
+    ASSERT_EQ(narrow[1], -400000000);
+}
+
+TEST(ColumnsCase, FilterTake) {
+    // Covers runs of 16 kept, 16 mixed and a tail of rows.
+    std::vector<uint32_t> values(40);
+    std::vector<uint8_t> mask(values.size());
+    std::vector<uint32_t> expected;
+    for (size_t i = 0; i < values.size(); ++i) {
+        values[i] = static_cast<uint32_t>(i * 3);
+        mask[i] = (i < 16 || i % 3 == 0) ? 1 : 0;
+        if (mask[i]) {
+            expected.push_back(values[i]);
+        }
+    }
+
+    auto numbers = std::make_shared<ColumnUInt32>(values);
+    auto filtered = numbers->Filter(mask.data())->As<ColumnUInt32>();
+    ASSERT_EQ(filtered->Size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        ASSERT_EQ(filtered->At(i), expected[i]);
+    }
+
+    const std::vector<uint32_t> indices = {5, 0, 5, 39};
+    auto taken = numbers->Take(indices.data(), indices.size())->As<ColumnUInt32>();
+    ASSERT_EQ(taken->Size(), 4u);
+    ASSERT_EQ(taken->At(0), 15u);
+    ASSERT_EQ(taken->At(2), 15u);
+    ASSERT_EQ(taken->At(3), 117u);
+
+    const std::vector<uint32_t> bad = {40};
+    ASSERT_THROW(numbers->Take(bad.data(), bad.size()), std::out_of_range);
+
+    // Rows of columns of every kind keep their values together.
+    auto names = std::make_shared<ColumnNullable>(
+        std::make_shared<ColumnString>(std::vector<std::string>{"a", "", "c", "d"}),
+        std::make_shared<ColumnUInt8>(std::vector<uint8_t>{0, 1, 0, 0}));
+    auto arrays = std::make_shared<ColumnArray>(std::make_shared<ColumnUInt64>());
+    for (uint64_t i = 0; i < 4; ++i) {
+        arrays->AppendAsColumn(std::make_shared<ColumnUInt64>(std::vector<uint64_t>(i, i)));
+    }
+    auto kinds = std::make_shared<ColumnLowCardinality>(std::make_shared<ColumnString>());
+    for (const char* kind : {"x", "y", "x", "z"}) {
+        kinds->Append(kind);
+    }
+    auto ids = std::make_shared<ColumnUUID>();
+    for (uint64_t i = 0; i < 4; ++i) {
+        ids->Append(UInt128(i, i + 10));
+    }
+    auto times = std::make_shared<ColumnDateTime>("UTC");
+    auto prices = std::make_shared<ColumnDecimal>(18, 2);
+    auto codes = std::make_shared<ColumnFixedString>(2);
+    for (int i = 0; i < 4; ++i) {
+        times->Append(1000 * i);
+        prices->Append(std::to_string(i) + ".25");
+        codes->Append(std::string(2, static_cast<char>('a' + i)));
+    }
+    auto tuple = std::make_shared<ColumnTuple>(std::vector<ColumnRef>{prices, codes});
+
+    const std::vector<uint8_t> rows_mask = {0, 1, 0, 1};
+    const std::vector<uint32_t> permutation = {3, 2, 1, 0};
+    for (ColumnRef column : std::vector<ColumnRef>{names, arrays, kinds, ids, times, tuple}) {
+        SCOPED_TRACE(column->Type()->GetName());
+        auto odd = column->Filter(rows_mask.data());
+        auto reversed = column->Permute(permutation.data());
+        ASSERT_EQ(odd->Size(), 2u);
+        ASSERT_EQ(reversed->Size(), 4u);
+        ASSERT_EQ(odd->Type()->GetName(), column->Type()->GetName());
+        ASSERT_EQ(reversed->Type()->GetName(), column->Type()->GetName());
+    }
+
+    auto odd_names = names->Filter(rows_mask.data())->As<ColumnNullable>();
+    ASSERT_TRUE(odd_names->IsNull(0));
+    ASSERT_EQ(odd_names->NullCount(), 1u);
+    ASSERT_EQ(odd_names->Nested()->As<ColumnString>()->At(1), "d");
+
+    auto odd_arrays = ColumnArrayT<ColumnUInt64>::Wrap(arrays->Filter(rows_mask.data()));
+    ASSERT_EQ(odd_arrays->At(0).Size(), 1u);
+    ASSERT_EQ(odd_arrays->At(1).Size(), 3u);
+    ASSERT_EQ(odd_arrays->At(1).At(2), 3u);
+    ASSERT_EQ(odd_arrays->GetData()->Size(), 4u);
+
+    auto reversed_arrays = ColumnArrayT<ColumnUInt64>::Wrap(arrays->Permute(permutation.data()));
+    ASSERT_EQ(reversed_arrays->At(0).Size(), 3u);
+    ASSERT_EQ(reversed_arrays->At(1).At(1), 2u);
+    ASSERT_EQ(reversed_arrays->At(3).Size(), 0u);
+
+    auto reversed_kinds = kinds->Permute(permutation.data())->As<ColumnLowCardinality>();
+    ASSERT_EQ(reversed_kinds->GetDictionary(), kinds->GetDictionary());
+    ASSERT_EQ(reversed_kinds->GetIndex(0), kinds->GetIndex(3));
+
+    ASSERT_EQ(ids->Filter(rows_mask.data())->As<ColumnUUID>()->At(1), UInt128(3, 13));
+    ASSERT_EQ(ids->Permute(permutation.data())->As<ColumnUUID>()->At(1), UInt128(2, 12));
+    ASSERT_EQ(times->Permute(permutation.data())->As<ColumnDateTime>()->At(0), 3000);
+
+    auto reversed_tuple = tuple->Permute(permutation.data())->As<ColumnTuple>();
+    ASSERT_EQ((*reversed_tuple)[0]->As<ColumnDecimal>()->AsString(0), "3.25");
+    ASSERT_EQ((*reversed_tuple)[1]->As<ColumnFixedString>()->At(3), "aa");
+}
+
+TEST(ColumnsCase, Stats) {
+    std::vector<int32_t> values(5000);
+    std::vector<uint8_t> nulls(values.size());
+    for (size_t i = 0; i < values.size(); ++i) {
+        values[i] = static_cast<int32_t>(i % 1000) - 500;
+        nulls[i] = i == 10;
+    }
+    // The only row with -1000 is NULL.
+    values[10] = -1000;
+
+    auto numbers = std::make_shared<ColumnNullable>(
+        std::make_shared<ColumnInt32>(values), std::make_shared<ColumnUInt8>(nulls));
+    auto stats = ComputeStats(numbers);
+    ASSERT_EQ(stats.rows, 5000u);
+    ASSERT_EQ(stats.null_count, 1u);
+    ASSERT_EQ(std::get<int64_t>(stats.min), -500);
+    ASSERT_EQ(std::get<int64_t>(stats.max), 499);
+    ASSERT_EQ(std::get<Int128>(stats.sum), Int128(-2500 + 490));
+    ASSERT_NEAR(static_cast<double>(stats.distinct), 1000, 50);
+
+    auto floats = std::make_shared<ColumnFloat64>(std::vector<double>{1.5, std::nan(""), -2});
+    stats = ComputeStats(floats);
+    ASSERT_EQ(std::get<double>(stats.min), -2);
+    ASSERT_EQ(std::get<double>(stats.max), 1.5);
+
+    auto names = std::make_shared<ColumnString>(std::vector<std::string>{"pear", "apple", "fig", "apple"});
+    stats = ComputeStats(names);
+    ASSERT_EQ(std::get<std::string>(stats.min), "apple");
+    ASSERT_EQ(std::get<std::string>(stats.max), "pear");
+    ASSERT_EQ(stats.min_length, 3u);
+    ASSERT_EQ(stats.max_length, 5u);
+    ASSERT_EQ(stats.total_length, 17u);
+    ASSERT_EQ(stats.distinct, 3u);
+
+    // Range of LowCardinality covers only values of its rows.
+    auto kinds = std::make_shared<ColumnLowCardinality>(std::make_shared<ColumnString>());
+    for (const char* kind : {"b", "a", "c", "c"}) {
+        kinds->Append(kind);
+    }
+    stats = ComputeStats(kinds->Slice(2, 2));
+    ASSERT_EQ(std::get<std::string>(stats.min), "c");
+    ASSERT_EQ(stats.total_length, 2u);
+    ASSERT_EQ(stats.distinct, 1u);
+
+    auto dates = std::make_shared<ColumnDate>();
+    dates->Append(86400 * 2);
+    dates->Append(86400);
+    stats = ComputeStats(dates);
+    ASSERT_EQ(std::get<int64_t>(stats.min), 86400);
+    ASSERT_TRUE(std::holds_alternative<std::monostate>(stats.sum));
+
+    // Dates beyond the range of nanoseconds keep their order.
+    auto far_dates = std::make_shared<ColumnDate32>();
+    far_dates->Append(std::time_t(120529) * 86400);
+    far_dates->Append(std::time_t(120000) * 86400);
+    far_dates->Append(std::time_t(-120000) * 86400);
+    stats = ComputeStats(far_dates);
+    ASSERT_EQ(std::get<int64_t>(stats.min), -120000ll * 86400);
+    ASSERT_EQ(std::get<int64_t>(stats.max), 120529ll * 86400);
+    ASSERT_EQ(stats.distinct, 3u);
+
+    auto ticks = std::make_shared<ColumnDateTime64>(3);
+    ticks->Append(static_cast<uint64_t>(-10000000000001ll));
+    ticks->Append(uint64_t(10000000000000ll));
+    stats = ComputeStats(ticks);
+    ASSERT_EQ(std::get<int64_t>(stats.min), -10000000000001ll);
+    ASSERT_EQ(std::get<int64_t>(stats.max), 10000000000000ll);
+
+    auto prices = std::make_shared<ColumnDecimal>(12, 2);
+    prices->Append("1.25");
+    prices->Append("-3.50");
+    stats = ComputeStats(prices);
+    ASSERT_EQ(std::get<Int128>(stats.min), -350);
+    ASSERT_EQ(std::get<Int128>(stats.sum), -225);
+
+    // Other columns only have counts of rows.
+    stats = ComputeStats(std::make_shared<ColumnUUID>());
+    ASSERT_EQ(stats.rows, 0u);
+    ASSERT_TRUE(std::holds_alternative<std::monostate>(stats.min));
+}
+
+TEST(ColumnsCase, ExclusivelyOwned) {
+    auto nullable = std::make_shared<ColumnNullable>(
+        std::make_shared<ColumnUInt32>(MakeNumbers()),
+        std::make_shared<ColumnUInt8>(std::vector<uint8_t>(MakeNumbers().size(), 0)));
+    ASSERT_TRUE(nullable->IsExclusivelyOwned());
+    {
+        auto nested = nullable->Nested();
+        ASSERT_FALSE(nullable->IsExclusivelyOwned());
+    }
+    ASSERT_TRUE(nullable->IsExclusivelyOwned());
+
+    // Ownership is checked through all levels of nesting.
+    auto tuple = std::make_shared<ColumnTuple>(std::vector<ColumnRef>{nullable});
+    nullable.reset();
+    ASSERT_TRUE(tuple->IsExclusivelyOwned());
+    {
+        auto nulls = (*tuple)[0]->As<ColumnNullable>()->Nulls();
+        ASSERT_FALSE(tuple->IsExclusivelyOwned());
+    }
+    ASSERT_TRUE(tuple->IsExclusivelyOwned());
+
+    auto array = std::make_shared<ColumnArray>(std::make_shared<ColumnUInt64>());
+    array->AppendAsColumn(std::make_shared<ColumnUInt64>(std::vector<uint64_t>{1, 2}));
+    ASSERT_TRUE(array->IsExclusivelyOwned());
+    {
+        auto typed = ColumnArrayT<ColumnUInt64>::Wrap(array);
+        ASSERT_FALSE(array->IsExclusivelyOwned());
+        ASSERT_FALSE(typed->IsExclusivelyOwned());
+    }
+    ASSERT_TRUE(array->IsExclusivelyOwned());
+    ASSERT_TRUE(std::make_shared<ColumnArrayT<ColumnUInt64>>(std::make_shared<ColumnUInt64>())->IsExclusivelyOwned());
+
+    auto map = std::make_shared<ColumnMapT<ColumnUInt64, ColumnString>>(
+        std::make_shared<ColumnUInt64>(), std::make_shared<ColumnString>());
+    ASSERT_TRUE(map->IsExclusivelyOwned());
+    {
+        auto keys = map->GetKeys();
+        ASSERT_FALSE(map->IsExclusivelyOwned());
+    }
+    {
+        auto untyped = std::make_shared<ColumnMap>(std::make_shared<ColumnUInt64>(), std::make_shared<ColumnString>());
+        ASSERT_TRUE(untyped->IsExclusivelyOwned());
+        auto typed = ColumnMapT<ColumnUInt64, ColumnString>::Wrap(untyped);
+        ASSERT_FALSE(untyped->IsExclusivelyOwned());
+    }
+    ASSERT_TRUE(map->IsExclusivelyOwned());
+}
@@ -4,6 +4,8 @@
 #include <contrib/gtest/gtest.h>
 
 #include <iostream>
+#include <netdb.h>
+#include <netinet/tcp.h>
 #include <stdio.h>
 #include <string.h>
 #include <thread>
@@ -30,3 +32,66 @@ TEST(Socketcase, connecterror) {
       ASSERT_NE(EINPROGRESS,e.code().value());
    }
 }
+
+TEST(Socketcase, addresscache) {
+   NetworkAddress first("localhost", "9979", std::chrono::seconds(60));
+   NetworkAddress second("localhost", "9979", std::chrono::seconds(60));
+   NetworkAddress uncached("localhost", "9979");
+
+   ASSERT_NE(nullptr, first.Info());
+   ASSERT_EQ(first.Info(), second.Info());
+   ASSERT_NE(first.Info(), uncached.Info());
+}
+
+TEST(Socketcase, connecttimeout) {
+   // Non-routable address, so the connection attempt hangs until timeout.
+   NetworkAddress addr("10.255.255.1", "9000");
+   const auto start = std::chrono::steady_clock::now();
+   try {
+      SocketConnect(addr, std::nullopt, std::chrono::milliseconds(300));
+      FAIL();
+   } catch (const std::system_error& e) {
+      ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(3));
+   }
+}
+
+TEST(Socketcase, resolvefamilies) {
+   // Families are resolved separately, the address of the other family
+   // must not make it into the list.
+   NetworkAddress addr("127.0.0.2", "9000");
+
+   size_t count = 0;
+   for (auto info = addr.Info(); info != nullptr; info = info->ai_next) {
+      ASSERT_EQ(AF_INET, info->ai_family);
+      ++count;
+   }
+   ASSERT_NE(0u, count);
+}
+
+TEST(Socketcase, connectoptions) {
+   int port = 9977;
+   NetworkAddress addr("localhost", std::to_string(port));
+   LocalTcpServer server(port);
+   server.start();
+   std::this_thread::sleep_for(std::chrono::seconds(1));
+
+   SocketOptions options;
+   options.tcp_nodelay = true;
+   // Below the system default, so the option is seen to take effect.
+   options.recv_buffer_size = 8192;
+
+   SocketHolder s(SocketConnect(addr, std::nullopt, std::chrono::milliseconds(5000), options));
+
+   int nodelay = 0;
+   int recv_size = 0;
+   socklen_t len = sizeof(nodelay);
+   ASSERT_EQ(0, getsockopt(s, IPPROTO_TCP, TCP_NODELAY, &nodelay, &len));
+   len = sizeof(recv_size);
+   ASSERT_EQ(0, getsockopt(s, SOL_SOCKET, SO_RCVBUF, &recv_size, &len));
+   ASSERT_NE(0, nodelay);
+   // Linux doubles the requested size for bookkeeping.
+   ASSERT_LE(recv_size, 2 * 8192);
+
+   s.Close();
+   server.stop();
+}
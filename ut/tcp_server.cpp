@@ -53,4 +53,127 @@ void LocalTcpServer::stop() {
     }
 }
 
+LocalHandshakeServer::LocalHandshakeServer(int port, size_t answered)
+    : port_(port)
+    , answered_(answered)
+    , serverSd_(-1)
+{}
+
+LocalHandshakeServer::~LocalHandshakeServer() {
+    stop();
+}
+
+void LocalHandshakeServer::start() {
+    sockaddr_in servAddr;
+    bzero((char*)&servAddr, sizeof(servAddr));
+    servAddr.sin_family = AF_INET;
+    servAddr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    servAddr.sin_port = htons(port_);
+    serverSd_ = socket(AF_INET, SOCK_STREAM, 0);
+    if (serverSd_ < 0) {
+        throw std::runtime_error("Error establishing server socket");
+    }
+    int enable = 1;
+    setsockopt(serverSd_, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(int));
+    if (bind(serverSd_, (struct sockaddr*) &servAddr, sizeof(servAddr)) < 0) {
+        throw std::runtime_error("Error binding socket to local address");
+    }
+    listen(serverSd_, 8);
+    acceptThread_ = std::thread([this] { acceptLoop(); });
+}
+
+void LocalHandshakeServer::stop() {
+    if (serverSd_ < 0) {
+        return;
+    }
+    shutdown(serverSd_, SHUT_RDWR);
+    acceptThread_.join();
+    close(serverSd_);
+    serverSd_ = -1;
+
+    std::vector<std::thread> threads;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (int sd : clients_) {
+            if (sd >= 0) {
+                shutdown(sd, SHUT_RDWR);
+            }
+        }
+        threads.swap(threads_);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+void LocalHandshakeServer::setQueryReply(std::string packets) {
+    queryReply_ = std::move(packets);
+}
+
+size_t LocalHandshakeServer::connections() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return clients_.size();
+}
+
+void LocalHandshakeServer::drop(size_t n, bool reset) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (clients_.at(n) >= 0) {
+        if (reset) {
+            // Closing the descriptor then sends RST.
+            linger value = {1, 0};
+            setsockopt(clients_[n], SOL_SOCKET, SO_LINGER, &value, sizeof(value));
+        }
+        shutdown(clients_[n], SHUT_RDWR);
+    }
+}
+
+void LocalHandshakeServer::acceptLoop() {
+    while (true) {
+        const int sd = accept(serverSd_, nullptr, nullptr);
+        if (sd < 0) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        const bool answer = clients_.size() < answered_;
+        const size_t n = clients_.size();
+        clients_.push_back(sd);
+        threads_.emplace_back([this, sd, n, answer] { serve(sd, n, answer); });
+    }
+}
+
+void LocalHandshakeServer::serve(int sd, size_t n, bool answer) {
+    // Server Hello: name, version 21.8, revision 54401, timezone,
+    // display name and version patch.
+    static const char hello[] = "\x00\x0a" "ClickHouse" "\x15\x08\x81\xa9\x03" "\x03" "UTC" "\x04" "mock" "\x01";
+    char buf[65536];
+    bool handshaked = false;
+
+    // Packets are small, so each one is assumed to come in a single read.
+    while (true) {
+        const ssize_t ret = recv(sd, buf, sizeof(buf), 0);
+        if (ret <= 0) {
+            break;
+        }
+        if (!answer) {
+            continue;
+        }
+        if (!handshaked) {
+            send(sd, hello, sizeof(hello) - 1, MSG_NOSIGNAL);
+            handshaked = true;
+        } else if (buf[0] == 4) {
+            // Ping is answered with Pong.
+            send(sd, "\x04", 1, MSG_NOSIGNAL);
+        } else if (buf[0] == 1) {
+            // Query is answered with the canned packets and EndOfStream.
+            const std::string reply = queryReply_ + '\x05';
+            send(sd, reply.data(), reply.size(), MSG_NOSIGNAL);
+        }
+    }
+    // The descriptor is closed by the thread which owns it, others only
+    // shut it down while it is listed.
+    std::lock_guard<std::mutex> lock(mutex_);
+    clients_[n] = -1;
+    close(sd);
+}
+
 }
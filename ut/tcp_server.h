@@ -1,5 +1,12 @@
 #pragma once
 
+#include <cstddef>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
 namespace clickhouse {
 
 class LocalTcpServer {
@@ -18,4 +25,43 @@ private:
     int serverSd_;
 };
 
+/// Accepts connections and answers Hello, Ping and Query packets of
+/// the native protocol, enough for a client to connect and run queries
+/// with canned results.
+class LocalHandshakeServer {
+public:
+    /// Only the first answered connections get replies, the later ones
+    /// are accepted and left waiting.
+    LocalHandshakeServer(int port, size_t answered = std::numeric_limits<size_t>::max());
+    ~LocalHandshakeServer();
+
+    void start();
+    void stop();
+
+    /// Sets raw packets sent in reply to every query before EndOfStream.
+    /// Must be called before start().
+    void setQueryReply(std::string packets);
+
+    /// Count of connections accepted so far.
+    size_t connections();
+
+    /// Closes the connection accepted n-th, counting from zero.  With
+    /// reset the connection is aborted, so the client's writes fail.
+    void drop(size_t n, bool reset = false);
+
+private:
+    void acceptLoop();
+    void serve(int sd, size_t n, bool answer);
+
+private:
+    int port_;
+    size_t answered_;
+    std::string queryReply_;
+    int serverSd_;
+    std::thread acceptThread_;
+    std::mutex mutex_;
+    std::vector<int> clients_;
+    std::vector<std::thread> threads_;
+};
+
 }
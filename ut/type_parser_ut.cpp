@@ -1,6 +1,8 @@
 #include <clickhouse/types/type_parser.h>
 #include <contrib/gtest/gtest.h>
 
+#include <thread>
+
 using namespace clickhouse;
 
 TEST(TypeParserCase, ParseTerminals) {
@@ -44,6 +46,29 @@ TEST(TypeParserCase, ParseNullable) {
     ASSERT_EQ(ast.elements.front().name, "Date");
 }
 
+TEST(TypeParserCase, ParseLowCardinality) {
+    TypeAst ast;
+    TypeParser("LowCardinality(Nullable(String))").Parse(&ast);
+
+    ASSERT_EQ(ast.meta, TypeAst::LowCardinality);
+    ASSERT_EQ(ast.name, "LowCardinality");
+    ASSERT_EQ(ast.code, Type::LowCardinality);
+    ASSERT_EQ(ast.elements.front().meta, TypeAst::Nullable);
+    ASSERT_EQ(ast.elements.front().elements.front().name, "String");
+}
+
+TEST(TypeParserCase, ParseMap) {
+    TypeAst ast;
+    TypeParser("Map(String, Array(UInt64))").Parse(&ast);
+
+    ASSERT_EQ(ast.meta, TypeAst::Map);
+    ASSERT_EQ(ast.name, "Map");
+    ASSERT_EQ(ast.code, Type::Map);
+    ASSERT_EQ(ast.elements.size(), 2u);
+    ASSERT_EQ(ast.elements[0].name, "String");
+    ASSERT_EQ(ast.elements[1].meta, TypeAst::Array);
+}
+
 TEST(TypeParserCase, ParseEnum) {
     TypeAst ast;
     TypeParser(
@@ -130,6 +155,27 @@ TEST(TypeParserCase, ParseDecimal128) {
     ASSERT_EQ(ast.elements[0].value, 3);
 }
 
+TEST(TypeParserCase, ParseDecimal256) {
+    TypeAst ast;
+    TypeParser("Decimal256(20)").Parse(&ast);
+    ASSERT_EQ(ast.meta, TypeAst::Terminal);
+    ASSERT_EQ(ast.name, "Decimal256");
+    ASSERT_EQ(ast.code, Type::Decimal256);
+    ASSERT_EQ(ast.elements.size(), 1u);
+    ASSERT_EQ(ast.elements[0].value, 20);
+}
+
+TEST(TypeParserCase, ParseWideIntegers) {
+    for (const auto& [name, code] : std::vector<std::pair<std::string, Type::Code>>{
+            {"Int128", Type::Int128}, {"UInt128", Type::UInt128},
+            {"Int256", Type::Int256}, {"UInt256", Type::UInt256}}) {
+        TypeAst ast;
+        TypeParser(name).Parse(&ast);
+        ASSERT_EQ(ast.code, code);
+        ASSERT_EQ(ast.name, name);
+    }
+}
+
 TEST(TypeParserCase, ParseDateTime) {
     TypeAst ast;
     TypeParser("DateTime('UTC')").Parse(&ast);
@@ -152,3 +198,27 @@ TEST(TypeParserCase, ParseDateTime64) {
     ASSERT_EQ(ast.elements[1].value_string, "UTC");
     ASSERT_EQ(ast.elements[1].value, 0);
 }
+
+TEST(TypeParserCase, ParseTypeNameCache) {
+    const std::string name = "Array(Nullable(UInt64))";
+    const TypeAst* ast = ParseTypeName(name);
+
+    ASSERT_NE(ast, nullptr);
+    ASSERT_EQ(ast->meta, TypeAst::Array);
+    ASSERT_EQ(ast, ParseTypeName(std::string_view(name)));
+    ASSERT_EQ(nullptr, ParseTypeName("Array(UInt64"));
+
+    std::vector<const TypeAst*> results(4);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < results.size(); ++i) {
+        threads.emplace_back([&results, &name, i] {
+            results[i] = ParseTypeName(name);
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    for (const auto* r : results) {
+        ASSERT_EQ(ast, r);
+    }
+}
@@ -19,6 +19,16 @@ TEST(TypesCase, TypeName) {
         "Nullable(Int32)"
     );
 
+    ASSERT_EQ(
+        Type::CreateLowCardinality(Type::CreateNullable(Type::CreateString()))->GetName(),
+        "LowCardinality(Nullable(String))"
+    );
+
+    ASSERT_EQ(
+        Type::CreateMap(Type::CreateString(), Type::CreateSimple<uint64_t>())->GetName(),
+        "Map(String, UInt64)"
+    );
+
     ASSERT_EQ(
         Type::CreateArray(Type::CreateSimple<int32_t>())->GetItemType()->GetCode(),
         Type::Int32